@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QObject>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+
+// Decodes preview background PNGs off the GUI thread. Images are converted
+// to ARGB32_Premultiplied (what the raster paint engine draws fastest) and
+// kept in a process-wide LRU of CacheSize entries keyed by path and file
+// modification time, so toggling between the DEFAULT and KEYTAG backgrounds
+// needs no file access at all.
+//
+// cached() answers from memory only. request() resolves the path on the
+// worker (exact path, then resources/<name> next to the app, then the
+// built-in default), checks the mtime, decodes again only on a miss or when
+// the file changed on disk, and emits loaded() either way.
+class BackgroundImageLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int CacheSize = 4;
+
+    explicit BackgroundImageLoader(QObject *parent = nullptr);
+    ~BackgroundImageLoader() override;
+
+    // Last image decoded for 'path', or a null image.
+    static QImage cached(const QString &path);
+
+    // Decode (or revalidate) 'path' on the worker.
+    void request(const QString &path);
+
+signals:
+    // 'image' is null when nothing could be loaded for 'path'.
+    void loaded(const QString &path, const QImage &image);
+
+private:
+    QThreadPool pool;   // one thread: requests finish in order
+};
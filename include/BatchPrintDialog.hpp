@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QDialog>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <functional>
+
+#include "ZplTemplate.hpp"
+
+class QTableWidget;
+class QLabel;
+class PrintQueue;
+struct LabelJob;
+
+// Grid of DEFAULT / KEYTAG work orders printed together. All checked rows
+// for one printer go out as a single concatenated ZPL stream (one
+// connection, one spooler job); status is still reported per row.
+class BatchPrintDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // Queues 'zpl' for 'printer' and returns the print job id (0 = failed).
+    using SubmitFn = std::function<quint64(const QByteArray &zpl, const QString &printer)>;
+
+    BatchPrintDialog(PrintQueue *queue, SubmitFn submit, QWidget *parent = nullptr);
+
+    void setPrinters(const QString &defaultPrinter, const QString &keytagPrinter);
+    void setDefaultMiles(int miles);
+    void setFormatMode(ZplTemplate::Mode mode);
+
+private slots:
+    void addRow();
+    void removeSelectedRows();
+    void pasteRows();
+    void checkAll();
+    void printChecked();
+    void onJobFinished(quint64 id, const QString &printer, bool ok, const QString &message);
+
+private:
+    enum Column {
+        ColPrint, ColStyle, ColMileage, ColInterval, ColOilType,
+        ColCustomer, ColCar, ColPlate, ColVin, ColColor, ColRepairOrder, ColQuantity,
+        ColStatus, ColumnCount
+    };
+
+    void insertRow(const QStringList &values);
+    int rowForKey(int key) const;
+    LabelJob jobForRow(int row) const;
+    void setRowStatus(int key, const QString &text, bool error);
+
+    QTableWidget *table;
+    QLabel *summaryLabel;
+    PrintQueue *queue;
+    SubmitFn submit;
+
+    QString defaultPrinter;
+    QString keytagPrinter;
+    int defaultMiles = 5000;
+    ZplTemplate::Mode formatMode = ZplTemplate::Recall;
+
+    int nextRowKey = 1;                  // stable row id (rows can be removed while printing)
+    QHash<quint64, QList<int>> rowsByJob; // print job id -> row keys in that stream
+};
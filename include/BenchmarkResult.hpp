@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QString>
+
+// One measurement from a benchmark run (--bench-zpl, --bench, --load-test),
+// printed and written as JSON by PreviewBenchmark and LoadGenerator.
+struct BenchmarkResult
+{
+    QString name;           // e.g. "zpl.recall.DEFAULT"
+    QString label;          // as printed
+    double value = 0;
+    QString unit;           // "jobs/s", "us", "ms", ...
+    bool higherIsBetter = false;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <QHash>
+
+// libcups is available on macOS and most Linux desktops, but the headers
+// being installed says nothing about the link line. Build with
+// -DOILSTICKER_WITH_CUPS together with -lcups to use the API; without it
+// jobs go through lpr (and raw / IPP for network printers).
+#if defined(OILSTICKER_WITH_CUPS) && !defined(Q_OS_WIN)
+#  define OILSTICKER_HAVE_CUPS 1
+#endif
+
+typedef struct _http_s http_t;
+
+// Prints through the CUPS C API instead of spawning lpr for every job.
+// The HTTP connection to cupsd stays open between jobs.
+class CupsPrinterBackend
+{
+public:
+    CupsPrinterBackend() = default;
+    ~CupsPrinterBackend();
+
+    CupsPrinterBackend(const CupsPrinterBackend &) = delete;
+    CupsPrinterBackend &operator=(const CupsPrinterBackend &) = delete;
+
+    // False when the app was built without libcups.
+    static bool isAvailable();
+
+    // CUPS queue names, with printer-make-and-model in 'models' when known.
+    // Without libcups the names come from lpstat, where it exists.
+    static QStringList queues(QHash<QString, QString> *models);
+
+    // Submit 'data' as a raw document to CUPS queue 'printer'.
+    // On success 'jobId' receives the CUPS job id. On failure 'retryable'
+    // is true when cupsd could not be reached or had a server-side error
+    // and no job was left behind, false when CUPS refused the job (unknown
+    // queue, client error) or may already have it.
+    bool print(const QString &printer, const QByteArray &data, const QString &title,
+               int *jobId, QString *error, bool *retryable = nullptr);
+
+    // Current CUPS job state keyword ("pending", "processing", "completed",
+    // "aborted", ...) or an empty string if it could not be queried.
+    QString jobState(int jobId, bool *finished, QString *error);
+
+    // Queue state ("idle", "processing", "stopped") and printer-state-reasons
+    // with the severity suffixes and "none" removed; "paused" is added when
+    // the queue is stopped. Empty state if it could not be queried.
+    QString printerState(const QString &printer, QStringList *reasons, QString *error);
+
+private:
+    http_t *connection(QString *error);
+    void closeConnection();
+
+    http_t *http = nullptr;
+};
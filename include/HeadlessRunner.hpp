@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "BenchmarkResult.hpp"
+#include "LabelJob.hpp"
+
+class PrintQueue;
+
+// Command-line / stdin entry point that prints without building any
+// widgets. Runs on QCoreApplication and shares LabelJob and the saved
+// printer settings with the GUI.
+//
+//   OilStickerApp --print --style DEFAULT --mileage 123456 --oil "MOBIL1 0W40"
+//   shop-export | OilStickerApp --jsonl
+//   OilStickerApp --csv < appointments.csv
+//   OilStickerApp --bench-zpl 100000
+//
+// One status line per job is written to stdout:  <job>\t<code>\t<message>
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Per-job status codes; the process exit code is the highest one seen.
+    enum JobStatus {
+        StatusOk          = 0,
+        StatusPrintFailed = 1,
+        StatusInvalid     = 2,
+        StatusNoPrinter   = 3
+    };
+    static constexpr int ExitUsage = 64;
+
+    explicit HeadlessRunner(QObject *parent = nullptr);
+
+    // True when argv asks for headless mode; checked before any
+    // QApplication is created.
+    static bool isHeadless(int argc, char *argv[]);
+
+    // Parse arguments/stdin, print, wait for results. Returns the exit code.
+    int run(const QStringList &arguments);
+
+    // ZPL generation throughput for the stock formats, 'count' jobs per
+    // case. Each case is printed as it finishes.
+    static QList<BenchmarkResult> benchZplCases(int count);
+
+private:
+    struct Entry
+    {
+        LabelJob job;
+        QString printer;   // per-job override, else from settings
+        int status = StatusOk;
+        QString message;
+    };
+
+    int benchZpl(int count);
+
+    static LabelJob jobFromMap(const QVariantMap &fields, QString *printer);
+    bool readJsonLines(QString *error);
+    bool readCsv(QString *error);
+    static QStringList splitCsvLine(const QString &line);
+
+    void report(int index, const Entry &entry);
+
+    QList<Entry> entries;
+    bool statusToStderr = false;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVariant>
+
+class QTcpSocket;
+
+// IPP/2.0 client for network label printers (RFC 8010/8011 subset):
+// Print-Job, Get-Job-Attributes and Get-Printer-Attributes over one
+// persistent HTTP/1.1 connection per printer, with pipelined requests.
+class IppClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DefaultPort = 631;
+
+    enum Operation : quint16 {
+        OpPrintJob             = 0x0002,
+        OpGetJobAttributes     = 0x0009,
+        OpGetPrinterAttributes = 0x000B
+    };
+
+    // IPP status codes we act on.
+    enum Status : quint16 {
+        SuccessfulOk                          = 0x0000,
+        SuccessfulOkIgnoredOrSubstituted      = 0x0001,
+        SuccessfulOkConflicting               = 0x0002,
+        ClientErrorDocumentFormatNotSupported = 0x040A
+    };
+
+    // Whether a request reached the printer. A Print-Job that was written
+    // but never answered may still have printed, so it is not resent.
+    enum Delivery {
+        NotSent,      // no byte of it left this host: safe to send again
+        Unknown,      // written (or partly), then the connection failed
+        Answered
+    };
+
+    struct Response
+    {
+        bool ok = false;          // transport and IPP status both succeeded
+        Delivery delivery = NotSent;
+        int httpStatus = 0;
+        int ippStatus = -1;
+        quint32 requestId = 0;
+        QString error;
+        QHash<QString, QVariantList> attributes;
+
+        // Worth sending again later: never sent, or refused by a busy or
+        // failing server (HTTP 5xx, IPP server-error-*) rather than for
+        // the request itself.
+        bool isRetryable() const;
+
+        int intValue(const QString &name, int fallback = -1) const;
+        QString stringValue(const QString &name) const;
+    };
+
+    explicit IppClient(QObject *parent = nullptr);
+    ~IppClient() override;
+
+    // MIME type sent as document-format. Zebra firmware accepts
+    // "application/vnd.zebra-zpl"; others want "application/octet-stream".
+    void setDocumentFormat(const QString &format) { documentFormat = format; }
+
+    // Print every document as its own Print-Job, pipelined over one
+    // connection. Returns one response per document, in order. Requests
+    // cut off by a dropped connection are resent only if none of their
+    // bytes went out; the others come back with delivery Unknown.
+    QList<Response> printJobs(const QString &printer, const QList<QByteArray> &documents,
+                              const QString &jobName);
+
+    Response jobAttributes(const QString &printer, int jobId);
+    Response printerAttributes(const QString &printer, const QStringList &requested);
+
+    void disconnectAll();
+
+    // "host", "host:port" or a full ipp:// URI -> ipp://host:631/ipp/print
+    static QString printerUri(const QString &printer);
+
+    // job-state enum (RFC 8011 5.3.7) -> keyword; 'finished' for final states.
+    static QString jobStateName(int state, bool *finished = nullptr);
+
+    // --- Encoder / decoder ---
+    static QByteArray encodePrintJob(const QString &uri, quint32 requestId, const QString &jobName,
+                                     const QString &documentFormat, const QByteArray &document);
+    static QByteArray encodeGetJobAttributes(const QString &uri, quint32 requestId, int jobId);
+    static QByteArray encodeGetPrinterAttributes(const QString &uri, quint32 requestId,
+                                                 const QStringList &requested);
+    static bool decodeResponse(const QByteArray &body, Response *response);
+
+private:
+    // Send every IPP message in 'bodies' as an HTTP POST on one connection
+    // without waiting for replies in between, then read the replies in order.
+    // After a Connection: close reply the rest were not processed (RFC 9112
+    // 9.6) and go out again on a new connection, as do requests that were
+    // never written; written but unanswered ones are left Unknown.
+    QList<Response> pipeline(const QString &printer, const QList<QByteArray> &bodies);
+
+    QTcpSocket *socketFor(const QString &printer, QString *error);
+    void dropSocket(const QString &printer);
+    bool readHttpResponse(QTcpSocket *socket, int *status, QByteArray *body,
+                          bool *keepAlive, QString *error);
+
+    QHash<QString, QTcpSocket *> sockets;
+    QString documentFormat = "application/vnd.zebra-zpl";
+    quint32 nextRequestId = 1;
+    int connectTimeoutMs = 3000;
+    int ioTimeoutMs = 10000;
+};
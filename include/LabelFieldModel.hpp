@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QObject>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QValidator>
+
+class QTimer;
+
+// Sits between the line edits and the preview. Raw input text is stored as
+// it arrives; the ^FN values the preview shows are derived at most once per
+// frame and only the ones that differ from what was last handed out are
+// emitted. A keystroke after a pause is shown on the next event loop pass;
+// a barcode scanner typing a whole VIN costs one or two preview updates.
+class LabelFieldModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Input {
+        Mileage, Interval, OilType,                        // DEFAULT
+        Customer, Car, Plate, Vin, Color, RepairOrder,     // KEYTAG
+        InputCount
+    };
+
+    static constexpr int FrameMs = 16;
+
+    explicit LabelFieldModel(QObject *parent = nullptr);
+
+    // Store 'text' and schedule an update for the next frame.
+    void setInput(Input input, const QString &text);
+
+    // "DEFAULT" or "KEYTAG". Every field of the new style is re-sent.
+    void setStyle(const QString &style);
+
+    // Used when the interval field is empty or not a number.
+    void setDefaultMiles(int miles);
+
+    // ^FN values last emitted, for the current style.
+    QHash<int, QString> fields() const { return current; }
+
+    // Emit pending changes now instead of waiting for the frame timer.
+    void flush();
+
+signals:
+    // Only the ^FN numbers whose value changed.
+    void fieldsChanged(const QHash<int, QString> &changed);
+
+private:
+    void schedule();
+    QHash<int, QString> derive();
+
+    QString inputs[InputCount];
+    QString style = "DEFAULT";
+    int defaultMiles = 5000;
+    QTimer *frameTimer;
+    QElapsedTimer lastFlush;
+    QHash<int, QString> current;
+
+    // Date strings only change once a day.
+    QDate cachedDay;
+    QString todayText;
+    QString nextDateText;
+};
+
+// Upper-cases input as it is typed, so the line edit never needs a
+// setText() round-trip (and a second textChanged) to fix the case.
+class UpperCaseValidator : public QValidator
+{
+    Q_OBJECT
+
+public:
+    using QValidator::QValidator;
+
+    State validate(QString &input, int &pos) const override;
+};
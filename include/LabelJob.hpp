@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QDate>
+
+#include "ZplTemplate.hpp"
+
+// Field data for one label submission, independent of the widgets that
+// collected it. Shared by the main window and the batch grid.
+struct LabelJob
+{
+    QString style = "DEFAULT";   // "DEFAULT" or "KEYTAG"
+    QString templateName;        // empty = DEFAULT.ZPL / KEYTAG.ZPL by style
+
+    // DEFAULT sticker
+    QString mileage;             // current mileage as typed
+    QString interval;            // miles until next service; empty = defaultMiles
+    QString oilType;
+
+    // KEYTAG
+    QString customer;
+    QString car;
+    QString plate;
+    QString vin;
+    QString color;
+    QString repairOrder;
+    int quantity = 1;            // key tags wanted (two per LABEL.ZPL label)
+
+    // ^FO..^XG..^FS placing the stored logo (TemplateSync::logoPlacement);
+    // empty = no logo.
+    QByteArray logo;
+
+    bool isKeyTag() const { return style == "KEYTAG"; }
+
+    // False with a user-facing message when the fields cannot be printed.
+    bool validate(QString *error) const;
+
+    // ^XA...^XZ block: recalls the stored format with ^XF and fills ^FN
+    // (Recall), or sends the whole format with the data in place (Inline).
+    // The logo, if any, is placed last in either mode.
+    QByteArray toZpl(int defaultMiles, ZplTemplate::Mode mode = ZplTemplate::Recall,
+                     const QDate &today = QDate::currentDate()) const;
+
+    // Same, appended to a reusable buffer (batch streams, benchmarks).
+    void appendZpl(QByteArray &out, int defaultMiles, ZplTemplate::Mode mode = ZplTemplate::Recall,
+                   const QDate &today = QDate::currentDate()) const;
+
+    // Template the job recalls: KEYTAG switches to LABEL.ZPL for more than
+    // one physical label.
+    QString effectiveTemplate() const;
+
+    // ^PQ count for KEYTAG: two tags per label, rounded up.
+    int labelCount() const;
+};
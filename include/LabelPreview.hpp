@@ -3,6 +3,17 @@
 #include <QFrame>
 #include <QString>
 #include <QPixmap>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPainterPath>
+#include <QStaticText>
+
+#include "ZplRasterizer.hpp"
+
+class QPainter;
+class BackgroundImageLoader;
 
 class LabelPreview : public QFrame
 {
@@ -29,31 +40,93 @@ public:
                        const QString &color = QString(),
                        const QString &repairOrder = QString());
 
-    // Change the background image (filesystem path or resource path)
+    // Field values by ^FN number for the current style, as emitted by
+    // LabelFieldModel; only the fields that differ are repainted.
+    void setFields(const QHash<int, QString> &fields);
+
+    // Change the background image (filesystem path or resource path). It is
+    // decoded on a worker thread; the current one stays up until then.
     void setBackground(const QString &backgroundPath);
 
+    // True until the image asked for by setBackground() is shown.
+    bool isBackgroundPending() const { return backgroundPending; }
+
+    // True until Zebra font 0 is registered and the template rasterized;
+    // frames before that show the background only.
+    bool isFontPending() const { return fontPending; }
+
+    // Decode 'path' into the shared cache without showing it, so a later
+    // setBackground() (e.g. the other style's) is instant.
+    void prefetchBackground(const QString &path);
+
     // Select which label style to render. "DEFAULT" or "KEYTAG"
     void setLabelStyle(const QString &style);
 
+    // Stored format the job recalls (empty = DEFAULT.ZPL / KEYTAG.ZPL by
+    // style). Formats with a local source in zpl/ are previewed by
+    // rasterizing the real template; others fall back to plain text.
+    void setTemplateName(const QString &name);
+
+    // Resolution of the printer the preview stands for (203 or 300).
+    void setPrinterDpi(int dpi);
+
+    // Where the label sits in the widget (one pixel per 203-dpi dot).
+    QRect labelRect() const;
+
+signals:
+    // Fields, format or background changed (LabelSheetView re-grabs).
+    void labelChanged();
+
 protected:
     void paintEvent(QPaintEvent *event) override;
 
 private:
-    // Try to load a pixmap from 'path'. If fails, return a null pixmap.
-    QPixmap tryLoadPixmap(const QString &path) const;
+    static constexpr const char *DefaultBackground = ":/resources/default.png";
+
+    // Reload the rasterizer when the effective template or dpi changed.
+    void updateFormat();
+    QHash<int, QString> fieldData() const;
+    QString *fieldValue(int fieldNumber);
+    void repaintChangedFields(const QList<int> &changed);
+
+    // Full rasterization (format or style change) and the ink copy of a
+    // dot rectangle of it.
+    void renderLabel();
+    void updateInk(const QRect &dots);
+
+    QRect dotsToWidget(const QRect &dots) const;
+    void rebuildStaticLayer();
 
-    // Try multiple fallback locations for the given filename:
-    // 1) exact path (if absolute or relative)
-    // 2) app bundle Resources/<basename> (useful inside .app)
-    // 3) embedded resource ":/resources/<basename>" (your default)
-    QPixmap loadWithFallback(const QString &path) const;
+    // Hand-placed text for formats without a local source.
+    void updateFallbackFonts();
+    void paintTextFallback(QPainter &painter, const QRect &labelRect);
+
+    // A field's text laid out once; relaid only when its text or font
+    // changes, so repaints neither shape nor measure it again.
+    struct FieldText
+    {
+        QString text;
+        QFont font;
+        QStaticText layout;
+        int ascent = 0;       // drawStaticText() places the top, not the baseline
+        int width = 0;        // for right-aligned fields
+    };
+    const FieldText &fieldText(int fieldNumber, const QString &text, const QFont &font);
+    void drawFieldText(QPainter &painter, const FieldText &field, int x, int baseline);
+
+    void onFontLoaded();
+    void onBackgroundLoaded(const QString &path, const QImage &image);
+    void applyBackground(const QImage &image);
 
     // Quantity
     //int m_quantity = 1;
     int quantity = 1;
 
     // Member state
-    QPixmap background;
+    QImage background;              // ARGB32_Premultiplied, from the loader
+    QString backgroundPath;         // last asked for
+    bool backgroundPending = false;
+    BackgroundImageLoader *backgroundLoader;
     QString nextMileage;
     QString nextDate;
     QString oilType;
@@ -68,5 +141,23 @@ private:
     QString repairOrder;
 
     QString zebraFontFamily;
+    bool fontPending = true;
     QString currentStyle; // "DEFAULT" or "KEYTAG"
+    QString templateName; // as set; see setTemplateName()
+
+    ZplRasterizer rasterizer;   // effective template, parsed once
+    int printerDpi = ZplRasterizer::DefaultDpi;
+
+    // Repaint caches. The static layer is rebuilt on style, background or
+    // devicePixelRatio changes; the label images on format changes, and
+    // per field as fields change.
+    QPixmap staticLayer;        // white base + background + label outline
+    bool staticLayerDirty = true;
+    QPainterPath labelOutline;
+    QImage labelDots;           // RGB32, printer dots
+    QImage labelInk;            // labelDots with the paper transparent
+    QFont smallFont;
+    QFont largeFont;
+    int smallLineHeight = 0;
+    QHash<int, FieldText> fieldTexts;   // by ^FN number
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QPixmap>
+#include <QString>
+
+class QTimer;
+class LabelPreview;
+
+// Horizontal strip with every physical label a key tag job prints:
+// ceil(quantity / 2) copies of LABEL.ZPL (^PQ), two tags per label, cut in
+// half. All labels are identical, so one tile grabbed from the preview is
+// cached and only the tiles in view are drawn; 99 tags cost one label.
+class LabelSheetView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    static constexpr int TileSize = 160;       // label side, pixels
+    static constexpr int Gap = 12;
+    static constexpr int CaptionHeight = 18;
+
+    explicit LabelSheetView(LabelPreview *source, QWidget *parent = nullptr);
+
+    // Key tags wanted (the quantity field).
+    void setQuantity(int tags);
+    int labelCount() const { return (quantity + 1) / 2; }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void invalidateTile();
+    void rebuildTile();
+
+private:
+    void updateScrollBar();
+    int tileWidth() const;
+    QString caption(int label) const;
+
+    LabelPreview *source;
+    QPixmap tile;               // one label with the cut line, device pixels
+    QTimer *tileTimer;          // coalesces preview changes into one grab
+    bool tileDirty = true;
+    int quantity = 1;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "BenchmarkResult.hpp"
+#include "PrintQueue.hpp"
+
+// Replays recorded print jobs through PrintQueue, against a real printer or
+// a MockPrinter, and measures the transports and the queue:
+//
+//   OilStickerApp --load-test --mock --speed 10
+//   OilStickerApp --load-test --replay mock-printer/jobs.log --printer 10.0.0.42 --speed 0
+//   OilStickerApp --load-test --protocol ipp --printer 127.0.0.1:8631 --json load.json
+//
+// The log is the print journal (a copy is read, so the GUI can stay open)
+// or a MockPrinter jobs.log. Jobs keep their recorded spacing divided by
+// --speed (0 = back to back). Reports throughput, the enqueue-to-result
+// latency spread, the deepest queue and failures, as printed lines and
+// optionally the same JSON layout PreviewBenchmark writes.
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ExitFailed = 1;    // some jobs failed
+    static constexpr int ExitUsage = 64;
+
+    struct Job
+    {
+        qint64 offsetMs = 0;   // from the first job in the log
+        QByteArray data;
+    };
+
+    explicit LoadGenerator(QObject *parent = nullptr);
+
+    // True when argv asks for a load test; checked before any
+    // QApplication is created.
+    static bool isRequested(int argc, char *argv[]);
+
+    // Returns the exit code.
+    int run(const QStringList &arguments);
+
+    // Jobs in the order they were submitted.
+    static bool readJournal(const QString &path, QList<Job> *jobs, QString *error);
+    static bool readMockLog(const QString &path, QList<Job> *jobs, QString *error);
+
+private:
+    // Send 'jobs' to 'printer' and wait for every result.
+    QList<BenchmarkResult> replay(const QList<Job> &jobs, const QString &printer, PrintTransport transport,
+                                  double speed, int *failed);
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QCommandLineOption;
+class QCommandLineParser;
+class QTcpServer;
+class QTcpSocket;
+
+// Stand-in for a ZD420 / GX420T so printing can be exercised on any box:
+//
+//   OilStickerApp --mock-printer --latency 50 --paper-out-every 20
+//
+// Listens for raw ZPL (9100), IPP (Print-Job, Get-Job-Attributes,
+// Get-Printer-Attributes on /ipp/print) and LPD (RFC 1179 receive job).
+// Answers ~HS, ~HQES and ~HI, keeps ^DF formats and ~DG graphics so
+// ^HW / ^HF and TemplateSync work, and writes every job it receives to
+// the output folder with a line in jobs.log (which LoadGenerator can
+// replay).
+//
+// Faults on demand: a delay before every reply, connections reset on
+// accept, reading stopped for a while every N jobs, and paper out for a
+// while every N labels (reported by ~HS, ~HQES and IPP). Raw jobs are
+// small enough to sit in the socket buffers, so on 9100 latency and stalls
+// show in status queries and large jobs rather than in each send.
+class MockPrinter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ExitUsage = 64;
+    static constexpr int IdleFlushMs = 250;   // raw: a pause this long ends a job
+
+    struct Options
+    {
+        QHostAddress address = QHostAddress::LocalHost;
+        quint16 rawPort = 9100;       // 0 = off
+        quint16 ippPort = 8631;       // 631 and 515 need root
+        quint16 lpdPort = 8515;
+        QString outputDir = "mock-printer";
+        int latencyMs = 0;            // before every reply
+        double dropRate = 0;          // fraction of connections reset
+        int stallEvery = 0;           // jobs
+        int stallMs = 0;
+        int paperOutEvery = 0;        // labels
+        int paperOutMs = 0;
+    };
+
+    explicit MockPrinter(const Options &options, QObject *parent = nullptr);
+    ~MockPrinter() override;
+
+    // Open the listeners and the output folder.
+    bool start(QString *error);
+
+    int jobCount() const { return jobs; }
+    int labelCount() const { return labels; }
+    bool isPaperOut() const;
+
+    // Options shared by --mock-printer and LoadGenerator --mock.
+    static QList<QCommandLineOption> commandLineOptions();
+    static bool optionsFromParser(const QCommandLineParser &parser, Options *options, QString *error);
+
+    // True when argv asks for the mock printer; checked before any
+    // QApplication is created.
+    static bool isRequested(int argc, char *argv[]);
+
+    // Serve until killed. Returns the exit code.
+    static int run(const QStringList &arguments);
+
+signals:
+    // After a job has been written to disk.
+    void jobReceived(const QString &transport, const QString &file, int bytes, int labels);
+
+private:
+    struct RawConnection
+    {
+        QByteArray buffer;
+        QByteArray job;               // labels since the last flush
+        int labels = 0;
+    };
+
+    struct IppConnection
+    {
+        QByteArray buffer;
+        bool busy = false;            // a response is on its way
+        bool continued = false;       // 100 Continue sent for this request
+    };
+
+    struct LpdConnection
+    {
+        QByteArray buffer;
+        QByteArray data;              // data files of the current job
+        bool inJob = false;
+        qint64 expect = -1;           // bytes of the file being received
+        bool dataFile = false;
+    };
+
+    void acceptRaw();
+    void readRaw(QTcpSocket *socket);
+    void flushRaw(QTcpSocket *socket);
+    QByteArray handleBlock(const QByteArray &block, RawConnection &c);
+
+    void acceptIpp();
+    void readIpp(QTcpSocket *socket);
+    QByteArray handleIpp(const QByteArray &request, const QString &peer);
+
+    void acceptLpd();
+    void readLpd(QTcpSocket *socket);
+
+    bool dropConnection(QTcpSocket *socket);
+    // ms left of the current stall; the read is retried after it.
+    qint64 stallRemaining() const;
+    void reply(QTcpSocket *socket, const QByteArray &data);
+    void recordJob(const QString &transport, const QString &peer, const QByteArray &data, int labelCount);
+
+    QByteArray hostStatus() const;
+    QByteArray extendedStatus() const;
+    QByteArray directory(const QString &pattern) const;
+
+    // Labels in a job: ^XA...^XZ blocks that are not downloads or queries,
+    // each counted ^PQ times.
+    static int countLabels(const QByteArray &data);
+
+    Options options;
+    QDir outputDir;
+    QTcpServer *rawServer = nullptr;
+    QTcpServer *ippServer = nullptr;
+    QTcpServer *lpdServer = nullptr;
+    QHash<QTcpSocket *, RawConnection> raw;
+    QHash<QTcpSocket *, IppConnection> ipp;
+    QHash<QTcpSocket *, LpdConnection> lpd;
+
+    QHash<QString, QByteArray> stored;    // "DEFAULT.ZPL" / "LOGO.GRF" -> download
+    QHash<int, bool> ippJobsStopped;      // IPP job id -> received while paper out
+    QElapsedTimer clock;
+    qint64 stallUntil = 0;                // on 'clock'
+    qint64 paperOutUntil = 0;
+    int jobs = 0;
+    int labels = 0;
+    int nextIppJobId = 1;
+};
@@ -1,12 +1,25 @@
 #pragma once
 
 #include <QWidget>
+#include <QHash>
+#include <QThreadPool>
+
+#include "LabelFieldModel.hpp"
+#include "ZplTemplate.hpp"
+#include "VehicleIndex.hpp"
 
 class QLabel;
 class QLineEdit;
+class QVBoxLayout;
 class QPushButton;
 class LabelPreview;
+class LabelSheetView;
 class QComboBox;
+class QCheckBox;
+class PrintQueue;
+class PrinterDiscovery;
+class PrintJournal;
+struct LabelJob;
 
 class OilLabelGUI : public QWidget
 {
@@ -16,60 +29,124 @@ public:
     explicit OilLabelGUI(QWidget *parent = nullptr);
 
 private slots:
-    void liveUpdate();
     void printLabel();
+    void openBatchPrint();
+    void reprint();
     void clearInputs();
     void selectPrinter();
+    void refreshPrinters();
+    void selectNetworkProtocol();
+    void syncFormats();
     void changeBackground();
+    void selectLogo();
     void selectTemplate();
     void resetSettings();
     void showAboutDialog();
     void onStyleChanged(const QString &style);
+    void setVehicleTicket(bool on);
+    void onPrintJobFinished(quint64 id, const QString &printer, bool ok, const QString &message);
+    void onPrintJobStateChanged(quint64 id, const QString &printer, int spoolerJobId, const QString &state);
+    void onTemplatesSynced(const QString &printer, bool ok, const QString &summary);
+    void updateQueueStatus();
+    void updatePrinterStatus();
+    void updatePreviewFormat();
+    void updateSheet();
 
 private:
-    // Common
-    QLabel *mileageLabel;
-    QLineEdit *mileageInput;
+    // Field panels, each built the first time its style is shown (see
+    // ensureStickerPanel() / ensureKeytagPanel()); null until then.
+    QVBoxLayout *formLayout;
+    QWidget *stickerPanel = nullptr;
+    QWidget *keytagPanel = nullptr;
 
-    QLabel *intervalLabel;
-    QLineEdit *intervalInput;
+    // Sticker fields
+    QLabel *mileageLabel = nullptr;
+    QLineEdit *mileageInput = nullptr;
 
-    QPushButton *printBtn;
-    QPushButton *clearBtn;
+    QLabel *intervalLabel = nullptr;
+    QLineEdit *intervalInput = nullptr;
 
-    // Default-style fields
-    QLabel *templateLabel;
-    QLineEdit *templateInput; // displays template name for editing (also stored in templateName)
-    QLabel *oilTypeLabel;
-    QLineEdit *oilTypeInput;
+    QLabel *templateLabel = nullptr;
+    QLineEdit *templateInput = nullptr; // displays template name for editing (also stored in templateName)
+    QLabel *oilTypeLabel = nullptr;
+    QLineEdit *oilTypeInput = nullptr;
 
-    // Keytag fields (hidden when default)
-    QLabel *kt_templateLabel;
-    QLineEdit *kt_templateInput;
-    QLabel *customerLabel;
-    QLineEdit *customerInput;
-    QLabel *carLabel;
-    QLineEdit *carInput;
-    QLabel *plateLabel;
-    QLineEdit *plateInput;
-    QLabel *vinLabel;
-    QLineEdit *vinInput;
-    QLabel *colorLabel;
-    QLineEdit *colorInput;
-    QLabel *repairOrderLabel;
-    QLineEdit *repairOrderInput;
-    QLabel *quantityLabel;
-    QLineEdit *quantityInput;
+    // Keytag fields
+    QLabel *kt_templateLabel = nullptr;
+    QLineEdit *kt_templateInput = nullptr;
+    QLabel *customerLabel = nullptr;
+    QLineEdit *customerInput = nullptr;
+    QLabel *carLabel = nullptr;
+    QLineEdit *carInput = nullptr;
+    QLabel *plateLabel = nullptr;
+    QLineEdit *plateInput = nullptr;
+    QLabel *vinLabel = nullptr;
+    QLineEdit *vinInput = nullptr;
+    QLabel *colorLabel = nullptr;
+    QLineEdit *colorInput = nullptr;
+    QLabel *repairOrderLabel = nullptr;
+    QLineEdit *repairOrderInput = nullptr;
+    QLabel *quantityLabel = nullptr;
+    QLineEdit *quantityInput = nullptr;
+
+    QPushButton *printBtn;
+    QPushButton *clearBtn;
 
     LabelPreview *preview;
+    LabelSheetView *sheet;           // all labels of a multi-label key tag job
+    LabelFieldModel *fieldModel;     // input text -> changed ^FN fields, per frame
 
     QComboBox *styleCombo;           // dropdown to pick style
+    QCheckBox *ticketCheck;          // vehicle ticket: sticker + key tag from one form
+    bool vehicleTicket = false;
     QString labelStyle;              // "DEFAULT" or "KEYTAG"
     QString printerName;             // stores selected printer (or IP)
     QString backgroundPath;          // stores selected background PNG
     QString templateName;            // stores template name (DEFAULT.ZPL / KEYTAG.ZPL)
     int defaultMiles;
     bool useIppPrinting = false;
+    bool inlineFormats = false;      // send whole formats instead of ^XF recall
+    QString networkProtocol;         // "RAW" (9100) or "IPP" (631) for printers given by IP
     QString keytagPrinterName;
-    void sendZplToPrinter(const QString &zpl, const QString &printer);
+    PrintQueue *printQueue;          // print thread; CUPS, raw 9100 and IPP jobs
+    PrinterDiscovery *discovery;     // CUPS / DNS-SD / 9100 sweep, cached
+    static constexpr int DiscoveryMaxAgeSecs = 600;
+    QLabel *queueStatusLabel;
+    QLabel *printerStatusLabel;      // ready / paused / paper out per printer
+    QString lastSpoolerStatus;       // e.g. "ZD420 job 123 completed"
+    QString lastFormatStatus;        // result of the last format sync
+    PrintJournal *journal;           // every queued job, for Reprint
+    VehicleIndex *vehicles;          // plate / VIN / RO recall
+    QThreadPool storeLoader;         // opens the journal off the startup path
+    bool storesReady = false;
+    // Until this has run the journal and the vehicle index are not to be
+    // touched; it only blocks if they are needed in the first moments.
+    void waitForStores();
+    int currentVehicle = -1;         // record the next sticker is credited to
+    static constexpr int RecallMatches = 12;
+    QHash<quint64, quint64> journalIds;  // print job id -> journal id
+    static constexpr int ReprintListSize = 200;
+    // Queue 'zpl' for 'printer' and journal it; returns the print job id,
+    // 0 if not queued. 'job' is the form the ZPL came from, if any.
+    quint64 sendZplToPrinter(const QByteArray &zpl, const QString &printer,
+                             const LabelJob *job = nullptr, quint64 reprintOf = 0);
+    LabelJob currentJob() const;
+    LabelJob jobForStyle(const QString &style) const;
+    void printVehicleTicket();
+    void updateFieldVisibility();
+    // Build a field panel (hidden) if it does not exist yet.
+    void ensureStickerPanel();
+    void ensureKeytagPanel();
+    // Feed 'edit' into the field model, now and on every change.
+    void bindInput(QLineEdit *edit, LabelFieldModel::Input input);
+    void showTemplateName();
+    void watchPrinters();
+    // Resolution discovery reported for 'printer', 203 dpi if unknown.
+    int printerDpi(const QString &printer) const;
+    // Pop up index matches under 'edit' as it is typed.
+    void attachRecall(QLineEdit *edit, VehicleIndex::Key key);
+    // Fill the key tag fields (and the sticker's oil/interval) from a record.
+    void recallVehicle(int record, const QString &repairOrder);
+    void prefillSticker();
+    ZplTemplate::Mode formatMode() const;
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "BenchmarkResult.hpp"
+
+class QLineEdit;
+class LabelPreview;
+
+// Benchmarks and golden-image checks that need the real widgets. They run
+// on QApplication with the "offscreen" platform unless QT_QPA_PLATFORM or
+// -platform says otherwise:
+//
+//   OilStickerApp --bench --json results.json --baseline last.json
+//   OilStickerApp --golden            (diff renders against samples/)
+//   OilStickerApp --update-golden     (rewrite samples/golden/)
+//   OilStickerApp --bench-latency 500
+//
+// The preview, field model and line edits are wired as in OilLabelGUI, but
+// without the main window, so no settings, printers or network are touched.
+class PreviewBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ExitFailed = 1;    // golden mismatch or regression
+    static constexpr int ExitUsage = 64;
+
+    explicit PreviewBenchmark(QObject *parent = nullptr);
+
+    // True when argv asks for a GUI benchmark; checked before any
+    // QApplication is created.
+    static bool isRequested(int argc, char *argv[]);
+
+    // Returns the exit code.
+    int run(const QStringList &arguments);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct GoldenResult
+    {
+        QString name;
+        QString status;         // "pass", "fail", "missing", "updated", "error"
+        double mismatch = 0;    // fraction of dots that differ
+        double tolerance = 0;
+        QString detail;
+    };
+
+    // LabelPreview::paintEvent per style: full repaints and single-field
+    // updates.
+    bool benchPaint(int count, QList<BenchmarkResult> *results);
+
+    // Key event to painted preview frame, one keystroke at a time and as
+    // barcode-scanner bursts.
+    bool benchLatency(int count, QList<BenchmarkResult> *results);
+
+    // Render each case and diff it against its PNG in 'samplesDir'.
+    // Differences and actual renders are written to 'outDir'.
+    QList<GoldenResult> checkGoldens(const QString &samplesDir, const QString &outDir, bool update);
+
+    // Fraction of ink/paper mismatches; the larger image is center-cropped.
+    static double compareInk(const QImage &actual, const QImage &golden, QImage *diff);
+
+    // Regressions of 'results' against a previous --json file.
+    static QStringList regressions(const QJsonObject &baseline, const QList<BenchmarkResult> &results,
+                                   double maxRegression);
+
+    // Spin the event loop until the preview has painted (true) or
+    // 'timeoutMs' passed.
+    bool waitForPaint(int timeoutMs);
+    static bool waitForPreview(LabelPreview *preview, int timeoutMs);
+    static void sendKey(QLineEdit *edit, int key, const QString &text, bool post = false);
+    static QList<double> percentiles(QList<double> ms);
+
+    int paints = 0;
+    QElapsedTimer clock;
+    qint64 lastPaintNs = 0;   // start of the latest preview paint
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include "LabelJob.hpp"
+
+class QLockFile;
+
+// One submitted job as recorded in the journal.
+struct JournalEntry
+{
+    enum Status { Pending, Printed, Failed };
+
+    quint64 id = 0;
+    QDateTime time;              // submitted
+    QString printer;
+    bool hasFields = false;      // false for raw streams (batch print)
+    LabelJob job;                // form fields, when hasFields
+    QByteArray zpl;              // exactly what was queued
+    quint64 reprintOf = 0;       // journal id this was replayed from, or 0
+    Status status = Pending;
+    QString message;             // print thread result
+    QDateTime finished;
+
+    // One line for pick lists: "DEFAULT 123456 MOBIL1 0W40", "3 labels", ...
+    QString summary() const;
+};
+
+// Append-only record of every job handed to the print queue, kept in a
+// memory-mapped file so an append is a memcpy into the page cache:
+//
+//   header (16 bytes) | record | record | ... | zeros to the end of the map
+//   record = magic, payload size, CRC-16, type | QDataStream payload
+//
+// Each record is flushed to disk (msync / FlushViewOfFile) before append()
+// or setResult() returns, and open() skips any record whose magic or
+// checksum does not match, so a crash or power loss mid-write drops only
+// the record being written. The file grows by ChunkSize.
+//
+// One process owns the journal at a time (a lock file next to it); a
+// second open() of the same path fails and that process does not journal.
+class PrintJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 ChunkSize = 1 << 20;
+
+    explicit PrintJournal(QObject *parent = nullptr);
+    ~PrintJournal() override;
+
+    // <GenericDataLocation>/WFWestHS/OilStickerApp/print-journal.bin
+    static QString defaultPath();
+
+    // Map 'path' (created if missing) and index the records in it.
+    bool open(const QString &path, QString *error);
+    bool isOpen() const { return map != nullptr; }
+    QString path() const { return file.fileName(); }
+
+    // Record a job and return its journal id (0 if the journal is not open).
+    // 'job' is null for streams that are not one form's worth of fields.
+    quint64 append(const QString &printer, const QByteArray &zpl, const LabelJob *job = nullptr,
+                   quint64 reprintOf = 0);
+
+    // Record the print thread's result for 'id'.
+    void setResult(quint64 id, bool ok, const QString &message);
+
+    int count() const { return int(jobOffsets.size()); }
+
+    // Newest first, at most 'max' entries.
+    QList<JournalEntry> recent(int max) const;
+
+    // Every job, oldest first, without the ZPL (for building indexes).
+    QList<JournalEntry> history() const;
+
+    // False if 'id' is not in the journal.
+    bool entry(quint64 id, JournalEntry *out) const;
+
+private:
+    enum RecordType : quint16 { JobRecord = 1, ResultRecord = 2 };
+
+    struct Result
+    {
+        JournalEntry::Status status = JournalEntry::Pending;
+        QString message;
+        QDateTime time;
+    };
+
+    bool writeRecord(RecordType type, const QByteArray &payload);
+    bool flush(qint64 offset, qint64 size);
+    bool reserve(qint64 bytes);
+    void scan();
+    bool readJob(qint64 offset, JournalEntry *out, bool withZpl = true) const;
+
+    QFile file;
+    QLockFile *lock = nullptr;
+    uchar *map = nullptr;
+    qint64 mapSize = 0;
+    qint64 end = 0;                          // first free byte
+
+    QMap<quint64, qint64> jobOffsets;        // journal id -> job record
+    QHash<quint64, Result> results;
+    quint64 nextId = 1;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+#include "PrinterStatus.hpp"
+
+class QThread;
+class QTimer;
+class RawPrinterTransport;
+class CupsPrinterBackend;
+class IppClient;
+class PrintSpool;
+
+// How a job reaches the printer.
+enum class PrintTransport {
+    Spooler,  // CUPS queue: libcups, or lpr without it
+    Raw,      // ZPL on TCP 9100
+    Ipp       // IPP Print-Job on :631/ipp/print
+};
+
+// One unit of work for the print thread.
+struct PrintJob
+{
+    quint64 id = 0;
+    QString printer;     // CUPS queue name or "host[:port]"
+    QByteArray data;     // bytes sent to the printer as-is
+    PrintTransport transport = PrintTransport::Spooler;
+    quint64 spoolSeq = 0;  // record in the printer's PrintSpool, 0 if not spooled
+};
+
+// Runs on a print thread, one per printer. Owns that printer's connections
+// so they are only ever touched from its thread.
+class PrintWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PrintWorker(QObject *parent = nullptr);
+    ~PrintWorker() override;
+
+    // Called on the print thread. Jobs are buffered and sent from drain()
+    // so consecutive IPP jobs for one printer can share a pipeline.
+    void enqueue(const PrintJob &job);
+
+    // Called on the print thread: keep this printer's jobs in an on-disk
+    // PrintSpool until they are sent, and pick up any left there by an
+    // earlier session. A job that could not reach the printer (no
+    // connection, timeout, spooler down) is not failed; it and everything
+    // queued behind it are retried, with backoff from RetryMinMs to
+    // RetryMaxMs, until the printer takes them. A job the printer refused
+    // (unknown queue, IPP client error) or may have printed in part fails
+    // straight away, so no label is ever printed twice.
+    void enableSpool(const QString &printer);
+
+    // Called on the print thread: bring the stored formats on 'printer' in
+    // line with zpl/ (see TemplateSync). 'dpi' sizes the logo (0 = 203).
+    void syncTemplates(const QString &printer, PrintTransport transport, const QStringList &formats, int dpi);
+
+    // Called on the print thread: poll these printers every
+    // PrintQueue::StatusPollMs and hold jobs for any that report a fault.
+    // Replaces the previous set.
+    void monitor(const QHash<QString, PrintTransport> &printers);
+
+    static constexpr int RetryMinMs = 2000;
+    static constexpr int RetryMaxMs = 60000;
+
+signals:
+    void jobFinished(quint64 id, const QString &printer, bool ok, const QString &message);
+    // 'count' unsent jobs from an earlier session were found in the spool;
+    // each is reported through jobFinished() with id 0.
+    void jobsRecovered(const QString &printer, int count);
+    // Spooler-side progress for jobs handed to CUPS or an IPP printer.
+    void jobStateChanged(quint64 id, const QString &printer, int spoolerJobId, const QString &state);
+    void templatesSynced(const QString &printer, bool ok, const QString &summary);
+    void printerStatusChanged(const QString &printer, const PrinterStatus &status);
+
+private:
+    void drain();
+    bool holdIfFaulted(const PrintJob &job);
+    void pollStatus();
+    PrinterStatus queryStatus(const QString &printer, PrintTransport transport);
+    void process(const PrintJob &job);
+    void succeed(const PrintJob &job, const QString &message);
+    void fail(const PrintJob &job, const QString &error, bool retryable);
+    void scheduleRetry(int delayMs = -1);
+    void retrySpooled();
+    QList<PrintJob> sendBacklog(QString *error);
+    QList<PrintJob> sendRun(const QList<PrintJob> &jobs, QString *error);
+    void sendCups(const PrintJob &job);
+    bool sendLpr(const PrintJob &job, QString *error, bool *retryable = nullptr);
+    void sendIpp(const QList<PrintJob> &batch);
+    void pollCupsJob(quint64 id, const QString &printer, int cupsJobId, int attempt);
+    void pollIppJob(quint64 id, const QString &printer, int ippJobId, int attempt);
+
+    static constexpr int MaxIppPipeline = 8;
+
+    QQueue<PrintJob> pending;
+    bool drainScheduled = false;
+
+    QHash<QString, PrintTransport> monitored;
+    QHash<QString, PrinterStatus> statuses;      // last poll per printer
+    QHash<QString, QQueue<PrintJob>> held;       // jobs waiting for a fault to clear
+    QTimer *statusTimer = nullptr;               // created on the print thread
+
+    PrintSpool *spool = nullptr;                 // null until enableSpool()
+    bool spooling = false;
+    QList<PrintJob> backlog;                     // undelivered, oldest first
+    QTimer *retryTimer = nullptr;                // created on the print thread
+    int retryDelayMs = 0;
+
+    RawPrinterTransport *rawTransport = nullptr; // created on the print thread
+    CupsPrinterBackend *cups = nullptr;          // created on the print thread
+    IppClient *ipp = nullptr;                    // created on the print thread
+};
+
+// Print-job queues, one worker thread per printer, so a sticker and a key
+// tag for the same car go out side by side on their own connections and a
+// slow or unreachable printer never holds up another. Jobs for one printer
+// stay in order. enqueue() returns immediately; results come back through
+// jobFinished().
+class PrintQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PrintQueue(QObject *parent = nullptr);
+    ~PrintQueue() override;
+
+    // Queue 'data' for 'printer' and return the job id.
+    quint64 enqueue(const QString &printer, const QByteArray &data, PrintTransport transport);
+
+    // Jobs queued, in flight or waiting in the spool for 'printer'.
+    int depth(const QString &printer) const;
+
+    // Keep undelivered jobs in an on-disk spool and retry them until the
+    // printer is back (see PrintWorker::enableSpool), instead of reporting
+    // them as failed. Also starts draining spools an earlier session left
+    // behind. The GUI turns this on; headless runs fail fast instead.
+    void enableSpool();
+
+    // CUPS queues go through the spooler; printers given by IP/hostname
+    // (or everything, when 'noSpooler' is set) use 'networkProtocol':
+    // "IPP" for IPP Print-Job, anything else for raw 9100.
+    static PrintTransport transportFor(const QString &printer, bool noSpooler,
+                                       const QString &networkProtocol);
+
+    // False for CUPS queues. Uses the kind recorded when the printer was
+    // picked (SettingsStore::printerKind, from discovery); a name never
+    // picked is a host if it is an IP address, has a ":port" or is dotted
+    // like a hostname. Never asks the spooler, so it is safe on the GUI
+    // thread.
+    static bool isNetworkPrinter(const QString &printer);
+
+    // Check and download the zpl/ formats 'printer' needs, and the logo
+    // converted for its 'dpi'. Runs on the print thread ahead of any label
+    // queued after this call.
+    void syncTemplates(const QString &printer, PrintTransport transport, const QStringList &formats, int dpi);
+
+    // Watch each printer from its own print thread (see PrintWorker::monitor).
+    void monitorPrinters(const QHash<QString, PrintTransport> &printers);
+
+    // Cached result of the last poll; 'known' is false before the first.
+    PrinterStatus status(const QString &printer) const;
+
+    static constexpr int StatusPollMs = 5000;
+    static constexpr int UnreachableRetrySecs = 30;
+
+signals:
+    void jobFinished(quint64 id, const QString &printer, bool ok, const QString &message);
+    void depthChanged(const QString &printer, int depth);
+    void jobStateChanged(quint64 id, const QString &printer, int spoolerJobId, const QString &state);
+    void templatesSynced(const QString &printer, bool ok, const QString &summary);
+    void printerStatusChanged(const QString &printer, const PrinterStatus &status);
+
+private slots:
+    void onWorkerFinished(quint64 id, const QString &printer, bool ok, const QString &message);
+    void onWorkerStatusChanged(const QString &printer, const PrinterStatus &status);
+    void onWorkerRecovered(const QString &printer, int count);
+
+private:
+    struct Lane
+    {
+        QThread *thread = nullptr;
+        PrintWorker *worker = nullptr;
+    };
+
+    // The worker for 'printer', started on first use.
+    PrintWorker *workerFor(const QString &printer);
+
+    QHash<QString, Lane> lanes;                  // printer -> its thread
+    QHash<QString, PrintTransport> monitored;
+    QHash<QString, int> depths;
+    QHash<QString, PrinterStatus> statuses;
+    bool spooling = false;
+    quint64 nextId = 1;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QLockFile>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include "PrintQueue.hpp"
+
+// Jobs for one printer that have not reached it yet, kept on disk so a
+// crash, a quit or a printer that drops off the Wi-Fi cannot lose them:
+//
+//   "OSSPOOL1" | printer record | job record | done record | ...
+//   record = magic, payload size, CRC-16, type | QDataStream payload
+//
+// Every append() and markDone() is flushed and fsync'd before it returns.
+// open() reads the file back and stops at the first torn or corrupt
+// record; jobs without a done record are pending(). Once every job is done
+// the file is cut back to its header.
+//
+// Used from the printer's print thread only. Like the journal, one process
+// owns a spool at a time (a lock file next to it).
+class PrintSpool
+{
+public:
+    // <GenericDataLocation>/WFWestHS/OilStickerApp/spool
+    static QString directory();
+
+    // Printers whose spool still holds unsent jobs (e.g. from a session
+    // that quit while the printer was offline).
+    static QStringList spooledPrinters();
+
+    explicit PrintSpool(const QString &printer);
+
+    bool open(QString *error);
+    bool isOpen() const { return file.isOpen(); }
+
+    // Unsent jobs in the order they were appended. Their ids belong to the
+    // session that queued them, so they come back with id 0.
+    QList<PrintJob> pending() const;
+
+    // Write 'job' and set its spoolSeq. False if it could not be made durable.
+    bool append(PrintJob *job, QString *error);
+
+    // The printer has these jobs (by spoolSeq).
+    void markDone(const QList<quint64> &seqs);
+
+private:
+    enum RecordType : quint16 { PrinterRecord = 1, JobRecord = 2, DoneRecord = 3 };
+
+    // Parse 'bytes'; returns the end of the last good record, or 0 when
+    // the header or printer record is missing.
+    static qint64 scan(const QByteArray &bytes, QString *printer, QMap<quint64, PrintJob> *jobs,
+                       quint64 *lastSeq);
+
+    bool writeRecord(RecordType type, const QByteArray &payload);
+    bool reset();
+
+    QString printer;
+    QFile file;
+    QLockFile lock;
+    QMap<quint64, PrintJob> unsent;   // spoolSeq -> job
+    quint64 nextSeq = 1;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+class QThread;
+class QTcpSocket;
+class QTimer;
+class QUdpSocket;
+
+// A printer found by discovery. 'name' is what gets saved as printerName:
+// a CUPS queue name or "host[:port]".
+struct DiscoveredPrinter
+{
+    QString name;
+    QString source;     // "cups", "dns-sd" or "scan"
+    QString model;      // e.g. "ZD420-300dpi", empty if unknown
+    int dpi = 0;        // 0 if unknown
+
+    // "ZD420 (192.168.1.40, 300 dpi)" for the picker.
+    QString displayText() const;
+};
+
+Q_DECLARE_METATYPE(DiscoveredPrinter)
+
+// Runs on the discovery thread. One scan = CUPS queues, a DNS-SD browse for
+// _pdl-datastream._tcp, then a non-blocking connect sweep of TCP 9100 over
+// the local /24 (plus any DNS-SD hosts), asking each printer for ~HI.
+class DiscoveryWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DiscoveryWorker(QObject *parent = nullptr);
+
+    // Called on the discovery thread. Extra hosts (e.g. the saved printer
+    // addresses) are probed even when outside the local /24.
+    void scan(const QStringList &extraHosts);
+
+    static constexpr int BrowseMs = 1500;
+    static constexpr int ConnectTimeoutMs = 600;
+    static constexpr int MaxParallelProbes = 64;
+
+signals:
+    void finished(const QList<DiscoveredPrinter> &printers);
+
+private:
+    void addResult(const DiscoveredPrinter &printer);
+    void listCupsQueues();
+    void startBrowse();
+    void readBrowseReplies();
+    void finishBrowse();
+    void startProbe(const QString &host);
+    void probeNext();
+    void probeDone(QTcpSocket *socket, const QByteArray &reply);
+    void finishScan();
+
+    // DNS-SD wire format (RFC 1035 / 6763).
+    static QByteArray browseQuery(const QByteArray &service);
+    static bool readName(const QByteArray &msg, int *pos, QByteArray *name);
+    void parseBrowseReply(const QByteArray &msg);
+
+    // "ZD420-300dpi,V84.20.18Z,12,8176KB" -> model / dpi
+    static void parseHostIdentification(const QByteArray &reply, DiscoveredPrinter *printer);
+
+    bool scanning = false;
+    QList<DiscoveredPrinter> results;
+    QHash<QString, int> indexByName;
+
+    // DNS-SD browse state
+    QUdpSocket *mdns = nullptr;
+    QHash<QByteArray, QByteArray> srvTarget;    // instance -> host name
+    QHash<QByteArray, quint16> srvPort;         // instance -> port
+    QHash<QByteArray, QString> txtModel;        // instance -> "ty" record
+    QHash<QByteArray, QHostAddress> addresses;  // host name -> IPv4
+
+    // Sweep state
+    QStringList probeQueue;
+    QHash<QTcpSocket *, QByteArray> probing;    // socket -> ~HI reply so far
+    QStringList extraHosts;
+};
+
+// Owns the discovery thread and the cached results (kept in settings so the
+// picker has something to show before the first scan of the session ends).
+class PrinterDiscovery : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PrinterDiscovery(QObject *parent = nullptr);
+    ~PrinterDiscovery() override;
+
+    // Start a background scan unless one is already running.
+    void refresh(const QStringList &extraHosts = QStringList());
+
+    bool isScanning() const { return scanning; }
+    QList<DiscoveredPrinter> printers() const { return cache; }
+    QDateTime lastScan() const { return cacheTime; }
+
+    // True when the last scan found at least one CUPS queue.
+    bool hasSpoolerQueues() const;
+
+signals:
+    void printersChanged();
+
+private slots:
+    void onScanFinished(const QList<DiscoveredPrinter> &printers);
+
+private:
+    void loadCache();
+    void saveCache() const;
+
+    QThread *thread;
+    DiscoveryWorker *worker;
+    bool scanning = false;
+    QList<DiscoveredPrinter> cache;
+    QDateTime cacheTime;
+};
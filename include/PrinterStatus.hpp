@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+// Last known condition of one printer, as reported by ~HS / ~HQES (network
+// printers) or by CUPS (spooler queues).
+struct PrinterStatus
+{
+    bool known = false;          // false until the first successful poll
+    bool reachable = false;
+    QString error;               // why the last poll failed
+
+    bool paperOut = false;
+    bool paused = false;
+    bool headOpen = false;
+    bool ribbonOut = false;
+    bool overTemp = false;
+    bool underTemp = false;
+    bool bufferFull = false;
+    bool cutterFault = false;
+    int formatsInBuffer = 0;     // formats received but not yet printed
+    int labelsRemaining = 0;     // labels left in the current batch
+
+    QStringList spoolerReasons;  // CUPS printer-state-reasons (spooler queues)
+    QDateTime updated;
+
+    // A definite fault: jobs sent now would not print. Unknown or
+    // unreachable is not a fault (the send reports that itself).
+    bool isFaulted() const;
+
+    // Short text for the status indicator, e.g. "Ready", "Paused, Paper out".
+    QString summary() const;
+
+    // ~HS reply: three STX...ETX strings of comma-separated flags.
+    static bool parseHostStatus(const QByteArray &reply, PrinterStatus *status);
+
+    // ~HQES reply: ERRORS / WARNINGS lines with hex bit masks.
+    static void parseExtendedStatus(const QByteArray &reply, PrinterStatus *status);
+
+    bool operator==(const PrinterStatus &other) const;
+    bool operator!=(const PrinterStatus &other) const { return !(*this == other); }
+};
+
+Q_DECLARE_METATYPE(PrinterStatus)
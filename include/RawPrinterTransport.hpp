@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QByteArray>
+
+class QTcpSocket;
+
+// Raw ZPL transport over TCP (Zebra "raw" port 9100).
+// Keeps one open socket per printer so back-to-back labels skip the
+// connection setup, and reconnects when the printer drops the socket.
+class RawPrinterTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DefaultPort = 9100;
+
+    explicit RawPrinterTransport(QObject *parent = nullptr);
+    ~RawPrinterTransport() override;
+
+    // Write 'data' to 'printer' ("host" or "host:port").
+    // Returns false and fills 'error' if the bytes could not be delivered;
+    // 'written' then tells how much of 'data' went out before the failure
+    // (0 means the printer cannot have printed any of it).
+    bool send(const QString &printer, const QByteArray &data, QString *error = nullptr,
+              qint64 *written = nullptr);
+
+    // Send a host query (^HW, ^HF, ~HS, ...) and collect the reply until it
+    // contains 'terminatorCount' copies of 'terminator' (~HS answers with
+    // three STX...ETX strings) or the printer goes quiet for 'idleTimeoutMs'.
+    // Returns false if nothing came back.
+    bool query(const QString &printer, const QByteArray &request, const QByteArray &terminator,
+               QByteArray *reply, QString *error = nullptr, int idleTimeoutMs = 1500,
+               int terminatorCount = 1);
+
+    // Close every open printer connection.
+    void disconnectAll();
+
+    // True when 'printer' can only be a network address: an IP address or
+    // anything with a ":port". Bare names may be either a hostname or a
+    // CUPS queue (see PrintQueue::isNetworkPrinter).
+    static bool isNetworkAddress(const QString &printer);
+
+private:
+    // Return a connected socket for 'printer', reusing the open one if the
+    // printer has not closed it. 'reused' tells the caller which case it got.
+    QTcpSocket *socketFor(const QString &printer, bool *reused, QString *error);
+    void dropSocket(const QString &printer);
+
+    static void splitHostPort(const QString &printer, QString *host, quint16 *port);
+
+    QHash<QString, QTcpSocket *> sockets;
+    int connectTimeoutMs = 3000;
+    int writeTimeoutMs = 5000;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPoint>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVariant>
+
+class QThread;
+class QTimer;
+
+// The app's QSettings ("WFWestHS" / "OilStickerApp"), read once into memory.
+// Reads never touch the registry or plist; writes update memory at once and
+// reach QSettings on a background thread, batched WriteDelayMs after the
+// first change. Safe to use from any thread.
+//
+// Created on first use, which must be on the main thread (the GUI and
+// HeadlessRunner constructors); destroyed with the QCoreApplication, after
+// the last pending write.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int WriteDelayMs = 250;
+
+    static SettingsStore &instance();
+    ~SettingsStore() override;
+
+    // Printers and printing
+    QString printerName() const;
+    void setPrinterName(const QString &printer);
+    QString keytagPrinterName() const;
+    void setKeytagPrinterName(const QString &printer);
+    QString printerKind(const QString &printer) const;  // "queue", "network", empty if not recorded
+    void setPrinterKind(const QString &printer, const QString &kind);
+    bool useIppPrinting() const;
+    QString networkProtocol() const;          // "RAW" or "IPP", upper case
+    void setNetworkProtocol(const QString &protocol);
+    bool inlineFormats() const;
+    void setInlineFormats(bool on);
+    bool syncFormats() const;
+    bool vehicleTicket() const;               // sticker + key tag from one form
+    void setVehicleTicket(bool on);
+
+    // Label
+    int defaultMiles() const;
+    void setDefaultMiles(int miles);
+    QString labelStyle() const;               // "DEFAULT" or "KEYTAG" as stored
+    void setLabelStyle(const QString &style);
+    QString templateName(const QString &fallback) const;
+    void setTemplateName(const QString &name);
+    QString background(const QString &style) const;   // per style, else the built-in PNG
+    void setBackground(const QString &style, const QString &path);
+    QString backgroundFolder() const;
+    void setBackgroundFolder(const QString &folder);
+    QString logoGraphic() const;              // PNG stored on the printers as LOGO.GRF
+    void setLogoGraphic(const QString &path);
+    QPoint logoPosition(const QString &style) const;  // ^FO of the logo in dots; (-1,-1) = not on this style
+    void setLogoPosition(const QString &style, const QPoint &dots);  // negative = remove
+
+    // Anything else (e.g. "discovery/...", "templateSync/...").
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    void setValue(const QString &key, const QVariant &value);
+
+    // Forget every setting (Reset All Settings).
+    void clear();
+
+signals:
+    // After setValue() / clear() ('key' is empty for clear()). Emitted on
+    // the thread that made the change.
+    void changed(const QString &key);
+
+private:
+    explicit SettingsStore(QObject *parent);
+
+    void scheduleWrite();
+    void writePending();
+
+    mutable QReadWriteLock lock;
+    QHash<QString, QVariant> values;
+    QHash<QString, QVariant> pending;    // key -> new value; invalid = removed
+    bool clearPending = false;
+
+    QTimer *writeTimer;
+    QThread *thread;
+    QObject *writer;                     // lives on 'thread'
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+class QWidget;
+
+// Time from main() to the first interactive frame, by phase, so cold starts
+// on the counter PCs can be tracked:
+//
+//   StartupTimer::start();                   // top of main()
+//   StartupTimer::mark("journal");           // end of each phase
+//   StartupTimer::finishWhenInteractive(w);  // after show()
+//
+// The window counts as interactive once its first frame is painted and the
+// event loop is idle again. The phases are then logged and appended as one
+// line to startup.log next to the print journal:
+//
+//   <ISO time> \t <total ms> \t <phase>=<ms> \t ...
+class StartupTimer
+{
+public:
+    static constexpr qint64 MaxLogBytes = 256 * 1024;   // then startup.log.old
+
+    static void start();
+    static void mark(const QString &phase);
+    static void finishWhenInteractive(QWidget *window);
+
+    // Phase name and its own duration in ms, in order.
+    static QList<QPair<QString, qint64>> phases();
+
+    static QString logPath();
+
+private:
+    StartupTimer() = delete;
+    static void finish();
+};
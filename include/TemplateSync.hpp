@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class RawPrinterTransport;
+class ZplGraphic;
+
+// Keeps the formats from zpl/ stored on each printer so every label can be
+// a small ^XF recall job.
+//
+// Network printers are asked what they hold: ^HW lists the stored formats
+// and ^HF uploads each one, which is hashed and compared with the local
+// source. ^DF is sent only for formats that are missing or changed.
+// CUPS queues cannot answer queries, so for them the hash of the last
+// download is remembered and the format is re-sent only when it changes.
+//
+// The label logo (Settings > Select Label Logo) is kept the same way: the
+// PNG is converted to a ZplGraphic and stored once as E:LOGO.GRF with ~DG,
+// then each label job places it with ^XG (logoPlacement()) instead of
+// carrying the image.
+//
+// Runs on the print thread, in order with the label jobs.
+class TemplateSync
+{
+public:
+    enum Outcome { UpToDate, Downloaded, Failed };
+
+    struct Result
+    {
+        QString format;   // e.g. "DEFAULT.ZPL"
+        Outcome outcome = Failed;
+        QString message;
+    };
+
+    // Formats are downloaded to flash so they survive a power cycle; ^XF
+    // without a drive letter searches R: then E:.
+    static constexpr char Drive = 'E';
+    static constexpr const char *LogoName = "LOGO.GRF";
+
+    explicit TemplateSync(RawPrinterTransport *transport);
+
+    // Query 'printer' over raw 9100 and download what is missing or changed.
+    QList<Result> syncNetworkPrinter(const QString &printer, const QStringList &formats);
+
+    // Spooler queues: the ^DF jobs still needed for 'printer' (by recorded
+    // hash). Call markDownloaded() once a job has been accepted.
+    static QHash<QString, QByteArray> pendingDownloads(const QString &printer, const QStringList &formats);
+    static void markDownloaded(const QString &printer, const QString &format);
+
+    // Network printers: store the logo, converted for 'dpi' (0 = 203),
+    // unless the printer lists LOGO.GRF and the recorded hash matches. No
+    // result when no logo is set.
+    QList<Result> syncNetworkLogo(const QString &printer, int dpi);
+
+    // Spooler queues: the ~DG job for the logo at 'dpi' if 'printer' does
+    // not have this one yet (by recorded hash), else empty. Pass 'hash' to
+    // markLogoDownloaded() once the job has been accepted.
+    static QByteArray pendingLogo(const QString &printer, int dpi, QByteArray *hash, QString *error);
+    static void markLogoDownloaded(const QString &printer, const QByteArray &hash);
+
+    // The PNG at 'path' as a graphic fitted to a 2" label at 'dpi'
+    // (0 = 203; null if it cannot be read).
+    static ZplGraphic logoGraphic(const QString &path, int dpi);
+
+    // ^FO<x>,<y>^XGE:LOGO.GRF,1,1^FS at the logo position set for 'style'
+    // labels, or empty when no logo is set or that style has no position
+    // (placement is opt-in per style). Goes in LabelJob::logo.
+    static QByteArray logoPlacement(const QString &style);
+
+    // ^XA^DF<drive>:<name>^FS ... ^XZ for a format source as stored in zpl/.
+    static QByteArray downloadCommand(const QString &name, const QByteArray &source);
+
+    // SHA-1 over the format body with line breaks, comments and the
+    // ^XA / ^DF / ^XZ wrapper removed, so the local file and the copy the
+    // printer uploads compare equal.
+    static QByteArray contentHash(const QByteArray &format);
+
+    // Format names (upper case) in a ^HW directory listing.
+    static QStringList parseDirectory(const QByteArray &listing);
+
+private:
+    static QByteArray logoCommand(const QString &path, int dpi, QString *error);
+    static QByteArray logoHash(const QByteArray &command, int dpi);
+    static QString settingsKey(const QString &printer, const QString &format);
+
+    RawPrinterTransport *transport;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "LabelJob.hpp"
+
+class QTimer;
+class PrintJournal;
+
+// What we remember about one vehicle from its past labels.
+struct VehicleRecord
+{
+    QString customer;
+    QString car;
+    QString plate;
+    QString vin;
+    QString color;
+    QStringList repairOrders;   // every RO seen, oldest first
+    QString oilType;            // from the last DEFAULT sticker printed for it
+    QString interval;
+    QDateTime lastSeen;
+};
+
+// Local index of vehicles from past key tag and sticker jobs, searchable by
+// plate, VIN and repair order prefix. Each key kind is a sorted array of
+// normalized keys, so a search is a binary search plus a short scan.
+//
+// Saved to its own file (QDataStream) a moment after each change; the first
+// run seeds it from the print journal. A sticker is credited to the vehicle
+// of the key tag printed (or recalled) before it.
+class VehicleIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Key { Plate, Vin, RepairOrder, KeyCount };
+
+    static constexpr int SaveDelayMs = 2000;
+
+    explicit VehicleIndex(QObject *parent = nullptr);
+    ~VehicleIndex() override;
+
+    // <GenericDataLocation>/WFWestHS/OilStickerApp/vehicles.dat
+    static QString defaultPath();
+
+    // Read 'path'; when it does not exist yet, seed from 'journal'. Does
+    // not touch the save timer, so it may run on a worker thread as long as
+    // nothing else uses the index until it returns.
+    bool load(const QString &path, const PrintJournal *journal, QString *error);
+
+    // Record a printed key tag. Returns the vehicle's record number.
+    int addKeyTag(const LabelJob &job, const QDateTime &when = QDateTime::currentDateTime());
+
+    // Remember the oil type and interval of a sticker printed for 'record'.
+    void addSticker(int record, const LabelJob &job,
+                    const QDateTime &when = QDateTime::currentDateTime());
+
+    // Records whose 'key' starts with 'prefix', at most 'max', in key order.
+    QList<int> search(Key key, const QString &prefix, int max) const;
+
+    int count() const { return int(records.size()); }
+    const VehicleRecord &record(int index) const { return records.at(index); }
+
+    // Upper case without spaces or dashes: "abc-123" -> "ABC123".
+    static QString normalize(const QString &text);
+
+private:
+    struct KeyEntry
+    {
+        QString key;
+        int record;
+    };
+
+    // Fold a job into 'records' (and byVin / byPlate) without the sorted
+    // keys or a save; addKeyTag() and addSticker() add those.
+    int mergeKeyTag(const LabelJob &job, const QDateTime &when);
+    bool mergeSticker(int record, const LabelJob &job, const QDateTime &when);
+    void insertKey(Key key, const QString &text, int record);
+    void rebuildKeys();
+    void scheduleSave();
+    bool save(QString *error) const;
+
+    QList<VehicleRecord> records;
+    QList<KeyEntry> keys[KeyCount];      // sorted by key, then record
+    QHash<QString, int> byVin;           // normalized VIN -> record
+    QHash<QString, int> byPlate;         // normalized plate -> record (no VIN known)
+    QString filePath;
+    QTimer *saveTimer;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+// A 1-bit printer graphic made from any image, ready to go to the printer:
+//
+//   fieldCommand()     ^GFA,...       (inline in one label)
+//   downloadCommand()  ~DGE:LOGO.GRF  (stored on the printer once)
+//   recallCommand()    ^FO^XG^FS      (placed on a label from storage)
+//
+// The data is Z64 (zlib deflate, base64 and a CRC-16 of the base64 text)
+// or, when that comes out no shorter, ZPL's compressed ASCII hex: G-Y/g-z
+// repeat counts, ',' / '!' to fill a row with 0 / F and ':' to repeat the
+// previous row. ZplRasterizer::decodeGraphicField() reads both back.
+class ZplGraphic
+{
+public:
+    enum Encoding { Auto, Z64, CompressedHex };
+
+    ZplGraphic() = default;
+
+    // Scale 'image' to printer dots (by its pHYs resolution, if it has one,
+    // else one pixel per dot), fit it in maxWidth x maxHeight dots (0 = no
+    // limit), composite transparency over white paper and Floyd-Steinberg
+    // dither to 1 bpp. Pure black-and-white art comes through unchanged.
+    static ZplGraphic fromImage(const QImage &image, int dpi, int maxWidth = 0, int maxHeight = 0);
+
+    bool isNull() const { return bits.isEmpty(); }
+    int width() const { return rowBytes * 8; }
+    int height() const { return rows; }
+    int bytesPerRow() const { return rowBytes; }
+    int totalBytes() const { return int(bits.size()); }
+
+    // Packed rows, MSB first, 1 = black.
+    const QByteArray &data() const { return bits; }
+
+    // The data field of ^GF / ~DG. Auto picks the shorter encoding.
+    QByteArray encoded(Encoding encoding = Auto) const;
+
+    // ^GFA,<total>,<total>,<row bytes>,<data>
+    QByteArray fieldCommand(Encoding encoding = Auto) const;
+
+    // ~DG<drive>:<name>,<total>,<row bytes>,<data> ('name' like "LOGO.GRF").
+    QByteArray downloadCommand(char drive, const QString &name, Encoding encoding = Auto) const;
+
+    // ^FO<x>,<y>^XG<drive>:<name>,1,1^FS
+    static QByteArray recallCommand(char drive, const QString &name, int x, int y);
+
+    // CRC-16/CCITT (XMODEM) as ZPL uses for :Z64: / :B64: data.
+    static quint16 crc16(const QByteArray &data);
+
+    // The ASCII hex size of the same graphic, for comparison.
+    int uncompressedHexSize() const { return totalBytes() * 2; }
+
+private:
+    QByteArray encodeZ64() const;
+    QByteArray encodeCompressedHex() const;
+
+    QByteArray bits;
+    int rowBytes = 0;
+    int rows = 0;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <functional>
+
+class QObject;
+class QPainter;
+
+// Local interpreter for the ZPL subset our formats use:
+//   ^FO ^A0 ^GB ^GF ^FR ^FD ^FN ^FS ^FH ^FX, plus ^XF / ^PQ in recall jobs
+//   and ^PW / ^LL / ^LH for the label size.
+//
+// A format is parsed once; everything that does not depend on ^FN data is
+// painted into a cached static layer, so render() only draws the variable
+// fields. Output is a 1-bit image in printer dots.
+class ZplRasterizer
+{
+public:
+    static constexpr int DefaultDpi = 203;
+    static constexpr qreal DefaultLabelInches = 2.0;   // 2" x 2" stock
+
+    explicit ZplRasterizer(int dpi = DefaultDpi);
+
+    // Parse a format as stored in zpl/ (or a whole ^XA...^XZ job).
+    void setFormat(const QString &name, const QByteArray &format);
+
+    // Load 'name' from ZplTemplateLibrary. False if there is no local source.
+    bool loadFormat(const QString &name);
+
+    bool isValid() const { return !elements.isEmpty(); }
+    QString formatName() const { return name; }
+    int dpi() const { return dotsPerInch; }
+
+    // Label size in dots (^PW / ^LL, else 2" x 2" at this dpi).
+    QSize labelSize() const { return size; }
+
+    // ^FN numbers the format fills in, ascending.
+    QList<int> fieldNumbers() const;
+
+    // Area a ^FN field can paint into, in dots (for partial repaints).
+    QRect fieldBounds(int fieldNumber) const;
+
+    // Static layer + 'fields' (by ^FN number), black = printed. Format_Mono
+    // unless 'format' asks for Format_RGB32 (for repaintFields()).
+    QImage render(const QHash<int, QString> &fields, QImage::Format format = QImage::Format_Mono) const;
+
+    // Redraw the 'changed' fields of an RGB32 render() in place. Returns the
+    // dots touched (empty if nothing was redrawn).
+    QRect repaintFields(QImage &image, const QHash<int, QString> &fields, const QList<int> &changed) const;
+
+    // Rasterize a recall job (^XA ^XF<name> ^FNn^FD...^FS ^PQn ^XZ) or an
+    // inline job. 'quantity' receives the ^PQ count (1 if absent).
+    static QImage renderJob(const QByteArray &zpl, int dpi = DefaultDpi, int *quantity = nullptr);
+
+    // Family of the embedded Zebra font 0 (tt0003m_.ttf), loaded once.
+    // Waits for a registration loadFont0Async() already started.
+    static QString font0Family();
+
+    // Register font 0 on a pool thread, off the startup path, then call
+    // 'ready' on the GUI thread unless 'context' is gone by then.
+    static void loadFont0Async(QObject *context, std::function<void()> ready);
+    static bool isFont0Loaded();
+
+private:
+    struct Element
+    {
+        enum Kind { Text, Box, Graphic };
+        Kind kind = Text;
+        QPoint origin;            // ^FO (+ ^LH), dots
+        char orientation = 'N';   // ^A0 N/R/I/B
+        int fontHeight = 9;
+        int fontWidth = 0;        // 0 = proportional to height
+        bool reverse = false;     // ^FR
+        QString text;             // ^FD (static text)
+        int fieldNumber = 0;      // ^FN (variable text)
+        QSize box;                // ^GB width, height
+        int thickness = 1;
+        bool white = false;       // ^GB color W
+        int rounding = 0;         // ^GB 0-8
+        QImage graphic;           // ^GF, Format_Mono, paper transparent
+    };
+
+    void parse(const QByteArray &format);
+    void buildStaticLayer();
+    void paintElement(QPainter &painter, const Element &e, const QString &text) const;
+
+    static QString decodeFieldHex(const QString &data, QChar indicator);
+
+    // ^GFA (hex with ZPL run-length compression, or :B64: / :Z64:).
+    static QImage decodeGraphicField(const QString &params);
+    static QByteArray decodeCompressedHex(const QString &data, int rowBytes);
+
+    QString name;
+    int dotsPerInch;
+    QSize size;
+    QList<Element> elements;
+    QImage staticLayer;           // RGB32, white paper
+};
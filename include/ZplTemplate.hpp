@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringView>
+
+// A ZPL format compiled once into static byte runs and ^FN slots, so a job
+// renders in a single append pass into a caller-owned buffer.
+//
+// Two modes:
+//   Recall - ^XA ^XF<name> ^FNn^FD<data>^FS ... ^XZ (format stored on the printer)
+//   Inline - the whole format with each ^FNn replaced by ^FD<data>
+//
+// Either way a job can add its own commands (e.g. the logo's ^XG) just
+// before the closing ^XZ.
+class ZplTemplate
+{
+public:
+    enum Mode { Recall, Inline };
+
+    ZplTemplate() = default;
+
+    // Inline mode: compile the format source (as stored in zpl/).
+    static ZplTemplate compileInline(const QString &name, const QByteArray &format);
+
+    // Recall mode: only the field numbers are needed.
+    static ZplTemplate compileRecall(const QString &name, const QList<int> &fieldNumbers);
+
+    // ^FN numbers used by a format source, ascending.
+    static QList<int> scanFieldNumbers(const QByteArray &format);
+
+    bool isValid() const { return !segments.isEmpty(); }
+    QString name() const { return templateName; }
+    QList<int> fieldNumbers() const { return fields; }
+
+    // Append one job to 'out'. fields[n] is the data for ^FNn; missing or
+    // empty entries render as empty fields. quantity > 0 emits ^PQ, and
+    // 'overlay' (whole ZPL fields) is placed on its own line before ^XZ.
+    void render(QByteArray &out, const QStringView *fieldData, int fieldCount, int quantity = 0,
+                const QByteArray &overlay = QByteArray()) const;
+
+    // Field data as ^FD (or ^FH^FD with _XX escapes when the data contains
+    // ^, ~ or _ so it cannot break out of the field).
+    static void appendFieldData(QByteArray &out, QStringView value);
+
+private:
+    enum Slot { Static = 0, Quantity = -1, Overlay = -2 }; // > 0: ^FN number
+
+    struct Segment
+    {
+        QByteArray text;   // static bytes written before the slot
+        int slot = Static;
+    };
+
+    QString templateName;
+    QList<Segment> segments;
+    QList<int> fields;
+    int sizeHint = 0;      // static bytes per job, for reserve()
+};
+
+// Formats from zpl/ (embedded as :/resources/zpl/, or next to the app),
+// parsed and compiled once per (name, mode).
+class ZplTemplateLibrary
+{
+public:
+    static ZplTemplateLibrary &instance();
+
+    // Compiled template for 'name' (e.g. "DEFAULT.ZPL"). Names without a
+    // local source still compile in Recall mode using 'fallbackFields'.
+    ZplTemplate get(const QString &name, ZplTemplate::Mode mode, const QList<int> &fallbackFields);
+
+    // Raw format source, or empty if 'name' is not one of the local formats.
+    QByteArray source(const QString &name);
+
+private:
+    ZplTemplateLibrary() = default;
+    QByteArray sourceLocked(const QString &name);
+
+    QMutex mutex;
+    QHash<QString, QByteArray> sources;      // name -> file contents (empty = not found)
+    QHash<QString, ZplTemplate> compiled;    // "mode:name" -> template
+};
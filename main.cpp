@@ -1,10 +1,48 @@
 #include <QApplication>
+#include <QCoreApplication>
 #include "OilLabelGUI.hpp"
+#include "HeadlessRunner.hpp"
+#include "PreviewBenchmark.hpp"
+#include "MockPrinter.hpp"
+#include "LoadGenerator.hpp"
+#include "StartupTimer.hpp"
 
 int main(int argc, char *argv[]) {
+    // Headless printing: no widgets, fonts or images are loaded.
+    if (HeadlessRunner::isHeadless(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        HeadlessRunner runner;
+        return runner.run(app.arguments());
+    }
+
+    // Mock printer and load tests: network only, no widgets.
+    if (MockPrinter::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return MockPrinter::run(app.arguments());
+    }
+    if (LoadGenerator::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        LoadGenerator generator;
+        return generator.run(app.arguments());
+    }
+
+    // Widget benchmarks and golden images: offscreen unless told otherwise,
+    // so they run on build machines and render the same everywhere.
+    if (PreviewBenchmark::isRequested(argc, argv)) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication app(argc, argv);
+        PreviewBenchmark bench;
+        return bench.run(app.arguments());
+    }
+
+    // Cold start, by phase, to the first frame the user can type into.
+    StartupTimer::start();
     QApplication app(argc, argv);
+    StartupTimer::mark("application");
     OilLabelGUI window;
     window.show();
+    StartupTimer::mark("show");
+    StartupTimer::finishWhenInteractive(&window);
     return app.exec();
 }
-
@@ -0,0 +1,117 @@
+// src/BackgroundImageLoader.cpp
+#include "BackgroundImageLoader.hpp"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <utility>
+
+namespace {
+
+struct CacheEntry
+{
+    QString path;         // as requested
+    QString source;       // file actually decoded
+    QDateTime modified;   // of 'source' (invalid for resources)
+    QImage image;
+};
+
+struct ImageCache
+{
+    QMutex mutex;
+    QList<CacheEntry> entries;   // most recently used first
+};
+
+ImageCache &imageCache()
+{
+    static ImageCache cache;
+    return cache;
+}
+
+// Same order the preview has always searched.
+QStringList candidates(const QString &path)
+{
+    QStringList list;
+    if (!path.isEmpty())
+        list << path;
+    const QString baseName = QFileInfo(path).fileName();
+    if (!baseName.isEmpty())
+        list << QDir(QCoreApplication::applicationDirPath()).filePath("resources/" + baseName);
+    list << ":/resources/default.png";
+    return list;
+}
+
+} // namespace
+
+BackgroundImageLoader::BackgroundImageLoader(QObject *parent)
+    : QObject(parent)
+{
+    pool.setMaxThreadCount(1);
+}
+
+BackgroundImageLoader::~BackgroundImageLoader()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+QImage BackgroundImageLoader::cached(const QString &path)
+{
+    ImageCache &cache = imageCache();
+    QMutexLocker lock(&cache.mutex);
+    for (int i = 0; i < cache.entries.size(); ++i) {
+        if (cache.entries.at(i).path == path) {
+            cache.entries.move(i, 0);
+            return cache.entries.first().image;
+        }
+    }
+    return QImage();
+}
+
+void BackgroundImageLoader::request(const QString &path)
+{
+    pool.start([this, path]() {
+        ImageCache &cache = imageCache();
+        QImage image;
+
+        for (const QString &source : candidates(path)) {
+            if (!QFile::exists(source))
+                continue;
+            const QDateTime modified = QFileInfo(source).lastModified();
+
+            {
+                QMutexLocker lock(&cache.mutex);
+                for (const CacheEntry &e : std::as_const(cache.entries)) {
+                    if (e.path == path && e.source == source && e.modified == modified) {
+                        image = e.image;
+                        break;
+                    }
+                }
+            }
+            if (!image.isNull())
+                break;
+
+            image.load(source);
+            if (image.isNull())
+                continue;
+            image.convertTo(QImage::Format_ARGB32_Premultiplied);
+
+            QMutexLocker lock(&cache.mutex);
+            cache.entries.removeIf([&path](const CacheEntry &e) { return e.path == path; });
+            cache.entries.prepend({ path, source, modified, image });
+            while (cache.entries.size() > CacheSize)
+                cache.entries.removeLast();
+            break;
+        }
+
+        QMetaObject::invokeMethod(this, [this, path, image]() {
+            emit loaded(path, image);
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,288 @@
+// src/BatchPrintDialog.cpp
+#include "BatchPrintDialog.hpp"
+#include "LabelJob.hpp"
+#include "PrintQueue.hpp"
+#include "TemplateSync.hpp"
+
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGuiApplication>
+#include <QClipboard>
+#include <QBrush>
+#include <algorithm>
+
+BatchPrintDialog::BatchPrintDialog(PrintQueue *queue, SubmitFn submit, QWidget *parent)
+    : QDialog(parent),
+      queue(queue),
+      submit(std::move(submit))
+{
+    setWindowTitle("Batch Print");
+    resize(1000, 500);
+
+    table = new QTableWidget(0, ColumnCount, this);
+    table->setHorizontalHeaderLabels({
+        "Print", "Style", "Mileage", "Next Service", "Oil Brand/Grade",
+        "Customer", "Car", "Plate", "VIN", "Color", "Repair Order", "Qty", "Status"
+    });
+    table->horizontalHeader()->setSectionResizeMode(ColStatus, QHeaderView::Stretch);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    QLabel *hint = new QLabel(
+        "Paste rows from a spreadsheet (tab or comma separated) in column order:\n"
+        "Style, Mileage, Next Service, Oil, Customer, Car, Plate, VIN, Color, Repair Order, Qty");
+
+    summaryLabel = new QLabel();
+
+    QPushButton *addBtn = new QPushButton("Add Row");
+    QPushButton *removeBtn = new QPushButton("Remove");
+    QPushButton *pasteBtn = new QPushButton("Paste");
+    QPushButton *checkAllBtn = new QPushButton("Check All");
+    QPushButton *printBtn = new QPushButton("Print Checked");
+    QPushButton *closeBtn = new QPushButton("Close");
+
+    connect(addBtn, &QPushButton::clicked, this, &BatchPrintDialog::addRow);
+    connect(removeBtn, &QPushButton::clicked, this, &BatchPrintDialog::removeSelectedRows);
+    connect(pasteBtn, &QPushButton::clicked, this, &BatchPrintDialog::pasteRows);
+    connect(checkAllBtn, &QPushButton::clicked, this, &BatchPrintDialog::checkAll);
+    connect(printBtn, &QPushButton::clicked, this, &BatchPrintDialog::printChecked);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+
+    QHBoxLayout *buttonRow = new QHBoxLayout();
+    buttonRow->addWidget(addBtn);
+    buttonRow->addWidget(removeBtn);
+    buttonRow->addWidget(pasteBtn);
+    buttonRow->addWidget(checkAllBtn);
+    buttonRow->addStretch();
+    buttonRow->addWidget(printBtn);
+    buttonRow->addWidget(closeBtn);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(hint);
+    layout->addWidget(table);
+    layout->addWidget(summaryLabel);
+    layout->addLayout(buttonRow);
+
+    connect(queue, &PrintQueue::jobFinished, this, &BatchPrintDialog::onJobFinished);
+
+    addRow();
+}
+
+void BatchPrintDialog::setPrinters(const QString &defaultPrinterName, const QString &keytagPrinterName)
+{
+    defaultPrinter = defaultPrinterName;
+    keytagPrinter = keytagPrinterName;
+}
+
+void BatchPrintDialog::setDefaultMiles(int miles)
+{
+    defaultMiles = miles;
+}
+
+void BatchPrintDialog::setFormatMode(ZplTemplate::Mode mode)
+{
+    formatMode = mode;
+}
+
+//
+// Row editing
+//
+void BatchPrintDialog::addRow()
+{
+    insertRow({ "DEFAULT", QString(), QString::number(defaultMiles) });
+}
+
+void BatchPrintDialog::removeSelectedRows()
+{
+    QList<int> rows;
+    for (const QModelIndex &index : table->selectionModel()->selectedRows())
+        rows << index.row();
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    for (int row : rows)
+        table->removeRow(row);
+}
+
+void BatchPrintDialog::pasteRows()
+{
+    const QString text = QGuiApplication::clipboard()->text();
+    int added = 0;
+
+    for (const QString &line : text.split('\n', Qt::SkipEmptyParts)) {
+        QString trimmed = line.trimmed();
+        if (trimmed.isEmpty())
+            continue;
+
+        QStringList cells = trimmed.contains('\t') ? line.split('\t') : line.split(',');
+        for (QString &c : cells)
+            c = c.trimmed();
+
+        // Skip a spreadsheet header row.
+        if (cells.first().compare("Style", Qt::CaseInsensitive) == 0)
+            continue;
+
+        insertRow(cells);
+        ++added;
+    }
+
+    summaryLabel->setText(QString("Pasted %1 row(s).").arg(added));
+}
+
+void BatchPrintDialog::checkAll()
+{
+    for (int row = 0; row < table->rowCount(); ++row)
+        table->item(row, ColPrint)->setCheckState(Qt::Checked);
+}
+
+void BatchPrintDialog::insertRow(const QStringList &values)
+{
+    int row = table->rowCount();
+    table->insertRow(row);
+
+    QTableWidgetItem *check = new QTableWidgetItem();
+    check->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    check->setCheckState(Qt::Checked);
+    check->setData(Qt::UserRole, nextRowKey++);
+    table->setItem(row, ColPrint, check);
+
+    // values[0] is the style column, values[n] maps to column n + 1
+    for (int col = ColStyle; col < ColStatus; ++col) {
+        int i = col - ColStyle;
+        QString value = i < values.size() ? values.at(i) : QString();
+        if (col == ColStyle) {
+            value = value.toUpper();
+            if (value == "KEY TAG") value = "KEYTAG";
+            if (value != "KEYTAG") value = "DEFAULT";
+        }
+        table->setItem(row, col, new QTableWidgetItem(value));
+    }
+
+    QTableWidgetItem *status = new QTableWidgetItem();
+    status->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    table->setItem(row, ColStatus, status);
+}
+
+int BatchPrintDialog::rowForKey(int key) const
+{
+    for (int row = 0; row < table->rowCount(); ++row) {
+        if (table->item(row, ColPrint)->data(Qt::UserRole).toInt() == key)
+            return row;
+    }
+    return -1;
+}
+
+LabelJob BatchPrintDialog::jobForRow(int row) const
+{
+    auto cell = [&](int col) {
+        QTableWidgetItem *item = table->item(row, col);
+        return item ? item->text().trimmed().toUpper() : QString();
+    };
+
+    LabelJob job;
+    job.style = cell(ColStyle) == "KEYTAG" ? "KEYTAG" : "DEFAULT";
+    job.mileage = cell(ColMileage);
+    job.interval = cell(ColInterval);
+    job.oilType = cell(ColOilType);
+    job.customer = cell(ColCustomer);
+    job.car = cell(ColCar);
+    job.plate = cell(ColPlate);
+    job.vin = cell(ColVin);
+    job.color = cell(ColColor);
+    job.repairOrder = cell(ColRepairOrder);
+    job.logo = TemplateSync::logoPlacement(job.style);
+
+    bool ok;
+    job.quantity = cell(ColQuantity).toInt(&ok);
+    if (!ok || job.quantity < 1) job.quantity = 1;
+    return job;
+}
+
+void BatchPrintDialog::setRowStatus(int key, const QString &text, bool error)
+{
+    int row = rowForKey(key);
+    if (row < 0)
+        return;
+
+    QTableWidgetItem *status = table->item(row, ColStatus);
+    status->setText(text);
+    status->setForeground(error ? QBrush(Qt::red) : QBrush());
+}
+
+//
+// Print
+//
+void BatchPrintDialog::printChecked()
+{
+    // printer -> combined stream, in first-seen order
+    QStringList printers;
+    QHash<QString, QByteArray> streams;
+    QHash<QString, QList<int>> keysByPrinter;
+    int errors = 0;
+
+    for (int row = 0; row < table->rowCount(); ++row) {
+        QTableWidgetItem *check = table->item(row, ColPrint);
+        if (check->checkState() != Qt::Checked)
+            continue;
+
+        int key = check->data(Qt::UserRole).toInt();
+        LabelJob job = jobForRow(row);
+
+        QString error;
+        if (!job.validate(&error)) {
+            setRowStatus(key, error, true);
+            ++errors;
+            continue;
+        }
+
+        QString printer = job.isKeyTag() ? keytagPrinter : defaultPrinter;
+        if (printer.isEmpty()) {
+            setRowStatus(key, "No printer selected for this style.", true);
+            ++errors;
+            continue;
+        }
+
+        if (!streams.contains(printer))
+            printers << printer;
+        QByteArray &stream = streams[printer];
+        job.appendZpl(stream, defaultMiles, formatMode);
+        stream += '\n';
+        keysByPrinter[printer] << key;
+        setRowStatus(key, "Queued", false);
+    }
+
+    int queued = 0;
+    int jobs = 0;
+    for (const QString &printer : printers) {
+        const QList<int> keys = keysByPrinter.value(printer);
+        quint64 id = submit(streams.value(printer), printer);
+        if (id == 0) {
+            for (int key : keys)
+                setRowStatus(key, "Could not queue job.", true);
+            errors += keys.size();
+            continue;
+        }
+        rowsByJob.insert(id, keys);
+        queued += keys.size();
+        ++jobs;
+    }
+
+    summaryLabel->setText(QString("%1 label(s) queued in %2 job(s), %3 row(s) with errors.")
+                              .arg(queued).arg(jobs).arg(errors));
+}
+
+void BatchPrintDialog::onJobFinished(quint64 id, const QString &printer, bool ok, const QString &message)
+{
+    if (!rowsByJob.contains(id))
+        return;
+
+    const QList<int> keys = rowsByJob.take(id);
+    for (int key : keys) {
+        if (ok)
+            setRowStatus(key, QString("Sent to %1").arg(printer), false);
+        else
+            setRowStatus(key, QString("Failed: %1").arg(message), true);
+    }
+}
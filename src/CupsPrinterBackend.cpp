@@ -0,0 +1,261 @@
+// src/CupsPrinterBackend.cpp
+#include "CupsPrinterBackend.hpp"
+
+#include <QProcess>
+
+#ifdef OILSTICKER_HAVE_CUPS
+#include <cups/cups.h>
+#include <QRegularExpression>
+#include <cstdio>
+#endif
+
+CupsPrinterBackend::~CupsPrinterBackend()
+{
+    closeConnection();
+}
+
+bool CupsPrinterBackend::isAvailable()
+{
+#ifdef OILSTICKER_HAVE_CUPS
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef OILSTICKER_HAVE_CUPS
+
+QStringList CupsPrinterBackend::queues(QHash<QString, QString> *models)
+{
+    QStringList names;
+    cups_dest_t *dests = nullptr;
+    int count = cupsGetDests2(CUPS_HTTP_DEFAULT, &dests);
+
+    for (int i = 0; i < count; ++i) {
+        if (dests[i].instance)
+            continue; // lpoptions instances share the queue
+        const QString name = QString::fromUtf8(dests[i].name);
+        names << name;
+        if (const char *model = cupsGetOption("printer-make-and-model", dests[i].num_options, dests[i].options))
+            models->insert(name, QString::fromUtf8(model));
+    }
+    cupsFreeDests(count, dests);
+    return names;
+}
+
+bool CupsPrinterBackend::print(const QString &printer, const QByteArray &data, const QString &title,
+                               int *jobId, QString *error, bool *retryable)
+{
+    const QByteArray name = printer.toUtf8();
+    const QByteArray jobTitle = title.toUtf8();
+
+    // The cached connection may have been closed by cupsd (idle timeout);
+    // in that case reconnect once and try again.
+    int id = 0;
+    for (int attempt = 0; attempt < 2 && id == 0; ++attempt) {
+        http_t *h = connection(error);
+        if (!h) {
+            if (retryable)
+                *retryable = true;
+            return false;
+        }
+
+        id = cupsCreateJob(h, name.constData(), jobTitle.constData(), 0, nullptr);
+        if (id == 0) {
+            *error = QString("cupsCreateJob failed: %1").arg(cupsLastErrorString());
+            if (attempt == 0 && httpReconnect2(h, 5000, nullptr) != 0)
+                closeConnection();
+        }
+    }
+
+    // CUPS reports transport failures as server errors (0x05xx); client
+    // errors (0x04xx) such as client-error-not-found will not go away.
+    if (id == 0) {
+        if (retryable)
+            *retryable = cupsLastError() >= IPP_STATUS_ERROR_INTERNAL;
+        return false;
+    }
+
+    // Past this point a job exists; one that could not be cancelled may
+    // still print, so it is not retried.
+    if (cupsStartDocument(http, name.constData(), id, jobTitle.constData(),
+                          CUPS_FORMAT_RAW, 1) != HTTP_STATUS_CONTINUE) {
+        *error = QString("cupsStartDocument failed: %1").arg(cupsLastErrorString());
+        const bool serverError = cupsLastError() >= IPP_STATUS_ERROR_INTERNAL;
+        const bool cancelled = cupsCancelJob2(http, name.constData(), id, 0) == IPP_STATUS_OK;
+        if (retryable)
+            *retryable = serverError && cancelled;
+        return false;
+    }
+
+    if (cupsWriteRequestData(http, data.constData(), size_t(data.size())) != HTTP_STATUS_CONTINUE) {
+        *error = QString("cupsWriteRequestData failed: %1").arg(cupsLastErrorString());
+        cupsFinishDocument(http, name.constData());
+        const bool cancelled = cupsCancelJob2(http, name.constData(), id, 0) == IPP_STATUS_OK;
+        if (retryable)
+            *retryable = cancelled;
+        return false;
+    }
+
+    // The whole document is with cupsd by now; it may well print.
+    if (cupsFinishDocument(http, name.constData()) > IPP_STATUS_OK_CONFLICTING) {
+        *error = QString("cupsFinishDocument failed: %1").arg(cupsLastErrorString());
+        if (retryable)
+            *retryable = false;
+        return false;
+    }
+
+    *jobId = id;
+    return true;
+}
+
+QString CupsPrinterBackend::jobState(int jobId, bool *finished, QString *error)
+{
+    *finished = false;
+
+    http_t *h = connection(error);
+    if (!h)
+        return QString();
+
+    char uri[HTTP_MAX_URI];
+    std::snprintf(uri, sizeof(uri), "ipp://localhost/jobs/%d", jobId);
+
+    static const char *const requested[] = { "job-state", "job-state-reasons" };
+
+    ipp_t *request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "job-uri", nullptr, uri);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", nullptr, cupsUser());
+    ippAddStrings(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD, "requested-attributes",
+                  2, nullptr, requested);
+
+    ipp_t *response = cupsDoRequest(h, request, "/"); // frees 'request'
+    if (!response || ippGetStatusCode(response) > IPP_STATUS_OK_CONFLICTING) {
+        *error = QString("Get-Job-Attributes failed: %1").arg(cupsLastErrorString());
+        ippDelete(response);
+        return QString();
+    }
+
+    QString state;
+    if (ipp_attribute_t *attr = ippFindAttribute(response, "job-state", IPP_TAG_ENUM)) {
+        int value = ippGetInteger(attr, 0);
+        state = QString::fromUtf8(ippEnumString("job-state", value));
+        *finished = value >= IPP_JSTATE_CANCELED;
+    }
+    ippDelete(response);
+    return state;
+}
+
+QString CupsPrinterBackend::printerState(const QString &printer, QStringList *reasons, QString *error)
+{
+    reasons->clear();
+
+    http_t *h = connection(error);
+    if (!h)
+        return QString();
+
+    char uri[HTTP_MAX_URI];
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", nullptr, "localhost", 0,
+                     "/printers/%s", printer.toUtf8().constData());
+
+    static const char *const requested[] = { "printer-state", "printer-state-reasons" };
+
+    ipp_t *request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", nullptr, uri);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", nullptr, cupsUser());
+    ippAddStrings(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD, "requested-attributes",
+                  2, nullptr, requested);
+
+    ipp_t *response = cupsDoRequest(h, request, "/"); // frees 'request'
+    if (!response || ippGetStatusCode(response) > IPP_STATUS_OK_CONFLICTING) {
+        *error = QString("Get-Printer-Attributes failed: %1").arg(cupsLastErrorString());
+        ippDelete(response);
+        return QString();
+    }
+
+    QString state;
+    if (ipp_attribute_t *attr = ippFindAttribute(response, "printer-state", IPP_TAG_ENUM)) {
+        int value = ippGetInteger(attr, 0);
+        state = QString::fromUtf8(ippEnumString("printer-state", value));
+        if (value == IPP_PSTATE_STOPPED)
+            *reasons << "paused";
+    }
+    if (ipp_attribute_t *attr = ippFindAttribute(response, "printer-state-reasons", IPP_TAG_KEYWORD)) {
+        for (int i = 0; i < ippGetCount(attr); ++i) {
+            QString reason = QString::fromUtf8(ippGetString(attr, i, nullptr));
+            reason.remove(QRegularExpression("-(report|warning|error)$"));
+            if (reason != "none" && !reasons->contains(reason))
+                *reasons << reason;
+        }
+    }
+    ippDelete(response);
+    return state;
+}
+
+http_t *CupsPrinterBackend::connection(QString *error)
+{
+    if (http)
+        return http;
+
+    http = httpConnect2(cupsServer(), ippPort(), nullptr, AF_UNSPEC,
+                        cupsEncryption(), 1, 5000, nullptr);
+    if (!http && error)
+        *error = QString("Could not connect to CUPS at %1").arg(cupsServer());
+    return http;
+}
+
+void CupsPrinterBackend::closeConnection()
+{
+    if (http) {
+        httpClose(http);
+        http = nullptr;
+    }
+}
+
+#else // !OILSTICKER_HAVE_CUPS
+
+QStringList CupsPrinterBackend::queues(QHash<QString, QString> *)
+{
+    // No libcups: lpstat, where it exists (not on Windows).
+    QStringList names;
+    QProcess lpstat;
+    lpstat.start("lpstat", QStringList() << "-a");
+    if (lpstat.waitForFinished(1500) && lpstat.exitCode() == 0) {
+        const QString output = QString::fromLocal8Bit(lpstat.readAllStandardOutput());
+        for (const QString &line : output.split('\n', Qt::SkipEmptyParts))
+            names << line.split(' ').first();
+    }
+    return names;
+}
+
+bool CupsPrinterBackend::print(const QString &, const QByteArray &, const QString &,
+                               int *, QString *error, bool *retryable)
+{
+    *error = "This build does not include CUPS support.";
+    if (retryable)
+        *retryable = false;
+    return false;
+}
+
+QString CupsPrinterBackend::jobState(int, bool *finished, QString *)
+{
+    *finished = true;
+    return QString();
+}
+
+QString CupsPrinterBackend::printerState(const QString &, QStringList *reasons, QString *error)
+{
+    reasons->clear();
+    *error = "This build does not include CUPS support.";
+    return QString();
+}
+
+http_t *CupsPrinterBackend::connection(QString *)
+{
+    return nullptr;
+}
+
+void CupsPrinterBackend::closeConnection()
+{
+}
+
+#endif
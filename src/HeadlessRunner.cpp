@@ -0,0 +1,485 @@
+// src/HeadlessRunner.cpp
+#include "HeadlessRunner.hpp"
+#include "PrintQueue.hpp"
+#include "PrintJournal.hpp"
+#include "SettingsStore.hpp"
+#include "TemplateSync.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QDate>
+#include <QLocale>
+#include <cstdio>
+#include <functional>
+
+namespace {
+
+// Field keys shared by the command-line options, JSON keys and CSV headers.
+struct FieldOption
+{
+    const char *name;
+    const char *description;
+};
+
+const FieldOption fieldOptions[] = {
+    { "style",    "DEFAULT (oil sticker) or KEYTAG." },
+    { "template", "Stored ZPL format to recall (default by style)." },
+    { "mileage",  "Current mileage (DEFAULT)." },
+    { "interval", "Miles until next service (DEFAULT; saved setting if omitted)." },
+    { "oil",      "Oil brand/grade (DEFAULT)." },
+    { "customer", "Customer (KEYTAG)." },
+    { "car",      "Car (KEYTAG)." },
+    { "plate",    "Plate (KEYTAG)." },
+    { "vin",      "VIN (KEYTAG)." },
+    { "color",    "Color (KEYTAG)." },
+    { "ro",       "Repair order (KEYTAG)." },
+    { "qty",      "Number of key tags (KEYTAG)." },
+};
+
+// Lower-case keys and fold the long spellings onto the option names.
+QVariantMap normalizeKeys(const QVariantMap &in)
+{
+    QVariantMap out;
+    for (auto it = in.constBegin(); it != in.constEnd(); ++it) {
+        QString key = it.key().trimmed().toLower();
+        if (key == "oiltype") key = "oil";
+        else if (key == "repairorder") key = "ro";
+        else if (key == "quantity") key = "qty";
+        out.insert(key, it.value());
+    }
+    return out;
+}
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+} // namespace
+
+HeadlessRunner::HeadlessRunner(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool HeadlessRunner::isHeadless(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg == "--print" || arg == "--jsonl" || arg == "--csv" || arg == "--headless"
+            || arg.startsWith("--bench-zpl"))
+            return true;
+    }
+    return false;
+}
+
+int HeadlessRunner::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Print oil change stickers and key tags without opening a window.\n"
+        "Printer and template settings are shared with the GUI.");
+    parser.addHelpOption();
+
+    QCommandLineOption headlessOpt("headless", "Run without a window (implied by the options below).");
+    QCommandLineOption printOpt("print", "Print the job described by the field options.");
+    QCommandLineOption jsonlOpt("jsonl", "Read jobs from stdin, one JSON object per line.");
+    QCommandLineOption csvOpt("csv", "Read jobs from stdin as CSV with a header row.");
+    QCommandLineOption zplOpt("zpl", "Write the generated ZPL to stdout instead of printing.");
+    QCommandLineOption printerOpt("printer", "Printer for every job (overrides saved settings).", "name");
+    QCommandLineOption inlineOpt("inline", "Send full formats instead of recalling them with ^XF.");
+    QCommandLineOption benchOpt("bench-zpl", "Time ZPL generation for <count> jobs per case and exit.", "count");
+    parser.addOptions({ headlessOpt, printOpt, jsonlOpt, csvOpt, zplOpt, printerOpt, inlineOpt, benchOpt });
+    for (const FieldOption &f : fieldOptions)
+        parser.addOption(QCommandLineOption(f.name, f.description, "value"));
+
+    if (!parser.parse(arguments)) {
+        err() << parser.errorText() << "\n";
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        out() << parser.helpText();
+        return StatusOk;
+    }
+    if (parser.isSet(benchOpt)) {
+        bool ok;
+        int count = parser.value(benchOpt).toInt(&ok);
+        return benchZpl(ok && count > 0 ? count : 100000);
+    }
+
+    // -----------------------------
+    // Collect jobs
+    // -----------------------------
+    QString error;
+    if (parser.isSet(printOpt)) {
+        QVariantMap fields;
+        for (const FieldOption &f : fieldOptions) {
+            if (parser.isSet(f.name))
+                fields.insert(f.name, parser.value(f.name));
+        }
+        Entry e;
+        e.job = jobFromMap(fields, &e.printer);
+        entries << e;
+    }
+    if (parser.isSet(jsonlOpt) && !readJsonLines(&error)) {
+        err() << error << "\n";
+        return ExitUsage;
+    }
+    if (parser.isSet(csvOpt) && !readCsv(&error)) {
+        err() << error << "\n";
+        return ExitUsage;
+    }
+    if (entries.isEmpty()) {
+        err() << "No label jobs given. Use --print with field options, --jsonl or --csv.\n";
+        return ExitUsage;
+    }
+
+    // -----------------------------
+    // Settings (same keys as the GUI)
+    // -----------------------------
+    const SettingsStore &settings = SettingsStore::instance();
+    const QString printerName = settings.printerName();
+    const QString keytagPrinterName = settings.keytagPrinterName();
+    const int defaultMiles = settings.defaultMiles();
+    const bool useIppPrinting = settings.useIppPrinting();
+    const QString networkProtocol = settings.networkProtocol();
+    const ZplTemplate::Mode formatMode =
+        (parser.isSet(inlineOpt) || settings.inlineFormats())
+            ? ZplTemplate::Inline : ZplTemplate::Recall;
+    const QString printerOverride = parser.value(printerOpt);
+    const bool zplOnly = parser.isSet(zplOpt);
+    statusToStderr = zplOnly;
+
+    // -----------------------------
+    // Generate and queue
+    // -----------------------------
+    PrintQueue *queue = nullptr;
+    PrintJournal *journal = nullptr;
+    QHash<quint64, int> indexByJob;
+    QHash<quint64, quint64> journalIds;   // print job id -> journal id
+
+    for (int i = 0; i < entries.size(); ++i) {
+        Entry &e = entries[i];
+        if (e.status != StatusOk) {
+            report(i, e);
+            continue;
+        }
+
+        if (!e.job.validate(&e.message)) {
+            e.status = StatusInvalid;
+            report(i, e);
+            continue;
+        }
+
+        QByteArray zpl = e.job.toZpl(defaultMiles, formatMode);
+
+        if (zplOnly) {
+            out() << QString::fromUtf8(zpl) << "\n";
+            out().flush();
+            e.message = "ZPL written";
+            report(i, e);
+            continue;
+        }
+
+        if (!printerOverride.isEmpty())
+            e.printer = printerOverride;
+        if (e.printer.isEmpty())
+            e.printer = e.job.isKeyTag() ? keytagPrinterName : printerName;
+        if (e.printer.isEmpty()) {
+            e.status = StatusNoPrinter;
+            e.message = "No printer selected. Choose one in the GUI or pass --printer.";
+            report(i, e);
+            continue;
+        }
+
+        if (!queue) {
+            queue = new PrintQueue(this);
+            // Shared with the GUI's Reprint list; skipped while the GUI has it open.
+            journal = new PrintJournal(this);
+            QString journalError;
+            if (!journal->open(PrintJournal::defaultPath(), &journalError))
+                err() << "Print journal disabled: " << journalError << "\n";
+        }
+        PrintTransport transport = PrintQueue::transportFor(e.printer, useIppPrinting, networkProtocol);
+        quint64 entryId = journal->append(e.printer, zpl, &e.job);
+        quint64 id = queue->enqueue(e.printer, zpl, transport);
+        indexByJob.insert(id, i);
+        if (entryId)
+            journalIds.insert(id, entryId);
+    }
+
+    // -----------------------------
+    // Wait for the print thread
+    // -----------------------------
+    if (!indexByJob.isEmpty()) {
+        QEventLoop loop;
+        connect(queue, &PrintQueue::jobFinished, &loop,
+            [&](quint64 id, const QString &, bool ok, const QString &message) {
+                int i = indexByJob.take(id);
+                Entry &e = entries[i];
+                e.status = ok ? StatusOk : StatusPrintFailed;
+                e.message = message;
+                if (quint64 entryId = journalIds.take(id))
+                    journal->setResult(entryId, ok, message);
+                report(i, e);
+                if (indexByJob.isEmpty())
+                    loop.quit();
+            });
+        loop.exec();
+    }
+    delete queue;
+    delete journal;
+
+    int exitCode = StatusOk;
+    for (const Entry &e : std::as_const(entries))
+        exitCode = qMax(exitCode, e.status);
+    return exitCode;
+}
+
+//
+// Benchmark
+//
+QList<BenchmarkResult> HeadlessRunner::benchZplCases(int count)
+{
+    LabelJob sticker;
+    sticker.mileage = "123456";
+    sticker.interval = "5000";
+    sticker.oilType = "MOBIL1 0W40";
+
+    LabelJob keytag;
+    keytag.style = "KEYTAG";
+    keytag.customer = "SMITH";
+    keytag.car = "2019 HONDA CIVIC";
+    keytag.plate = "ABC1234";
+    keytag.vin = "2HGFC2F59KH000000";
+    keytag.color = "BLUE";
+    keytag.repairOrder = "104233";
+    keytag.quantity = 4;
+
+    const QDate today = QDate::currentDate();
+    out() << QString("ZPL generation, %1 jobs per case\n").arg(count);
+
+    QList<BenchmarkResult> results;
+    auto time = [&](const char *name, const char *label, const std::function<qsizetype()> &job) {
+        job(); // warm the template cache
+        QElapsedTimer timer;
+        qsizetype bytes = 0;
+        timer.start();
+        for (int i = 0; i < count; ++i)
+            bytes = job();
+        const qint64 ns = qMax<qint64>(timer.nsecsElapsed(), 1);
+        const qint64 rate = qint64(count * 1e9 / ns);
+        out() << QString("  %1 %2 jobs/s  %3 bytes/job\n")
+                     .arg(QString(label).leftJustified(24))
+                     .arg(rate, 10)
+                     .arg(bytes, 5);
+        out().flush();
+        results << BenchmarkResult{ QString("zpl.") + name, label, double(rate), "jobs/s", true };
+    };
+
+    // The QString::arg chain printLabel() used before templates.
+    time("argchain.DEFAULT", "arg() chain (DEFAULT)", [&] {
+        QString zpl = QString(
+            "^XA\n"
+            "^XF%1^FS\n"
+            "^FN2^FD%2^FS\n"
+            "^FN3^FD%3^FS\n"
+            "^FN4^FD%4^FS\n"
+            "^FN5^FD%5^FS\n"
+            "^XZ\n"
+        ).arg("DEFAULT.ZPL")
+         .arg(sticker.oilType)
+         .arg(today.toString("MM/dd/yy"))
+         .arg(QString("%L1").arg(128456))
+         .arg(today.addMonths(6).toString("MM/dd/yy"));
+        return zpl.toUtf8().size();
+    });
+
+    QByteArray buffer;
+    time("recall.DEFAULT", "recall DEFAULT", [&] {
+        buffer.clear();
+        sticker.appendZpl(buffer, 5000, ZplTemplate::Recall, today);
+        return buffer.size();
+    });
+    time("recall.KEYTAGx4", "recall KEYTAG x4", [&] {
+        buffer.clear();
+        keytag.appendZpl(buffer, 5000, ZplTemplate::Recall, today);
+        return buffer.size();
+    });
+    time("inline.DEFAULT", "inline DEFAULT", [&] {
+        buffer.clear();
+        sticker.appendZpl(buffer, 5000, ZplTemplate::Inline, today);
+        return buffer.size();
+    });
+    time("inline.KEYTAGx4", "inline KEYTAG x4", [&] {
+        buffer.clear();
+        keytag.appendZpl(buffer, 5000, ZplTemplate::Inline, today);
+        return buffer.size();
+    });
+    return results;
+}
+
+int HeadlessRunner::benchZpl(int count)
+{
+    benchZplCases(count);
+    return StatusOk;
+}
+
+
+//
+// Input parsing
+//
+LabelJob HeadlessRunner::jobFromMap(const QVariantMap &fields, QString *printer)
+{
+    const QVariantMap f = normalizeKeys(fields);
+    auto value = [&](const char *key) { return f.value(key).toString().trimmed(); };
+
+    LabelJob job;
+    QString style = value("style").toUpper();
+    job.style = (style == "KEYTAG" || style == "KEY TAG") ? "KEYTAG" : "DEFAULT";
+    job.templateName = value("template").toUpper();
+
+    // Same upper-casing the GUI applies while typing.
+    job.mileage = value("mileage");
+    job.interval = value("interval");
+    job.oilType = value("oil").toUpper();
+    job.customer = value("customer").toUpper();
+    job.car = value("car").toUpper();
+    job.plate = value("plate").toUpper();
+    job.vin = value("vin").toUpper();
+    job.color = value("color").toUpper();
+    job.repairOrder = value("ro").toUpper();
+    job.logo = TemplateSync::logoPlacement(job.style);
+
+    bool ok;
+    job.quantity = value("qty").toInt(&ok);
+    if (!ok || job.quantity < 1) job.quantity = 1;
+
+    *printer = value("printer");
+    return job;
+}
+
+bool HeadlessRunner::readJsonLines(QString *error)
+{
+    QFile in;
+    if (!in.open(stdin, QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = "Could not read stdin.";
+        return false;
+    }
+
+    int lineNo = 0;
+    while (!in.atEnd()) {
+        const QByteArray line = in.readLine().trimmed();
+        ++lineNo;
+        if (line.isEmpty())
+            continue;
+
+        Entry e;
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (!doc.isObject()) {
+            e.status = StatusInvalid;
+            e.message = QString("Line %1: %2").arg(lineNo)
+                .arg(parseError.error == QJsonParseError::NoError ? QString("expected a JSON object")
+                                                                  : parseError.errorString());
+        } else {
+            e.job = jobFromMap(doc.object().toVariantMap(), &e.printer);
+        }
+        entries << e;
+    }
+    return true;
+}
+
+bool HeadlessRunner::readCsv(QString *error)
+{
+    QFile in;
+    if (!in.open(stdin, QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = "Could not read stdin.";
+        return false;
+    }
+
+    QStringList header;
+    while (!in.atEnd()) {
+        const QString line = QString::fromUtf8(in.readLine()).trimmed();
+        if (line.isEmpty())
+            continue;
+
+        const QStringList cells = splitCsvLine(line);
+        if (header.isEmpty()) {
+            header = cells;
+            continue;
+        }
+
+        QVariantMap fields;
+        for (int c = 0; c < header.size() && c < cells.size(); ++c)
+            fields.insert(header.at(c), cells.at(c));
+
+        Entry e;
+        e.job = jobFromMap(fields, &e.printer);
+        entries << e;
+    }
+
+    if (header.isEmpty()) {
+        *error = "CSV input needs a header row (style,mileage,interval,oil,customer,...).";
+        return false;
+    }
+    return true;
+}
+
+QStringList HeadlessRunner::splitCsvLine(const QString &line)
+{
+    // RFC 4180 quoting: "a, b" and "" for a literal quote.
+    QStringList cells;
+    QString cell;
+    bool quoted = false;
+
+    for (int i = 0; i < line.size(); ++i) {
+        const QChar ch = line.at(i);
+        if (quoted) {
+            if (ch == '"') {
+                if (i + 1 < line.size() && line.at(i + 1) == '"') {
+                    cell += '"';
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                cell += ch;
+            }
+        } else if (ch == '"') {
+            quoted = true;
+        } else if (ch == ',') {
+            cells << cell.trimmed();
+            cell.clear();
+        } else {
+            cell += ch;
+        }
+    }
+    cells << cell.trimmed();
+    return cells;
+}
+
+void HeadlessRunner::report(int index, const Entry &entry)
+{
+    QString line = QString("%1\t%2\t%3\n").arg(index + 1).arg(entry.status).arg(entry.message);
+
+    // Keep stdout clean for the ZPL itself in --zpl mode.
+    QTextStream &stream = statusToStderr ? err() : out();
+    stream << line;
+    stream.flush();
+}
@@ -0,0 +1,556 @@
+// src/IppClient.cpp
+#include "IppClient.hpp"
+
+#include <QTcpSocket>
+#include <QUrl>
+#include <QDebug>
+
+namespace {
+
+// RFC 8010 delimiter and value tags
+enum Tag : quint8 {
+    OperationAttributesTag = 0x01,
+    EndOfAttributesTag     = 0x03,
+    TagInteger             = 0x21,
+    TagBoolean             = 0x22,
+    TagEnum                = 0x23,
+    TagName                = 0x42,
+    TagKeyword             = 0x44,
+    TagUri                 = 0x45,
+    TagCharset             = 0x47,
+    TagNaturalLanguage     = 0x48,
+    TagMimeMediaType       = 0x49
+};
+
+void put16(QByteArray &out, quint16 v)
+{
+    out.append(char(v >> 8));
+    out.append(char(v & 0xff));
+}
+
+void put32(QByteArray &out, quint32 v)
+{
+    put16(out, quint16(v >> 16));
+    put16(out, quint16(v & 0xffff));
+}
+
+quint16 get16(const uchar *p)
+{
+    return quint16((p[0] << 8) | p[1]);
+}
+
+quint32 get32(const uchar *p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+// An empty 'name' encodes an additional value of the previous attribute.
+void putString(QByteArray &out, quint8 tag, const QByteArray &name, const QByteArray &value)
+{
+    out.append(char(tag));
+    put16(out, quint16(name.size()));
+    out.append(name);
+    put16(out, quint16(value.size()));
+    out.append(value);
+}
+
+void putInteger(QByteArray &out, quint8 tag, const QByteArray &name, qint32 value)
+{
+    out.append(char(tag));
+    put16(out, quint16(name.size()));
+    out.append(name);
+    put16(out, 4);
+    put32(out, quint32(value));
+}
+
+QByteArray userName()
+{
+    QString user = qEnvironmentVariable("USER");
+    if (user.isEmpty()) user = qEnvironmentVariable("USERNAME");
+    if (user.isEmpty()) user = "oilsticker";
+    return user.toUtf8();
+}
+
+// Version 2.0 header plus the operation attributes every request carries.
+QByteArray requestHeader(quint16 operation, quint32 requestId, const QString &uri)
+{
+    QByteArray out;
+    out.reserve(256);
+    out.append(char(2));
+    out.append(char(0));
+    put16(out, operation);
+    put32(out, requestId);
+    out.append(char(OperationAttributesTag));
+    putString(out, TagCharset, "attributes-charset", "utf-8");
+    putString(out, TagNaturalLanguage, "attributes-natural-language", "en");
+    putString(out, TagUri, "printer-uri", uri.toUtf8());
+    putString(out, TagName, "requesting-user-name", userName());
+    return out;
+}
+
+} // namespace
+
+//
+// Response accessors
+//
+bool IppClient::Response::isRetryable() const
+{
+    if (delivery == NotSent)
+        return true;
+    if (delivery == Unknown)
+        return false;
+    return httpStatus >= 500 || (httpStatus == 200 && ippStatus >= 0x0500 && ippStatus <= 0x05FF);
+}
+
+int IppClient::Response::intValue(const QString &name, int fallback) const
+{
+    const QVariantList values = attributes.value(name);
+    if (values.isEmpty() || values.first().typeId() != QMetaType::Int)
+        return fallback;
+    return values.first().toInt();
+}
+
+QString IppClient::Response::stringValue(const QString &name) const
+{
+    const QVariantList values = attributes.value(name);
+    return values.isEmpty() ? QString() : values.first().toString();
+}
+
+IppClient::IppClient(QObject *parent)
+    : QObject(parent)
+{
+}
+
+IppClient::~IppClient()
+{
+    disconnectAll();
+}
+
+//
+// Operations
+//
+QList<IppClient::Response> IppClient::printJobs(const QString &printer,
+                                                const QList<QByteArray> &documents,
+                                                const QString &jobName)
+{
+    const QString uri = printerUri(printer);
+
+    QList<QByteArray> bodies;
+    bodies.reserve(documents.size());
+    for (const QByteArray &doc : documents)
+        bodies << encodePrintJob(uri, nextRequestId++, jobName, documentFormat, doc);
+
+    QList<Response> responses = pipeline(printer, bodies);
+
+    // Printers that do not know the Zebra MIME type reject the document;
+    // resend those as octet-stream and remember the choice.
+    const QString fallbackFormat = "application/octet-stream";
+    if (documentFormat != fallbackFormat) {
+        QList<int> rejected;
+        for (int i = 0; i < responses.size(); ++i) {
+            if (responses[i].ippStatus == ClientErrorDocumentFormatNotSupported)
+                rejected << i;
+        }
+        if (!rejected.isEmpty()) {
+            qWarning() << "IppClient:" << printer << "rejected" << documentFormat << "- using" << fallbackFormat;
+            documentFormat = fallbackFormat;
+
+            QList<QByteArray> retry;
+            for (int i : rejected)
+                retry << encodePrintJob(uri, nextRequestId++, jobName, documentFormat, documents[i]);
+            QList<Response> retried = pipeline(printer, retry);
+            for (int k = 0; k < rejected.size(); ++k)
+                responses[rejected[k]] = retried[k];
+        }
+    }
+    return responses;
+}
+
+IppClient::Response IppClient::jobAttributes(const QString &printer, int jobId)
+{
+    return pipeline(printer, { encodeGetJobAttributes(printerUri(printer), nextRequestId++, jobId) }).first();
+}
+
+IppClient::Response IppClient::printerAttributes(const QString &printer, const QStringList &requested)
+{
+    return pipeline(printer, { encodeGetPrinterAttributes(printerUri(printer), nextRequestId++, requested) }).first();
+}
+
+void IppClient::disconnectAll()
+{
+    for (QTcpSocket *socket : std::as_const(sockets)) {
+        socket->abort();
+        delete socket;
+    }
+    sockets.clear();
+}
+
+QString IppClient::printerUri(const QString &printer)
+{
+    QString p = printer.trimmed();
+    if (p.startsWith("ipp://") || p.startsWith("ipps://") || p.startsWith("http://"))
+        return p;
+
+    QString host = p;
+    int port = DefaultPort;
+    if (p.count(':') == 1) {
+        bool ok = false;
+        int parsed = p.section(':', 1).toInt(&ok);
+        if (ok) {
+            host = p.section(':', 0, 0);
+            port = parsed;
+        }
+    }
+    // 9100 is the raw ZPL port; IPP always lives on 631.
+    if (port == 9100)
+        port = DefaultPort;
+
+    return QString("ipp://%1:%2/ipp/print").arg(host).arg(port);
+}
+
+QString IppClient::jobStateName(int state, bool *finished)
+{
+    if (finished)
+        *finished = state >= 7;
+
+    switch (state) {
+    case 3: return "pending";
+    case 4: return "pending-held";
+    case 5: return "processing";
+    case 6: return "processing-stopped";
+    case 7: return "canceled";
+    case 8: return "aborted";
+    case 9: return "completed";
+    default: return QString("state %1").arg(state);
+    }
+}
+
+//
+// Encoder
+//
+QByteArray IppClient::encodePrintJob(const QString &uri, quint32 requestId, const QString &jobName,
+                                     const QString &documentFormat, const QByteArray &document)
+{
+    QByteArray out = requestHeader(OpPrintJob, requestId, uri);
+    putString(out, TagName, "job-name", jobName.toUtf8());
+    putString(out, TagMimeMediaType, "document-format", documentFormat.toUtf8());
+    out.append(char(EndOfAttributesTag));
+    out.append(document);
+    return out;
+}
+
+QByteArray IppClient::encodeGetJobAttributes(const QString &uri, quint32 requestId, int jobId)
+{
+    QByteArray out = requestHeader(OpGetJobAttributes, requestId, uri);
+    putInteger(out, TagInteger, "job-id", jobId);
+    putString(out, TagKeyword, "requested-attributes", "job-state");
+    putString(out, TagKeyword, QByteArray(), "job-state-reasons");
+    out.append(char(EndOfAttributesTag));
+    return out;
+}
+
+QByteArray IppClient::encodeGetPrinterAttributes(const QString &uri, quint32 requestId,
+                                                 const QStringList &requested)
+{
+    QByteArray out = requestHeader(OpGetPrinterAttributes, requestId, uri);
+    for (int i = 0; i < requested.size(); ++i)
+        putString(out, TagKeyword, i == 0 ? QByteArray("requested-attributes") : QByteArray(),
+                  requested[i].toUtf8());
+    out.append(char(EndOfAttributesTag));
+    return out;
+}
+
+//
+// Decoder
+//
+bool IppClient::decodeResponse(const QByteArray &body, Response *response)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(body.constData());
+    const int n = body.size();
+
+    if (n < 8) {
+        response->error = "Short IPP response";
+        return false;
+    }
+
+    response->ippStatus = get16(p + 2);
+    response->requestId = get32(p + 4);
+
+    QString lastName;
+    bool truncated = false;
+    int pos = 8;
+    while (pos < n) {
+        quint8 tag = p[pos++];
+        if (tag == EndOfAttributesTag)
+            break;
+        if (tag < 0x10) // begin of another attribute group
+            continue;
+
+        if (pos + 2 > n) { truncated = true; break; }
+        int nameLen = get16(p + pos);
+        pos += 2;
+        if (pos + nameLen + 2 > n) { truncated = true; break; }
+        QString name = QString::fromUtf8(body.constData() + pos, nameLen);
+        pos += nameLen;
+
+        int valueLen = get16(p + pos);
+        pos += 2;
+        if (pos + valueLen > n) { truncated = true; break; }
+
+        if (nameLen == 0)
+            name = lastName;
+        else
+            lastName = name;
+
+        QVariant value;
+        if ((tag == TagInteger || tag == TagEnum) && valueLen == 4)
+            value = qint32(get32(p + pos));
+        else if (tag == TagBoolean && valueLen == 1)
+            value = p[pos] != 0;
+        else if (tag >= 0x40 && tag <= 0x4F) // character-string types
+            value = QString::fromUtf8(body.constData() + pos, valueLen);
+        else
+            value = body.mid(pos, valueLen);
+        pos += valueLen;
+
+        response->attributes[name].append(value);
+    }
+
+    if (truncated) {
+        response->error = "Truncated IPP response";
+        return false;
+    }
+    return true;
+}
+
+/* --- Helpers --- */
+
+QList<IppClient::Response> IppClient::pipeline(const QString &printer, const QList<QByteArray> &bodies)
+{
+    QList<Response> responses(bodies.size());
+
+    const QUrl url(printerUri(printer));
+    const QByteArray path = url.path().isEmpty() ? QByteArray("/ipp/print") : url.path().toUtf8();
+    const QByteArray host = QString("%1:%2").arg(url.host()).arg(url.port(DefaultPort)).toUtf8();
+
+    QString error;
+    int attemptsLeft = 2;
+    int first = 0;   // first request without a final Delivery
+
+    while (first < bodies.size() && attemptsLeft > 0) {
+        QTcpSocket *socket = socketFor(printer, &error);
+        if (!socket)
+            break;
+
+        // Write the rest, remembering where each request starts so a failed
+        // write tells which of them the printer may have seen.
+        QList<qint64> starts;
+        qint64 queued = 0;
+        qint64 sent = 0;
+        const QMetaObject::Connection counter = connect(socket, &QIODevice::bytesWritten, this,
+                                                        [&sent](qint64 bytes) { sent += bytes; });
+        for (int i = first; i < bodies.size(); ++i) {
+            QByteArray head;
+            head.reserve(160);
+            head += "POST " + path + " HTTP/1.1\r\n";
+            head += "Host: " + host + "\r\n";
+            head += "Content-Type: application/ipp\r\n";
+            head += "Content-Length: " + QByteArray::number(bodies[i].size()) + "\r\n";
+            head += "Connection: keep-alive\r\n\r\n";
+            starts << queued;
+            queued += socket->write(head);
+            queued += socket->write(bodies[i]);
+        }
+
+        bool written = true;
+        while (written && socket->bytesToWrite() > 0)
+            written = socket->waitForBytesWritten(ioTimeoutMs);
+        disconnect(counter);
+
+        const int before = first;
+        bool keepAlive = true;
+        bool broken = !written;
+        if (!written) {
+            error = QString("Write to %1 failed: %2").arg(printer, socket->errorString());
+        } else {
+            sent = queued;
+            while (first < bodies.size()) {
+                int status = 0;
+                QByteArray body;
+                if (!readHttpResponse(socket, &status, &body, &keepAlive, &error)) {
+                    broken = true;
+                    break;
+                }
+
+                Response &r = responses[first++];
+                r.delivery = Answered;
+                r.httpStatus = status;
+                if (status != 200) {
+                    r.error = QString("HTTP status %1").arg(status);
+                } else if (decodeResponse(body, &r)) {
+                    r.ok = r.ippStatus <= SuccessfulOkConflicting;
+                    if (!r.ok) {
+                        r.error = r.stringValue("status-message");
+                        if (r.error.isEmpty())
+                            r.error = QString("IPP status 0x%1").arg(r.ippStatus, 4, 16, QChar('0'));
+                    }
+                }
+
+                if (!keepAlive)
+                    break;
+            }
+        }
+
+        if (first < bodies.size()) {
+            dropSocket(printer);
+
+            // The connection failed under us: whatever went out unanswered
+            // may have been processed. (After a clean Connection: close the
+            // rest were not, and go out again.)
+            if (broken) {
+                while (first < bodies.size() && starts.value(first - before, queued) < sent) {
+                    Response &r = responses[first++];
+                    r.delivery = Unknown;
+                    r.error = QString("No response from %1; the job may have printed (%2)")
+                                  .arg(printer, error);
+                }
+            }
+        }
+        if (first == before)
+            --attemptsLeft;
+    }
+
+    for (int i = first; i < bodies.size(); ++i) {
+        Response &r = responses[i];
+        r.delivery = NotSent;
+        r.error = error.isEmpty() ? QString("No response from %1").arg(printer) : error;
+    }
+    return responses;
+}
+
+QTcpSocket *IppClient::socketFor(const QString &printer, QString *error)
+{
+    QTcpSocket *socket = sockets.value(printer, nullptr);
+    if (socket) {
+        socket->waitForReadyRead(0);
+        if (socket->state() == QAbstractSocket::ConnectedState) {
+            socket->readAll();
+            return socket;
+        }
+        dropSocket(printer);
+    }
+
+    const QUrl url(printerUri(printer));
+    socket = new QTcpSocket(this);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+    socket->connectToHost(url.host(), quint16(url.port(DefaultPort)));
+
+    if (!socket->waitForConnected(connectTimeoutMs)) {
+        *error = QString("Could not connect to %1: %2").arg(url.toString(), socket->errorString());
+        delete socket;
+        return nullptr;
+    }
+
+    sockets.insert(printer, socket);
+    return socket;
+}
+
+void IppClient::dropSocket(const QString &printer)
+{
+    QTcpSocket *socket = sockets.take(printer);
+    if (!socket)
+        return;
+    socket->abort();
+    socket->deleteLater();
+}
+
+bool IppClient::readHttpResponse(QTcpSocket *socket, int *status, QByteArray *body,
+                                 bool *keepAlive, QString *error)
+{
+    auto waitLine = [&]() {
+        while (!socket->canReadLine()) {
+            if (!socket->waitForReadyRead(ioTimeoutMs))
+                return false;
+        }
+        return true;
+    };
+    auto readExactly = [&](qint64 count) {
+        while (socket->bytesAvailable() < count) {
+            if (!socket->waitForReadyRead(ioTimeoutMs))
+                return false;
+        }
+        body->append(socket->read(count));
+        return true;
+    };
+    auto fail = [&](const QString &what) {
+        *error = QString("%1: %2").arg(what, socket->errorString());
+        return false;
+    };
+
+    // Loop to skip interim 1xx responses.
+    for (;;) {
+        if (!waitLine())
+            return fail("No HTTP response");
+
+        const QList<QByteArray> statusLine = socket->readLine().trimmed().split(' ');
+        if (statusLine.size() < 2 || !statusLine[0].startsWith("HTTP/"))
+            return fail("Malformed HTTP status line");
+        *status = statusLine[1].toInt();
+        *keepAlive = statusLine[0] != "HTTP/1.0";
+
+        qint64 contentLength = -1;
+        bool chunked = false;
+        for (;;) {
+            if (!waitLine())
+                return fail("Truncated HTTP headers");
+            const QByteArray line = socket->readLine().trimmed();
+            if (line.isEmpty())
+                break;
+            int colon = line.indexOf(':');
+            if (colon < 0)
+                continue;
+            const QByteArray key = line.left(colon).trimmed().toLower();
+            const QByteArray value = line.mid(colon + 1).trimmed().toLower();
+            if (key == "content-length")
+                contentLength = value.toLongLong();
+            else if (key == "transfer-encoding")
+                chunked = value.contains("chunked");
+            else if (key == "connection")
+                *keepAlive = !value.contains("close");
+        }
+
+        if (*status >= 100 && *status < 200)
+            continue;
+
+        body->clear();
+        if (chunked) {
+            for (;;) {
+                if (!waitLine())
+                    return fail("Truncated chunk header");
+                qint64 size = socket->readLine().trimmed().split(';').first().toLongLong(nullptr, 16);
+                if (size == 0) {
+                    // trailers end with an empty line
+                    do {
+                        if (!waitLine())
+                            return fail("Truncated chunk trailer");
+                    } while (!socket->readLine().trimmed().isEmpty());
+                    break;
+                }
+                if (!readExactly(size) || !waitLine())
+                    return fail("Truncated chunk");
+                socket->readLine(); // CRLF after the chunk data
+            }
+        } else if (contentLength >= 0) {
+            if (!readExactly(contentLength))
+                return fail("Truncated HTTP body");
+        } else {
+            // No length: the body runs until the printer closes the connection.
+            while (socket->waitForReadyRead(ioTimeoutMs))
+                body->append(socket->readAll());
+            body->append(socket->readAll());
+            *keepAlive = false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,116 @@
+// src/LabelFieldModel.cpp
+#include "LabelFieldModel.hpp"
+
+#include <QLocale>
+#include <QTimer>
+
+LabelFieldModel::LabelFieldModel(QObject *parent)
+    : QObject(parent),
+      frameTimer(new QTimer(this))
+{
+    frameTimer->setSingleShot(true);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer, &QTimer::timeout, this, &LabelFieldModel::flush);
+}
+
+void LabelFieldModel::setInput(Input input, const QString &text)
+{
+    if (input < 0 || input >= InputCount || inputs[input] == text)
+        return;
+    inputs[input] = text;
+    schedule();
+}
+
+void LabelFieldModel::setStyle(const QString &s)
+{
+    const QString upper = s.toUpper();
+    if (upper == style)
+        return;
+    style = upper;
+    current.clear();
+    schedule();
+}
+
+void LabelFieldModel::setDefaultMiles(int miles)
+{
+    if (miles <= 0 || miles == defaultMiles)
+        return;
+    defaultMiles = miles;
+    schedule();
+}
+
+void LabelFieldModel::schedule()
+{
+    // The first change after a quiet frame goes out on the next pass of the
+    // event loop; changes arriving within the same frame ride along.
+    if (frameTimer->isActive())
+        return;
+    const qint64 since = lastFlush.isValid() ? lastFlush.elapsed() : FrameMs;
+    frameTimer->start(int(qMax<qint64>(0, FrameMs - since)));
+}
+
+void LabelFieldModel::flush()
+{
+    frameTimer->stop();
+    lastFlush.start();
+
+    const QHash<int, QString> next = derive();
+    QHash<int, QString> changed;
+    for (auto it = next.cbegin(); it != next.cend(); ++it) {
+        auto old = current.constFind(it.key());
+        if (old == current.cend() || *old != it.value())
+            changed.insert(it.key(), it.value());
+    }
+    current = next;
+
+    if (!changed.isEmpty())
+        emit fieldsChanged(changed);
+}
+
+QHash<int, QString> LabelFieldModel::derive()
+{
+    // Same ^FN numbers and formatting as LabelJob::appendZpl().
+    if (style == "KEYTAG") {
+        return {
+            { 2, inputs[Customer].trimmed() },
+            { 3, inputs[Car].trimmed() },
+            { 4, inputs[Plate].trimmed() },
+            { 5, inputs[Vin].trimmed() },
+            { 6, inputs[Color].trimmed() },
+            { 7, inputs[RepairOrder].trimmed() },
+        };
+    }
+
+    // Nothing is shown until the mileage is a number.
+    bool okMileage, okInterval;
+    const int miles = QStringView(inputs[Mileage]).trimmed().toInt(&okMileage);
+    if (!okMileage)
+        return { { 2, QString() }, { 3, QString() }, { 4, QString() }, { 5, QString() } };
+
+    int interval = QStringView(inputs[Interval]).trimmed().toInt(&okInterval);
+    if (!okInterval) interval = defaultMiles;
+
+    const QDate today = QDate::currentDate();
+    if (today != cachedDay) {
+        cachedDay = today;
+        todayText = today.toString("MM/dd/yy");
+        nextDateText = today.addMonths(6).toString("MM/dd/yy");
+    }
+
+    static const QLocale english(QLocale::English);
+    return {
+        { 2, inputs[OilType].trimmed() },
+        { 3, todayText },
+        { 4, english.toString(miles + interval) },
+        { 5, nextDateText },
+    };
+}
+
+//
+// UpperCaseValidator
+//
+QValidator::State UpperCaseValidator::validate(QString &input, int &) const
+{
+    input = input.toUpper();
+    return Acceptable;
+}
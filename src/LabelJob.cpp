@@ -0,0 +1,95 @@
+// src/LabelJob.cpp
+#include "LabelJob.hpp"
+
+#include <QLocale>
+
+bool LabelJob::validate(QString *error) const
+{
+    if (isKeyTag())
+        return true;
+
+    bool okMileage, okInterval = true;
+    mileage.trimmed().toInt(&okMileage);
+    if (!interval.trimmed().isEmpty())
+        interval.trimmed().toInt(&okInterval);
+
+    if (!okMileage || !okInterval) {
+        *error = "Inputs must be numbers.";
+        return false;
+    }
+    return true;
+}
+
+QString LabelJob::effectiveTemplate() const
+{
+    if (isKeyTag()) {
+        if (labelCount() > 1)
+            return "LABEL.ZPL";
+        return templateName.isEmpty() ? QString("KEYTAG.ZPL") : templateName;
+    }
+    return templateName.isEmpty() ? QString("DEFAULT.ZPL") : templateName;
+}
+
+int LabelJob::labelCount() const
+{
+    int qty = quantity < 1 ? 1 : quantity;
+    // divide by 2, round UP
+    return (qty + 1) / 2;
+}
+
+QByteArray LabelJob::toZpl(int defaultMiles, ZplTemplate::Mode mode, const QDate &today) const
+{
+    QByteArray out;
+    appendZpl(out, defaultMiles, mode, today);
+    return out;
+}
+
+void LabelJob::appendZpl(QByteArray &out, int defaultMiles, ZplTemplate::Mode mode, const QDate &today) const
+{
+    // Fields used when a template has no local source (custom names).
+    static const QList<int> defaultFields = { 2, 3, 4, 5 };
+    static const QList<int> keytagFields = { 2, 3, 4, 5, 6, 7 };
+
+    // Indexed by ^FN number.
+    QStringView fields[8];
+
+    if (!isKeyTag()) {
+        // Date strings only change once a day.
+        thread_local QDate cachedDay;
+        thread_local QString todayText;
+        thread_local QString nextDateText;
+        if (today != cachedDay) {
+            cachedDay = today;
+            todayText = today.toString("MM/dd/yy");
+            nextDateText = today.addMonths(6).toString("MM/dd/yy");
+        }
+
+        bool okInterval;
+        int miles = QStringView(mileage).trimmed().toInt();
+        int next = QStringView(interval).trimmed().toInt(&okInterval);
+        if (!okInterval) next = defaultMiles;
+
+        static const QLocale english(QLocale::English);
+        const QString formattedMileage = english.toString(miles + next);
+
+        fields[2] = QStringView(oilType).trimmed();   // oil type
+        fields[3] = todayText;                        // today's date
+        fields[4] = formattedMileage;                 // next mileage
+        fields[5] = nextDateText;                     // next date
+
+        ZplTemplateLibrary::instance()
+            .get(effectiveTemplate(), mode, defaultFields)
+            .render(out, fields, 8, 0, logo);
+    } else {
+        fields[2] = QStringView(customer).trimmed();
+        fields[3] = QStringView(car).trimmed();
+        fields[4] = QStringView(plate).trimmed();
+        fields[5] = QStringView(vin).trimmed();
+        fields[6] = QStringView(color).trimmed();
+        fields[7] = QStringView(repairOrder).trimmed();
+
+        ZplTemplateLibrary::instance()
+            .get(effectiveTemplate(), mode, keytagFields)
+            .render(out, fields, 8, labelCount(), logo);
+    }
+}
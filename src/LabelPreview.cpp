@@ -1,15 +1,16 @@
 // src/LabelPreview.cpp
 #include "LabelPreview.hpp"
+#include "LabelJob.hpp"
+#include "BackgroundImageLoader.hpp"
 
 #include <QPainter>
 #include <QFont>
-#include <QFontDatabase>
-#include <QFile>
-#include <QCoreApplication>
-#include <QDir>
 #include <QDebug>
-#include <QFileInfo>
 #include <QPainterPath>
+#include <QPaintEvent>
+#include <QFontMetrics>
+#include <QtMath>
+#include <QTimer>
 
 LabelPreview::LabelPreview(QWidget *parent)
     : QFrame(parent),
@@ -23,18 +24,30 @@ LabelPreview::LabelPreview(QWidget *parent)
 
     updatePreviewSize();
 
-    // Try to load the Zebra A0 TTF file from qrc resources (optional)
-    int fontId = QFontDatabase::addApplicationFont(":/resources/tt0003m_.ttf");
-    if (fontId != -1) {
-        QStringList families = QFontDatabase::applicationFontFamilies(fontId);
-        if (!families.isEmpty()) {
-            zebraFontFamily = families.at(0);
-            qDebug() << "Loaded Zebra A0 font:" << zebraFontFamily;
-        }
-    }
+    // Zebra A0 TTF from qrc resources (registered once, shared with the
+    // rasterizer). Registering it is slow, so the first frame goes up
+    // without the template and it is rasterized once the font is in.
+    updateFormat();
+    ZplRasterizer::loadFont0Async(this, [this]() { onFontLoaded(); });
+
+    // Default background, unless the owner sets one before the event loop
+    // runs (decoding one nobody sees would delay the real one).
+    backgroundLoader = new BackgroundImageLoader(this);
+    connect(backgroundLoader, &BackgroundImageLoader::loaded, this, &LabelPreview::onBackgroundLoaded);
+    backgroundPath = DefaultBackground;
+    backgroundPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        if (backgroundPath == DefaultBackground && backgroundPending)
+            setBackground(DefaultBackground);
+    });
+}
 
-    // Default background
-    setBackground(":/resources/default.png");
+void LabelPreview::onFontLoaded()
+{
+    fontPending = false;
+    zebraFontFamily = ZplRasterizer::font0Family();
+    updateFormat();
+    update();
 }
 
 void LabelPreview::updatePreview(const QString &nm,
@@ -49,6 +62,8 @@ void LabelPreview::updatePreview(const QString &nm,
                                  const QString &ro)
 
 {
+    const QHash<int, QString> before = fieldData();
+
     nextMileage = nm;
     nextDate = nd;
     oilType = ot;
@@ -61,21 +76,88 @@ void LabelPreview::updatePreview(const QString &nm,
     color = col;
     repairOrder = ro;
 
-    update();
+    const QHash<int, QString> after = fieldData();
+    QList<int> changed;
+    for (auto it = after.cbegin(); it != after.cend(); ++it) {
+        if (before.value(it.key()) != it.value())
+            changed << it.key();
+    }
+    repaintChangedFields(changed);
+}
+
+void LabelPreview::setFields(const QHash<int, QString> &fields)
+{
+    QList<int> changed;
+    for (auto it = fields.cbegin(); it != fields.cend(); ++it) {
+        QString *value = fieldValue(it.key());
+        if (value && *value != it.value()) {
+            *value = it.value();
+            changed << it.key();
+        }
+    }
+    repaintChangedFields(changed);
+}
+
+void LabelPreview::repaintChangedFields(const QList<int> &changed)
+{
+    if (changed.isEmpty())
+        return;
+
+    emit labelChanged();
+    if (labelDots.isNull()) {
+        update();
+        return;
+    }
+
+    // Re-rasterize and repaint only the fields that changed.
+    const QRect dots = rasterizer.repaintFields(labelDots, fieldData(), changed);
+    updateInk(dots);
+    update(dotsToWidget(dots));
+}
+
+void LabelPreview::setBackground(const QString &path)
+{
+    // A decoded copy is shown at once; the loader still checks the file's
+    // mtime and sends a fresh decode if it changed.
+    backgroundPath = path;
+    const QImage image = BackgroundImageLoader::cached(path);
+    backgroundPending = image.isNull();
+    if (!backgroundPending)
+        applyBackground(image);
+    backgroundLoader->request(path);
 }
 
-void LabelPreview::setBackground(const QString &backgroundPath)
+void LabelPreview::prefetchBackground(const QString &path)
 {
-    QPixmap pix = loadWithFallback(backgroundPath);
-    if (!pix.isNull()) {
-        background = pix; // keep original bitmap size (expected 448x418)
-    } else {
-        qWarning() << "LabelPreview::setBackground — could not load:" << backgroundPath;
-        // fallback white background of full widget size
-        background = QPixmap(size());
-        background.fill(Qt::white);
+    backgroundLoader->request(path);
+}
+
+void LabelPreview::onBackgroundLoaded(const QString &path, const QImage &image)
+{
+    if (path != backgroundPath)
+        return;   // superseded by a later setBackground()
+
+    backgroundPending = false;
+    if (!image.isNull()) {
+        applyBackground(image); // keep original bitmap size (expected 448x418)
+        return;
     }
+
+    qWarning() << "LabelPreview::setBackground — could not load:" << path;
+    // fallback white background of full widget size
+    QImage blank(size(), QImage::Format_ARGB32_Premultiplied);
+    blank.fill(Qt::white);
+    applyBackground(blank);
+}
+
+void LabelPreview::applyBackground(const QImage &image)
+{
+    if (image.cacheKey() == background.cacheKey())
+        return;
+    background = image;
+    staticLayerDirty = true;
     update();
+    emit labelChanged();
 }
 
 void LabelPreview::setLabelStyle(const QString &style)
@@ -88,59 +170,196 @@ void LabelPreview::setLabelStyle(const QString &style)
 
     currentStyle = newStyle;
 
-    updatePreviewSize();
+    updateFormat();
     update();
 }
 
+void LabelPreview::setTemplateName(const QString &name)
+{
+    if (name.toUpper() == templateName)
+        return;
+    templateName = name.toUpper();
+    updateFormat();
+    update();
+}
 
-void LabelPreview::paintEvent(QPaintEvent *)
+void LabelPreview::setPrinterDpi(int dpi)
 {
-    QPainter painter(this);
+    if (dpi <= 0 || dpi == printerDpi)
+        return;
+    printerDpi = dpi;
+    updateFormat();
+    update();
+}
 
-    QFont font("Swis721 BT");
-    qreal scale = painter.device()->logicalDpiY() / 72.0;  // 72 DPI baseline
-    font.setPointSizeF(12 / scale);                        // adjust 12pt
-    painter.setFont(font);
-    painter.setRenderHint(QPainter::Antialiasing, true);
+void LabelPreview::updateFormat()
+{
+    // Same template choice as printing (KEYTAG switches to LABEL.ZPL).
+    LabelJob job;
+    job.style = currentStyle;
+    job.templateName = templateName;
+    job.quantity = quantity;
+    const QString name = job.effectiveTemplate();
+
+    // Static text needs font 0; until it is registered the preview shows
+    // the background and outline only.
+    if (!fontPending && (name != rasterizer.formatName() || printerDpi != rasterizer.dpi())) {
+        rasterizer = ZplRasterizer(printerDpi);
+        rasterizer.loadFormat(name);
+    }
+    updatePreviewSize();
+    updateFallbackFonts();
+    renderLabel();
+    staticLayerDirty = true;
+    emit labelChanged();
+}
 
-    // --- White base box (full widget) ---
-    QRect whiteBoxRect(0, 0, width(), height());
-    painter.fillRect(whiteBoxRect, Qt::white);
+void LabelPreview::renderLabel()
+{
+    if (!rasterizer.isValid()) {
+        labelDots = QImage();
+        labelInk = QImage();
+        return;
+    }
+    labelDots = rasterizer.render(fieldData(), QImage::Format_RGB32);
+    labelInk = QImage(labelDots.size(), QImage::Format_ARGB32_Premultiplied);
+    updateInk(labelDots.rect());
+}
 
-    // --- Draw background centered (do NOT scale - PNG should be 448x418) ---
-    if (!background.isNull()) {
-        int bgX = (width()  - background.width())  / 2;
-        int bgY = (height() - background.height()) / 2;
-        painter.drawPixmap(bgX, bgY, background);
+void LabelPreview::updateInk(const QRect &dots)
+{
+    // Printed dots are black; paper is transparent so the background shows.
+    const QRect r = dots & labelDots.rect();
+    for (int y = r.top(); y <= r.bottom(); ++y) {
+        const QRgb *src = reinterpret_cast<const QRgb *>(labelDots.constScanLine(y));
+        QRgb *dst = reinterpret_cast<QRgb *>(labelInk.scanLine(y));
+        for (int x = r.left(); x <= r.right(); ++x)
+            dst[x] = qGray(src[x]) > 127 ? 0 : 0xff000000;
     }
+}
 
-    // --- Draw 406x406 rounded rectangle (black outline) centered ---
+QRect LabelPreview::labelRect() const
+{
+    // Centered, one widget pixel per 203-dpi dot.
     int labelWidth  = 406;
     int labelHeight = (currentStyle == "KEYTAG") ? 203 : 406;
+    if (rasterizer.isValid()) {
+        const QSize dots = rasterizer.labelSize();
+        labelWidth  = dots.width()  * ZplRasterizer::DefaultDpi / rasterizer.dpi();
+        labelHeight = dots.height() * ZplRasterizer::DefaultDpi / rasterizer.dpi();
+    }
+    return QRect((width() - labelWidth) / 2, (height() - labelHeight) / 2, labelWidth, labelHeight);
+}
+
+QRect LabelPreview::dotsToWidget(const QRect &dots) const
+{
+    const QRect label = labelRect();
+    const qreal scale = qreal(label.width()) / rasterizer.labelSize().width();
+    const QRectF r(label.x() + dots.x() * scale, label.y() + dots.y() * scale,
+                   dots.width() * scale, dots.height() * scale);
+    return r.toAlignedRect().adjusted(-1, -1, 1, 1);
+}
+
+QString *LabelPreview::fieldValue(int fieldNumber)
+{
+    if (currentStyle == "KEYTAG") {
+        switch (fieldNumber) {
+        case 2: return &customer;
+        case 3: return &car;
+        case 4: return &plate;
+        case 5: return &vin;
+        case 6: return &color;
+        case 7: return &repairOrder;
+        }
+        return nullptr;
+    }
+    switch (fieldNumber) {
+    case 2: return &oilType;
+    case 3: return &today;
+    case 4: return &nextMileage;
+    case 5: return &nextDate;
+    }
+    return nullptr;
+}
+
+QHash<int, QString> LabelPreview::fieldData() const
+{
+    // Indexed by ^FN number, as LabelJob fills them.
+    if (currentStyle == "KEYTAG") {
+        return {
+            { 2, customer }, { 3, car }, { 4, plate },
+            { 5, vin }, { 6, color }, { 7, repairOrder },
+        };
+    }
+    return { { 2, oilType }, { 3, today }, { 4, nextMileage }, { 5, nextDate } };
+}
 
-    int labelX = (width()  - labelWidth)  / 2;
-    int labelY = (height() - labelHeight) / 2;
 
-    QRect labelRect(labelX, labelY, labelWidth, labelHeight);
+void LabelPreview::rebuildStaticLayer()
+{
+    // White base, background and label outline change only with the style,
+    // background or screen scale; repaints just blit this.
+    const qreal dpr = devicePixelRatioF();
+    staticLayer = QPixmap(size() * dpr);
+    staticLayer.setDevicePixelRatio(dpr);
+    staticLayer.fill(Qt::white);
+
+    QPainter painter(&staticLayer);
+    painter.setRenderHint(QPainter::Antialiasing, true);
 
+    // --- Draw background centered (do NOT scale - PNG should be 448x418) ---
+    if (!background.isNull()) {
+        int bgX = (width()  - background.width())  / 2;
+        int bgY = (height() - background.height()) / 2;
+        painter.drawImage(bgX, bgY, background);
+    }
 
-    QPainterPath borderPath;
-    borderPath.addRoundedRect(labelRect, 20, 20);
+    labelOutline = QPainterPath();
+    labelOutline.addRoundedRect(labelRect(), 20, 20);
 
     QPen borderPen(Qt::black);
     borderPen.setWidth(2);
     painter.setPen(borderPen);
     painter.setBrush(Qt::NoBrush);
-    painter.drawPath(borderPath);
+    painter.drawPath(labelOutline);
+
+    staticLayerDirty = false;
+}
+
+void LabelPreview::paintEvent(QPaintEvent *)
+{
+    const qreal dpr = devicePixelRatioF();
+    if (staticLayerDirty || staticLayer.devicePixelRatio() != dpr || staticLayer.size() != size() * dpr)
+        rebuildStaticLayer();
+
+    // Qt clips to the update region, so a field edit only blits the
+    // rectangles updatePreview() marked dirty.
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, staticLayer);
+
+    const QRect label = labelRect();
+    if (!labelInk.isNull()) {
+        // The template as the printer would print it.
+        if (labelInk.size() == label.size())
+            painter.drawImage(label.topLeft(), labelInk);
+        else
+            painter.drawImage(label, labelInk);
+        return;
+    }
+
+    // Draw clipped content inside rounded rectangle
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setClipPath(labelOutline);
+    paintTextFallback(painter, label);
+}
 
+void LabelPreview::updateFallbackFonts()
+{
     // --- Prepare fonts (fallback to Arial) ---
     QString fontFamily = zebraFontFamily.isEmpty() ? "Arial" : zebraFontFamily;
 
-    // --- Defaults ---
     int smallPoint;
     int largePoint;
-    int smallYOffset = 285;
-    int largeYOffset = 365;
 
     // --- Platform-specific font sizes ---
     #if defined(Q_OS_MACOS)
@@ -163,6 +382,42 @@ void LabelPreview::paintEvent(QPaintEvent *)
         smallPoint = 15;
         largePoint = 112;
     #endif
+    }
+
+    smallFont = QFont(fontFamily, smallPoint);
+    largeFont = QFont(fontFamily, largePoint);
+    smallLineHeight = QFontMetrics(smallFont).height() + 2;
+}
+
+const LabelPreview::FieldText &LabelPreview::fieldText(int fieldNumber, const QString &text, const QFont &font)
+{
+    FieldText &field = fieldTexts[fieldNumber];
+    if (field.text != text || field.font != font) {
+        field.text = text;
+        field.font = font;
+        field.layout.setText(text);
+        field.layout.setTextFormat(Qt::PlainText);
+        field.layout.prepare(QTransform(), font);
+        const QFontMetrics fm(font);
+        field.ascent = fm.ascent();
+        field.width = qCeil(field.layout.size().width());
+    }
+    return field;
+}
+
+void LabelPreview::drawFieldText(QPainter &painter, const FieldText &field, int x, int baseline)
+{
+    painter.drawStaticText(x, baseline - field.ascent, field.layout);
+}
+
+void LabelPreview::paintTextFallback(QPainter &painter, const QRect &labelRect)
+{
+    // --- Defaults ---
+    int smallYOffset = 285;
+    int largeYOffset = 365;
+
+    // --- Style overrides ---
+    if (currentStyle == "KEYTAG") {
         smallYOffset = 260;
         largeYOffset = 360;
     }
@@ -172,100 +427,58 @@ void LabelPreview::paintEvent(QPaintEvent *)
     smallYOffset += globalShiftUp;
     largeYOffset += globalShiftUp;
 
-    // Draw clipped content inside rounded rectangle
-    painter.save();
-    painter.setClipPath(borderPath);
-
     int padding = 25;
     int smallTextY = labelRect.top() + smallYOffset * labelRect.height() / 406;
     int largeTextY = labelRect.top() + largeYOffset * labelRect.height() / 406;
 
-    // SMALL font (oil type / date or keytag small fields)
-    QFont smallFont(fontFamily, smallPoint);
+    // SMALL font (oil type / date or keytag small fields). Layouts come
+    // from fieldTexts, so an unchanged field is not shaped or measured again.
     painter.setFont(smallFont);
     painter.setPen(Qt::black);
 
     if (currentStyle == "DEFAULT") {
         if (!oilType.isEmpty()) {
-            painter.drawText(labelRect.left() + padding, smallTextY, oilType);
+            drawFieldText(painter, fieldText(2, oilType, smallFont), labelRect.left() + padding, smallTextY);
         }
         if (!today.isEmpty()) {
-            int tw = painter.fontMetrics().horizontalAdvance(today);
-            painter.drawText(labelRect.right() - padding - tw, smallTextY, today);
+            const FieldText &t = fieldText(3, today, smallFont);
+            drawFieldText(painter, t, labelRect.right() - padding - t.width, smallTextY);
         }
     } else { // KEYTAG: show a compact set of keytag fields near top-left
         int y = labelRect.top() + 25;
-        const int lineH = painter.fontMetrics().height() + 2;
-        if (!customer.isEmpty()) { painter.drawText(labelRect.left() + padding, y, customer); y += lineH; }
-        if (!car.isEmpty())      { painter.drawText(labelRect.left() + padding, y, car);      y += lineH; }
-        if (!plate.isEmpty())    { painter.drawText(labelRect.left() + padding, y, plate);    y += lineH; }
-        if (!vin.isEmpty())      { painter.drawText(labelRect.left() + padding, y, vin);      y += lineH; }
-        if (!color.isEmpty())    { painter.drawText(labelRect.left() + padding, y, color);    y += lineH; }
-        if (!repairOrder.isEmpty())    { painter.drawText(labelRect.left() + padding, y, repairOrder);    y += lineH; }
-
-/*
-if (quantity > 1) {
-    painter.save();
-
-    // Move origin to start a new block below the top section
-    int offsetY = labelRect.top() + 25 + (painter.fontMetrics().height() + 2) * 6 + 10; 
-    // 6 lines of text + 10px spacing between top and bottom copy
-
-    int y2 = offsetY;
-    const int lineH2 = painter.fontMetrics().height() + 2;
-
-    if (!customer.isEmpty()) {
-        painter.drawText(labelRect.left() + padding, y2, customer);
-        y2 += lineH2;
-    }
-    if (!car.isEmpty()) {
-        painter.drawText(labelRect.left() + padding, y2, car);
-        y2 += lineH2;
-    }
-    if (!plate.isEmpty()) {
-        painter.drawText(labelRect.left() + padding, y2, plate);
-        y2 += lineH2;
-    }
-    if (!vin.isEmpty()) {
-        painter.drawText(labelRect.left() + padding, y2, vin);
-        y2 += lineH2;
-    }
-    if (!color.isEmpty()) {
-        painter.drawText(labelRect.left() + padding, y2, color);
-        y2 += lineH2;
-    }
-    if (!repairOrder.isEmpty()) {
-        painter.drawText(labelRect.left() + padding, y2, repairOrder);
-        y2 += lineH2;
-    }
-
-    painter.restore();
-}
-*/
-
+        const int lineH = smallLineHeight;
+        const QString *lines[] = { &customer, &car, &plate, &vin, &color, &repairOrder };
+        for (int i = 0; i < 6; ++i) {
+            if (lines[i]->isEmpty())
+                continue;
+            drawFieldText(painter, fieldText(2 + i, *lines[i], smallFont), labelRect.left() + padding, y);
+            y += lineH;
+        }
     }
 
     // LARGE font (mileage / nextDate or repairOrder for keytag)
-    QFont largeFont(fontFamily, largePoint);
     painter.setFont(largeFont);
 
     if (currentStyle == "DEFAULT") {
         if (!nextMileage.isEmpty()) {
-            painter.drawText(labelRect.left() + padding, largeTextY, nextMileage);
+            drawFieldText(painter, fieldText(4, nextMileage, largeFont), labelRect.left() + padding, largeTextY);
         }
         if (!nextDate.isEmpty()) {
-            int tw = painter.fontMetrics().horizontalAdvance(nextDate);
-            painter.drawText(labelRect.right() - padding - tw, largeTextY, nextDate);
+            const FieldText &t = fieldText(5, nextDate, largeFont);
+            drawFieldText(painter, t, labelRect.right() - padding - t.width, largeTextY);
         }
-    } 
+    }
 
-    painter.restore();
 }
 
 // Set Quantitiy
 void LabelPreview::setQuantity(int q)
 {
-    quantity = q > 0 ? q : 1;
+    q = q > 0 ? q : 1;
+    if (q == quantity)
+        return;
+    quantity = q;
+    updateFormat();
     update();
 }
 
@@ -284,52 +497,11 @@ void LabelPreview::updatePreviewSize()
 
     int h = (currentStyle == "KEYTAG") ? ((418 + pad) / 2) : 418;
 
+    // A rasterized template is shown whole (the key tag format uses the
+    // full 2" x 2" label).
+    if (rasterizer.isValid())
+        h = rasterizer.labelSize().height() * ZplRasterizer::DefaultDpi / rasterizer.dpi() + 12;
+
     setMinimumSize(w, h);
     setMaximumSize(w, h);
 }
-
-
-/* --- Helpers --- */
-
-QPixmap LabelPreview::tryLoadPixmap(const QString &path) const
-{
-    if (path.isEmpty()) return QPixmap();
-
-    if (path.startsWith(":/")) {
-        QPixmap p(path);
-        if (!p.isNull()) return p;
-        return QPixmap();
-    }
-
-    if (QFile::exists(path)) {
-        QPixmap p(path);
-        if (!p.isNull()) return p;
-    }
-    return QPixmap();
-}
-
-QPixmap LabelPreview::loadWithFallback(const QString &path) const
-{
-    // 1) exact path
-    QPixmap p = tryLoadPixmap(path);
-    if (!p.isNull()) return p;
-
-    // 2) try app bundle Resources/<basename>
-    QFileInfo fi(path);
-    QString baseName = fi.fileName();
-    if (!baseName.isEmpty()) {
-        QString appDir = QCoreApplication::applicationDirPath();
-        QString bundleResources = QDir(appDir).filePath("resources/" + baseName);
-        if (QFile::exists(bundleResources)) {
-            QPixmap p2(bundleResources);
-            if (!p2.isNull()) return p2;
-        }
-    }
-
-    // 3) embedded default resource
-    QString embedded = ":/resources/default.png";
-    QPixmap p3(embedded);
-    if (!p3.isNull()) return p3;
-
-    return QPixmap();
-}
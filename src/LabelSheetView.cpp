@@ -0,0 +1,135 @@
+// src/LabelSheetView.cpp
+#include "LabelSheetView.hpp"
+#include "LabelPreview.hpp"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QTimer>
+
+LabelSheetView::LabelSheetView(LabelPreview *source, QWidget *parent)
+    : QAbstractScrollArea(parent),
+      source(source),
+      tileTimer(new QTimer(this))
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setFixedHeight(Gap + TileSize + CaptionHeight + Gap + horizontalScrollBar()->sizeHint().height()
+                   + 2 * frameWidth());
+    horizontalScrollBar()->setSingleStep((TileSize + Gap) / 4);
+
+    tileTimer->setSingleShot(true);
+    connect(tileTimer, &QTimer::timeout, this, &LabelSheetView::rebuildTile);
+    connect(source, &LabelPreview::labelChanged, this, &LabelSheetView::invalidateTile);
+    invalidateTile();
+}
+
+void LabelSheetView::setQuantity(int tags)
+{
+    tags = qBound(1, tags, 99);
+    if (tags == quantity)
+        return;
+    quantity = tags;
+    updateScrollBar();
+    viewport()->update();
+}
+
+void LabelSheetView::invalidateTile()
+{
+    // The preview may change several times before the next frame; grab
+    // once. A hidden sheet waits for showEvent().
+    tileDirty = true;
+    if (isVisible() && !tileTimer->isActive())
+        tileTimer->start(0);
+}
+
+void LabelSheetView::rebuildTile()
+{
+    if (!tileDirty || !isVisible())
+        return;
+    tileDirty = false;
+
+    const qreal dpr = devicePixelRatioF();
+    const QPixmap label = source->grab(source->labelRect());
+    const QSize size = label.size().scaled(TileSize, TileSize, Qt::KeepAspectRatio);
+
+    tile = QPixmap(size * dpr);
+    tile.setDevicePixelRatio(dpr);
+    tile.fill(Qt::white);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.drawPixmap(QRect(QPoint(0, 0), size), label);
+
+    // LABEL.ZPL carries two tags; the label is cut across the middle.
+    QPen cut(Qt::gray, 1, Qt::DashLine);
+    painter.setPen(cut);
+    painter.drawLine(0, size.height() / 2, size.width(), size.height() / 2);
+    painter.end();
+
+    updateScrollBar();
+    viewport()->update();
+}
+
+void LabelSheetView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().window());
+    if (tile.isNull())
+        return;
+
+    const int width = tileWidth();
+    const int height = qRound(tile.height() / tile.devicePixelRatio());
+    const int stride = width + Gap;
+    const int offset = horizontalScrollBar()->value();
+
+    // Only the labels that intersect the exposed area.
+    const int first = qMax(0, (offset + event->rect().left() - Gap) / stride);
+    const int last = qMin(labelCount() - 1, (offset + event->rect().right()) / stride);
+
+    for (int i = first; i <= last; ++i) {
+        const int x = Gap + i * stride - offset;
+        painter.drawPixmap(x, Gap, tile);
+        painter.setPen(Qt::black);
+        painter.drawRect(QRect(x, Gap, width, height).adjusted(0, 0, -1, -1));
+        painter.drawText(QRect(x, Gap + height, width, CaptionHeight),
+                         Qt::AlignCenter, caption(i));
+    }
+}
+
+void LabelSheetView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBar();
+}
+
+void LabelSheetView::showEvent(QShowEvent *event)
+{
+    QAbstractScrollArea::showEvent(event);
+    if (tileDirty)
+        tileTimer->start(0);
+}
+
+int LabelSheetView::tileWidth() const
+{
+    return tile.isNull() ? TileSize : qRound(tile.width() / tile.devicePixelRatio());
+}
+
+void LabelSheetView::updateScrollBar()
+{
+    const int stride = tileWidth() + Gap;
+    const int total = Gap + labelCount() * stride;
+    QScrollBar *bar = horizontalScrollBar();
+    bar->setRange(0, qMax(0, total - viewport()->width()));
+    bar->setPageStep(viewport()->width());
+}
+
+QString LabelSheetView::caption(int label) const
+{
+    // "3 of 5: tags 5-6"; an odd quantity leaves a spare last tag.
+    const int firstTag = 2 * label + 1;
+    const QString count = QString("%1 of %2").arg(label + 1).arg(labelCount());
+    if (firstTag + 1 > quantity)
+        return count + QString(": tag %1 + spare").arg(firstTag);
+    return count + QString(": tags %1-%2").arg(firstTag).arg(firstTag + 1);
+}
@@ -0,0 +1,336 @@
+// src/LoadGenerator.cpp
+#include "LoadGenerator.hpp"
+#include "MockPrinter.hpp"
+#include "PrintJournal.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// Nearest-rank percentile of sorted 'values'.
+double percentile(const QList<double> &values, double p)
+{
+    if (values.isEmpty())
+        return 0;
+    const int rank = qBound(0, int(std::ceil(p * values.size())) - 1, int(values.size()) - 1);
+    return values.at(rank);
+}
+
+} // namespace
+
+LoadGenerator::LoadGenerator(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool LoadGenerator::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]) == "--load-test")
+            return true;
+    }
+    return false;
+}
+
+int LoadGenerator::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Replay recorded print jobs through the print queue and measure throughput\n"
+        "and latency. Add --mock to print to an in-process MockPrinter.");
+    parser.addHelpOption();
+
+    QCommandLineOption loadOpt("load-test", "Run the load generator.");
+    QCommandLineOption replayOpt("replay", "Print journal (default: the app's) or MockPrinter jobs.log.", "file");
+    QCommandLineOption printerOpt("printer", "Target printer (default 127.0.0.1:9100, or :8631 for IPP).", "name");
+    QCommandLineOption protocolOpt("protocol", "raw, ipp or spooler (a CUPS queue; default raw).", "protocol");
+    QCommandLineOption speedOpt("speed", "Replay at <n> times the recorded pace; 0 = back to back (default 1).", "n");
+    QCommandLineOption loopsOpt("loops", "Replay the log <n> times (default 1).", "n");
+    QCommandLineOption limitOpt("limit", "Send at most <n> jobs.", "n");
+    QCommandLineOption jsonOpt("json", "Also write the results to <file>.", "file");
+    QCommandLineOption mockOpt("mock", "Start a MockPrinter in this process (see --mock-printer --help).");
+    parser.addOptions({ loadOpt, replayOpt, printerOpt, protocolOpt, speedOpt, loopsOpt, limitOpt, jsonOpt, mockOpt });
+    parser.addOptions(MockPrinter::commandLineOptions());
+
+    if (!parser.parse(arguments)) {
+        err() << parser.errorText() << "\n";
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        out() << parser.helpText();
+        return 0;
+    }
+
+    // -----------------------------
+    // Target
+    // -----------------------------
+    const QString protocol = parser.value(protocolOpt).toLower();
+    PrintTransport transport = PrintTransport::Raw;
+    if (protocol == "ipp")
+        transport = PrintTransport::Ipp;
+    else if (protocol == "spooler")
+        transport = PrintTransport::Spooler;
+    else if (!protocol.isEmpty() && protocol != "raw") {
+        err() << "--protocol must be raw, ipp or spooler.\n";
+        return ExitUsage;
+    }
+
+    MockPrinter::Options mockOptions;
+    QString error;
+    if (!MockPrinter::optionsFromParser(parser, &mockOptions, &error)) {
+        err() << error << "\n";
+        return ExitUsage;
+    }
+
+    QString printer = parser.value(printerOpt);
+    if (printer.isEmpty()) {
+        if (transport == PrintTransport::Spooler) {
+            err() << "--protocol spooler needs --printer <CUPS queue>.\n";
+            return ExitUsage;
+        }
+        printer = QString("%1:%2").arg(mockOptions.address.toString())
+                      .arg(transport == PrintTransport::Ipp ? mockOptions.ippPort : mockOptions.rawPort);
+    }
+
+    bool ok;
+    const double speed = parser.isSet(speedOpt) ? parser.value(speedOpt).toDouble(&ok) : 1.0;
+    if (parser.isSet(speedOpt) && (!ok || speed < 0)) {
+        err() << "--speed needs a number >= 0.\n";
+        return ExitUsage;
+    }
+    const int loops = parser.isSet(loopsOpt) ? parser.value(loopsOpt).toInt() : 1;
+    const int limit = parser.isSet(limitOpt) ? parser.value(limitOpt).toInt() : 0;
+    if (loops < 1 || limit < 0) {
+        err() << "--loops and --limit need a positive number.\n";
+        return ExitUsage;
+    }
+
+    // -----------------------------
+    // Jobs
+    // -----------------------------
+    const QString path = parser.isSet(replayOpt) ? parser.value(replayOpt) : PrintJournal::defaultPath();
+    QList<Job> log;
+    const bool read = path.endsWith(".log", Qt::CaseInsensitive)
+        ? readMockLog(path, &log, &error) : readJournal(path, &log, &error);
+    if (!read) {
+        err() << error << "\n";
+        return ExitUsage;
+    }
+    if (log.isEmpty()) {
+        err() << "No jobs in " << path << "\n";
+        return ExitUsage;
+    }
+
+    // Each loop starts one average gap after the last job of the previous one.
+    QList<Job> jobs;
+    const qint64 span = log.last().offsetMs + (log.size() > 1 ? log.last().offsetMs / (log.size() - 1) : 0);
+    for (int loop = 0; loop < loops; ++loop) {
+        for (const Job &job : std::as_const(log)) {
+            if (limit > 0 && jobs.size() >= limit)
+                break;
+            jobs << Job{ job.offsetMs + loop * span, job.data };
+        }
+    }
+
+    MockPrinter *mock = nullptr;
+    if (parser.isSet(mockOpt)) {
+        mock = new MockPrinter(mockOptions, this);
+        if (!mock->start(&error)) {
+            err() << error << "\n";
+            return ExitUsage;
+        }
+    }
+
+    out() << QString("Replaying %1 job(s) from %2 to %3 (%4) at %5\n")
+                 .arg(jobs.size()).arg(QDir::toNativeSeparators(path), printer,
+                                       protocol.isEmpty() ? QString("raw") : protocol,
+                                       speed > 0 ? QString("%1x").arg(speed) : QString("full speed"));
+    out().flush();
+
+    int failed = 0;
+    const QList<BenchmarkResult> results = replay(jobs, printer, transport, speed, &failed);
+    for (const BenchmarkResult &r : results)
+        out() << QString("  %1 %2 %3\n").arg(r.label.leftJustified(24)).arg(r.value, 0, 'f', 1).arg(r.unit);
+    if (mock) {
+        // Raw jobs are closed by the mock's idle timer; let the last one land.
+        QEventLoop settle;
+        QTimer::singleShot(MockPrinter::IdleFlushMs + mockOptions.latencyMs + 100, &settle, &QEventLoop::quit);
+        settle.exec();
+        out() << QString("  Mock printer received %1 job(s), %2 label(s)\n").arg(mock->jobCount()).arg(mock->labelCount());
+    }
+    out().flush();
+
+    if (parser.isSet(jsonOpt)) {
+        QJsonArray benchmarks;
+        for (const BenchmarkResult &r : results) {
+            benchmarks.append(QJsonObject{
+                { "name", r.name }, { "value", r.value }, { "unit", r.unit },
+                { "higherIsBetter", r.higherIsBetter },
+            });
+        }
+        const QJsonObject root{
+            { "time", QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+            { "printer", printer },
+            { "protocol", protocol.isEmpty() ? QString("raw") : protocol },
+            { "speed", speed },
+            { "ok", failed == 0 },
+            { "benchmarks", benchmarks },
+        };
+        QFile file(parser.value(jsonOpt));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err() << "Cannot write " << file.fileName() << "\n";
+            return ExitFailed;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    return failed == 0 ? 0 : ExitFailed;
+}
+
+QList<BenchmarkResult> LoadGenerator::replay(const QList<Job> &jobs, const QString &printer,
+                                             PrintTransport transport, double speed, int *failed)
+{
+    PrintQueue queue;
+    QHash<quint64, qint64> sentAtNs;
+    QList<double> latencies;   // ms
+    qint64 bytes = 0;
+    int maxDepth = 0;
+    int next = 0;
+    *failed = 0;
+
+    QElapsedTimer clock;
+    QEventLoop loop;
+    QTimer pacer;
+    pacer.setSingleShot(true);
+
+    connect(&queue, &PrintQueue::depthChanged, &loop, [&](const QString &, int depth) {
+        maxDepth = qMax(maxDepth, depth);
+    });
+    connect(&queue, &PrintQueue::jobFinished, &loop,
+        [&](quint64 id, const QString &, bool ok, const QString &message) {
+            const qint64 sent = sentAtNs.take(id);
+            latencies << (clock.nsecsElapsed() - sent) / 1e6;
+            if (!ok) {
+                ++*failed;
+                err() << "  job failed: " << message << "\n";
+            }
+            if (next == jobs.size() && sentAtNs.isEmpty())
+                loop.quit();
+        });
+
+    // Enqueue everything that is due, then sleep until the next one.
+    auto sendDue = [&]() {
+        const qint64 now = clock.elapsed();
+        while (next < jobs.size()) {
+            const qint64 due = speed > 0 ? qint64(jobs.at(next).offsetMs / speed) : 0;
+            if (due > now) {
+                pacer.start(int(due - now));
+                return;
+            }
+            const quint64 id = queue.enqueue(printer, jobs.at(next).data, transport);
+            sentAtNs.insert(id, clock.nsecsElapsed());
+            bytes += jobs.at(next).data.size();
+            ++next;
+        }
+    };
+    connect(&pacer, &QTimer::timeout, &loop, sendDue);
+
+    clock.start();
+    sendDue();
+    loop.exec();
+    const double seconds = qMax(1e-9, clock.nsecsElapsed() / 1e9);
+
+    std::sort(latencies.begin(), latencies.end());
+    return {
+        { "load.jobs", "Throughput", jobs.size() / seconds, "jobs/s", true },
+        { "load.bytes", "Bytes", bytes / 1024.0 / seconds, "KB/s", true },
+        { "load.latency.p50", "Latency p50", percentile(latencies, 0.50), "ms", false },
+        { "load.latency.p95", "Latency p95", percentile(latencies, 0.95), "ms", false },
+        { "load.latency.max", "Latency max", latencies.isEmpty() ? 0 : latencies.last(), "ms", false },
+        { "load.depth.max", "Deepest queue", double(maxDepth), "jobs", false },
+        { "load.failed", "Failed", double(*failed), "jobs", false },
+    };
+}
+
+//
+// Job logs
+//
+bool LoadGenerator::readJournal(const QString &path, QList<Job> *jobs, QString *error)
+{
+    // The running GUI holds the journal's lock; read a copy.
+    QTemporaryDir dir;
+    const QString copy = dir.filePath("print-journal.bin");
+    if (!dir.isValid() || !QFile::copy(path, copy)) {
+        *error = QString("Cannot read %1").arg(path);
+        return false;
+    }
+
+    PrintJournal journal;
+    if (!journal.open(copy, error))
+        return false;
+
+    QList<JournalEntry> entries = journal.recent(journal.count());
+    std::reverse(entries.begin(), entries.end());
+    for (const JournalEntry &e : std::as_const(entries)) {
+        const qint64 offset = entries.first().time.msecsTo(e.time);
+        jobs->append(Job{ qMax<qint64>(0, offset), e.zpl });
+    }
+    return true;
+}
+
+bool LoadGenerator::readMockLog(const QString &path, QList<Job> *jobs, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = QString("Cannot read %1").arg(path);
+        return false;
+    }
+
+    // msecs since epoch, transport, peer, bytes, labels, file
+    const QDir dir = QFileInfo(path).absoluteDir();
+    qint64 first = -1;
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().trimmed().split('\t');
+        if (fields.size() < 6)
+            continue;
+        QFile data(dir.filePath(QString::fromUtf8(fields.at(5))));
+        if (!data.open(QIODevice::ReadOnly)) {
+            *error = QString("Cannot read %1").arg(data.fileName());
+            return false;
+        }
+        const qint64 msecs = fields.at(0).toLongLong();
+        if (first < 0)
+            first = msecs;
+        jobs->append(Job{ qMax<qint64>(0, msecs - first), data.readAll() });
+    }
+    return true;
+}
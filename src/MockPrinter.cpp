@@ -0,0 +1,841 @@
+// src/MockPrinter.cpp
+#include "MockPrinter.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <cstring>
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// RFC 8010 tags the mock answers with
+enum Tag : quint8 {
+    OperationAttributesTag = 0x01,
+    JobAttributesTag       = 0x02,
+    EndOfAttributesTag     = 0x03,
+    PrinterAttributesTag   = 0x04,
+    TagInteger             = 0x21,
+    TagBoolean             = 0x22,
+    TagEnum                = 0x23,
+    TagText                = 0x41,
+    TagKeyword             = 0x44,
+    TagCharset             = 0x47,
+    TagNaturalLanguage     = 0x48,
+    TagMimeMediaType       = 0x49
+};
+
+enum IppOperation : quint16 {
+    OpPrintJob             = 0x0002,
+    OpGetJobAttributes     = 0x0009,
+    OpGetPrinterAttributes = 0x000B
+};
+
+enum IppStatus : quint16 {
+    SuccessfulOk                 = 0x0000,
+    ClientErrorBadRequest        = 0x0400,
+    ClientErrorNotFound          = 0x0406,
+    ServerErrorOperationNotSupported = 0x0501
+};
+
+void put16(QByteArray &out, quint16 v)
+{
+    out.append(char(v >> 8));
+    out.append(char(v & 0xff));
+}
+
+void put32(QByteArray &out, quint32 v)
+{
+    put16(out, quint16(v >> 16));
+    put16(out, quint16(v & 0xffff));
+}
+
+quint16 get16(const uchar *p)
+{
+    return quint16((p[0] << 8) | p[1]);
+}
+
+quint32 get32(const uchar *p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+void putString(QByteArray &out, quint8 tag, const QByteArray &name, const QByteArray &value)
+{
+    out.append(char(tag));
+    put16(out, quint16(name.size()));
+    out.append(name);
+    put16(out, quint16(value.size()));
+    out.append(value);
+}
+
+void putInteger(QByteArray &out, quint8 tag, const QByteArray &name, qint32 value)
+{
+    out.append(char(tag));
+    put16(out, quint16(name.size()));
+    out.append(name);
+    put16(out, 4);
+    put32(out, quint32(value));
+}
+
+// One STX...ETX string of a ~HS / ~HI reply.
+QByteArray framed(const QByteArray &text)
+{
+    return '\x02' + text + "\x03\r\n";
+}
+
+// An HTTP/1.1 request with its body, taken off the front of 'buffer'.
+// False until the whole request has arrived.
+bool takeHttpRequest(QByteArray &buffer, QByteArray *body, bool *close, bool *expectContinue)
+{
+    const int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+        return false;
+
+    qint64 length = 0;
+    bool chunked = false;
+    *close = false;
+    *expectContinue = false;
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    if (lines.value(0).contains("HTTP/1.0"))
+        *close = true;
+    for (const QByteArray &raw : lines.mid(1)) {
+        const QByteArray line = raw.trimmed();
+        const int colon = line.indexOf(':');
+        if (colon < 0)
+            continue;
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed().toLower();
+        if (name == "content-length")
+            length = value.toLongLong();
+        else if (name == "transfer-encoding")
+            chunked = value.contains("chunked");
+        else if (name == "connection")
+            *close = value.contains("close");
+        else if (name == "expect")
+            *expectContinue = value.contains("100-continue");
+    }
+
+    int pos = headerEnd + 4;
+    if (!chunked) {
+        if (buffer.size() < pos + length)
+            return false;
+        *body = buffer.mid(pos, length);
+        buffer.remove(0, int(pos + length));
+        return true;
+    }
+
+    // <hex size>\r\n<data>\r\n ... 0\r\n\r\n
+    QByteArray data;
+    while (true) {
+        const int lineEnd = buffer.indexOf("\r\n", pos);
+        if (lineEnd < 0)
+            return false;
+        bool ok;
+        const int size = buffer.mid(pos, lineEnd - pos).split(';').first().trimmed().toInt(&ok, 16);
+        if (!ok)
+            return false;
+        pos = lineEnd + 2;
+        if (size == 0) {
+            const int trailerEnd = buffer.indexOf("\r\n", pos);
+            if (trailerEnd < 0)
+                return false;
+            pos = trailerEnd + 2;
+            break;
+        }
+        if (buffer.size() < pos + size + 2)
+            return false;
+        data += buffer.mid(pos, size);
+        pos += size + 2;
+    }
+    *body = data;
+    buffer.remove(0, pos);
+    return true;
+}
+
+} // namespace
+
+MockPrinter::MockPrinter(const Options &options, QObject *parent)
+    : QObject(parent),
+      options(options)
+{
+    clock.start();
+}
+
+MockPrinter::~MockPrinter()
+{
+    // Whatever raw data is still waiting for its idle flush.
+    for (auto it = raw.begin(); it != raw.end(); ++it) {
+        if (!it->job.isEmpty())
+            recordJob("raw", it.key()->peerAddress().toString(), it->job, it->labels);
+    }
+}
+
+bool MockPrinter::start(QString *error)
+{
+    if (!QDir().mkpath(options.outputDir)) {
+        *error = QString("Cannot create %1").arg(options.outputDir);
+        return false;
+    }
+    outputDir = QDir(options.outputDir);
+
+    auto listen = [&](QTcpServer **server, quint16 port, const char *name, void (MockPrinter::*accept)()) {
+        if (port == 0)
+            return true;
+        *server = new QTcpServer(this);
+        if (!(*server)->listen(options.address, port)) {
+            *error = QString("Cannot listen for %1 on %2:%3: %4")
+                         .arg(QString::fromLatin1(name), options.address.toString())
+                         .arg(port).arg((*server)->errorString());
+            return false;
+        }
+        connect(*server, &QTcpServer::newConnection, this, accept);
+        return true;
+    };
+    return listen(&rawServer, options.rawPort, "raw ZPL", &MockPrinter::acceptRaw)
+        && listen(&ippServer, options.ippPort, "IPP", &MockPrinter::acceptIpp)
+        && listen(&lpdServer, options.lpdPort, "LPD", &MockPrinter::acceptLpd);
+}
+
+bool MockPrinter::isPaperOut() const
+{
+    return clock.elapsed() < paperOutUntil;
+}
+
+qint64 MockPrinter::stallRemaining() const
+{
+    return qMax<qint64>(0, stallUntil - clock.elapsed());
+}
+
+bool MockPrinter::dropConnection(QTcpSocket *socket)
+{
+    if (options.dropRate <= 0 || QRandomGenerator::global()->generateDouble() >= options.dropRate)
+        return false;
+    socket->abort();
+    socket->deleteLater();
+    return true;
+}
+
+void MockPrinter::reply(QTcpSocket *socket, const QByteArray &data)
+{
+    if (options.latencyMs <= 0) {
+        socket->write(data);
+        return;
+    }
+    QTimer::singleShot(options.latencyMs, socket, [socket, data]() { socket->write(data); });
+}
+
+void MockPrinter::recordJob(const QString &transport, const QString &peer, const QByteArray &data, int labelCount)
+{
+    ++jobs;
+    const QString name = QString("%1-%2.zpl").arg(jobs, 6, 10, QChar('0')).arg(transport);
+    QFile file(outputDir.filePath(name));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(data);
+    else
+        err() << "Cannot write " << file.fileName() << "\n";
+
+    // msecs since epoch, transport, peer, bytes, labels, file
+    QFile log(outputDir.filePath("jobs.log"));
+    if (log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        log.write(QString("%1\t%2\t%3\t%4\t%5\t%6\n")
+                      .arg(QDateTime::currentMSecsSinceEpoch()).arg(transport, peer)
+                      .arg(data.size()).arg(labelCount).arg(name).toUtf8());
+    }
+
+    if (options.stallEvery > 0 && jobs % options.stallEvery == 0) {
+        stallUntil = clock.elapsed() + options.stallMs;
+        out() << QString("stall: not reading for %1 ms\n").arg(options.stallMs);
+    }
+    if (options.paperOutEvery > 0
+        && (labels + labelCount) / options.paperOutEvery > labels / options.paperOutEvery) {
+        paperOutUntil = clock.elapsed() + options.paperOutMs;
+        out() << QString("paper out for %1 ms\n").arg(options.paperOutMs);
+    }
+    labels += labelCount;
+
+    out() << QString("%1 %2 from %3: %4 bytes, %5 label(s)\n")
+                 .arg(name, transport, peer).arg(data.size()).arg(labelCount);
+    out().flush();
+    emit jobReceived(transport, file.fileName(), int(data.size()), labelCount);
+}
+
+int MockPrinter::countLabels(const QByteArray &data)
+{
+    static const QRegularExpression pq(R"(\^PQ(\d+))");
+
+    int count = 0;
+    int pos = 0;
+    while (true) {
+        const int start = data.indexOf("^XA", pos);
+        if (start < 0)
+            break;
+        const int end = data.indexOf("^XZ", start);
+        if (end < 0)
+            break;
+        const QByteArray block = data.mid(start, end - start);
+        pos = end + 3;
+        if (block.contains("^DF") || block.contains("^HW") || block.contains("^HF"))
+            continue;
+        const QRegularExpressionMatch m = pq.match(QString::fromLatin1(block));
+        count += m.hasMatch() ? qMax(1, m.captured(1).toInt()) : 1;
+    }
+    return count;
+}
+
+//
+// Raw ZPL (9100)
+//
+void MockPrinter::acceptRaw()
+{
+    while (QTcpSocket *socket = rawServer->nextPendingConnection()) {
+        if (dropConnection(socket))
+            continue;
+        raw.insert(socket, RawConnection());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRaw(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            readRaw(socket);
+            flushRaw(socket);
+            raw.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockPrinter::readRaw(QTcpSocket *socket)
+{
+    if (!raw.contains(socket))
+        return;
+    if (qint64 wait = stallRemaining()) {
+        QTimer::singleShot(int(wait), socket, [this, socket]() { readRaw(socket); });
+        return;
+    }
+
+    RawConnection &c = raw[socket];
+    c.buffer += socket->readAll();
+    const int labelsBefore = c.labels;
+
+    while (!c.buffer.isEmpty()) {
+        QByteArray &b = c.buffer;
+        if (b.startsWith("~HQES")) {
+            reply(socket, extendedStatus());
+            b.remove(0, 5);
+        } else if (b.startsWith("~HS")) {
+            reply(socket, hostStatus());
+            b.remove(0, 3);
+        } else if (b.startsWith("~HI")) {
+            reply(socket, framed("ZD420-203dpi,V84.20.18Z,8,8192KB (mock)"));
+            b.remove(0, 3);
+        } else if (b.startsWith("~DG")) {
+            // ~DG<drive>:<name>,<total>,<row bytes>,<data> up to the line end
+            const int end = b.indexOf('\n');
+            if (end < 0)
+                break;
+            const QByteArray command = b.left(end + 1);
+            const QString name = QString::fromLatin1(command.mid(3, command.indexOf(',') - 3));
+            stored.insert(name.section(':', -1).trimmed().toUpper(), command);
+            b.remove(0, end + 1);
+        } else if (b.startsWith("^XA")) {
+            const int end = b.indexOf("^XZ");
+            if (end < 0)
+                break;
+            const QByteArray block = b.left(end + 3);
+            b.remove(0, end + 3);
+            const QByteArray answer = handleBlock(block, c);
+            if (!answer.isEmpty())
+                reply(socket, answer);
+        } else {
+            // Line breaks and anything we do not model, up to the next command.
+            int next = 1;
+            while (next < b.size() && b.at(next) != '^' && b.at(next) != '~')
+                ++next;
+            b.remove(0, next);
+        }
+    }
+
+    if (c.labels != labelsBefore) {
+        // A pause ends the job (the transport keeps its connection open).
+        QTimer *idle = socket->findChild<QTimer *>("idleFlush");
+        if (!idle) {
+            idle = new QTimer(socket);
+            idle->setObjectName("idleFlush");
+            idle->setSingleShot(true);
+            idle->setInterval(IdleFlushMs);
+            connect(idle, &QTimer::timeout, this, [this, socket]() { flushRaw(socket); });
+        }
+        idle->start();
+    }
+}
+
+QByteArray MockPrinter::handleBlock(const QByteArray &block, RawConnection &c)
+{
+    // ^XA^HWE:*.ZPL^XZ
+    const int hw = block.indexOf("^HW");
+    if (hw >= 0) {
+        const int end = block.indexOf('^', hw + 3);
+        return directory(QString::fromLatin1(block.mid(hw + 3, end - hw - 3)).trimmed());
+    }
+
+    // ^XA^HFE:DEFAULT.ZPL^XZ
+    const int hf = block.indexOf("^HF");
+    if (hf >= 0) {
+        const int end = block.indexOf('^', hf + 3);
+        const QString name = QString::fromLatin1(block.mid(hf + 3, end - hf - 3)).section(':', -1).trimmed().toUpper();
+        return framed(stored.value(name));
+    }
+
+    // ^XA^DFE:DEFAULT.ZPL^FS ... ^XZ
+    const int df = block.indexOf("^DF");
+    if (df >= 0) {
+        const int end = block.indexOf("^FS", df);
+        const QString name = QString::fromLatin1(block.mid(df + 3, end - df - 3)).section(':', -1).trimmed().toUpper();
+        stored.insert(name, block);
+        return QByteArray();
+    }
+
+    c.job += block + '\n';
+    c.labels += countLabels(block);
+    return QByteArray();
+}
+
+void MockPrinter::flushRaw(QTcpSocket *socket)
+{
+    auto it = raw.find(socket);
+    if (it == raw.end() || it->job.isEmpty())
+        return;
+    recordJob("raw", socket->peerAddress().toString(), it->job, it->labels);
+    it->job.clear();
+    it->labels = 0;
+}
+
+QByteArray MockPrinter::hostStatus() const
+{
+    const bool paperOut = isPaperOut();
+    // aaa,b,c,dddd,eee,f,g,h,iii,j,k,l / mmm,n,o,p,q,r,s,t,uuuuuuuu,v,www / xxxx,y
+    return framed(QByteArray("030,") + (paperOut ? '1' : '0') + ",0,0406,000,0,0,0,000,0,0,0")
+         + framed("000,0,0,0,0,2,4,0,00000000,1,000")
+         + framed("1234,0");
+}
+
+QByteArray MockPrinter::extendedStatus() const
+{
+    const bool paperOut = isPaperOut();
+    QByteArray text = "\r\n\r\n  PRINTER STATUS\r\n";
+    text += paperOut ? "   ERRORS:         1 00000000 00000001\r\n"
+                     : "   ERRORS:         0 00000000 00000000\r\n";
+    text += "   WARNINGS:       0 00000000 00000000\r\n";
+    return framed(text);
+}
+
+QByteArray MockPrinter::directory(const QString &pattern) const
+{
+    // "E:*.ZPL" -> "* E:DEFAULT.ZPL    412" lines
+    const QString drive = pattern.contains(':') ? pattern.section(':', 0, 0) : QString("E");
+    const QRegularExpression match(
+        QRegularExpression::wildcardToRegularExpression(pattern.section(':', -1)),
+        QRegularExpression::CaseInsensitiveOption);
+
+    QByteArray listing = "- DIR " + pattern.toLatin1() + "\r\n";
+    for (auto it = stored.constBegin(); it != stored.constEnd(); ++it) {
+        if (match.match(it.key()).hasMatch())
+            listing += QString("* %1:%2    %3\r\n").arg(drive, it.key()).arg(it.value().size()).toLatin1();
+    }
+    listing += "-  1048576 bytes free\r\n";
+    return framed(listing);
+}
+
+//
+// IPP (/ipp/print)
+//
+void MockPrinter::acceptIpp()
+{
+    while (QTcpSocket *socket = ippServer->nextPendingConnection()) {
+        if (dropConnection(socket))
+            continue;
+        ipp.insert(socket, IppConnection());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readIpp(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            ipp.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockPrinter::readIpp(QTcpSocket *socket)
+{
+    auto it = ipp.find(socket);
+    if (it == ipp.end() || it->busy)
+        return;
+    if (qint64 wait = stallRemaining()) {
+        QTimer::singleShot(int(wait), socket, [this, socket]() { readIpp(socket); });
+        return;
+    }
+
+    it->buffer += socket->readAll();
+
+    QByteArray body;
+    bool close = false;
+    bool expectContinue = false;
+    if (!takeHttpRequest(it->buffer, &body, &close, &expectContinue)) {
+        if (expectContinue && !it->continued) {
+            socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+            it->continued = true;
+        }
+        return;
+    }
+    it->continued = false;
+
+    const QByteArray response = handleIpp(body, socket->peerAddress().toString());
+    QByteArray http = "HTTP/1.1 200 OK\r\nContent-Type: application/ipp\r\n";
+    http += "Content-Length: " + QByteArray::number(response.size()) + "\r\n";
+    http += close ? "Connection: close\r\n\r\n" : "Connection: keep-alive\r\n\r\n";
+    http += response;
+
+    // Pipelined requests are answered in order, one latency apart.
+    it->busy = true;
+    QTimer::singleShot(qMax(0, options.latencyMs), socket, [this, socket, http, close]() {
+        socket->write(http);
+        if (close) {
+            socket->disconnectFromHost();
+            return;
+        }
+        auto c = ipp.find(socket);
+        if (c == ipp.end())
+            return;
+        c->busy = false;
+        if (!c->buffer.isEmpty() || socket->bytesAvailable() > 0)
+            readIpp(socket);
+    });
+}
+
+QByteArray MockPrinter::handleIpp(const QByteArray &request, const QString &peer)
+{
+    quint16 status = SuccessfulOk;
+    quint32 requestId = 0;
+    quint16 operation = 0;
+    int jobId = -1;
+    QByteArray document;
+
+    const uchar *p = reinterpret_cast<const uchar *>(request.constData());
+    if (request.size() < 9) {
+        status = ClientErrorBadRequest;
+    } else {
+        operation = get16(p + 2);
+        requestId = get32(p + 4);
+
+        // Attributes up to end-of-attributes; the document follows.
+        int pos = 8;
+        bool ended = false;
+        while (pos < request.size()) {
+            const quint8 tag = p[pos++];
+            if (tag == EndOfAttributesTag) {
+                ended = true;
+                break;
+            }
+            if (tag < 0x10)
+                continue;
+            if (pos + 2 > request.size())
+                break;
+            const int nameLen = get16(p + pos);
+            pos += 2;
+            const QByteArray name = request.mid(pos, nameLen);
+            pos += nameLen;
+            if (pos + 2 > request.size())
+                break;
+            const int valueLen = get16(p + pos);
+            pos += 2;
+            if (name == "job-id" && valueLen == 4 && pos + 4 <= request.size())
+                jobId = int(get32(p + pos));
+            pos += valueLen;
+        }
+        if (!ended)
+            status = ClientErrorBadRequest;
+        else
+            document = request.mid(pos);
+    }
+
+    QByteArray group;
+    quint8 groupTag = JobAttributesTag;
+    if (status == SuccessfulOk) {
+        switch (operation) {
+        case OpPrintJob: {
+            if (document.isEmpty()) {
+                status = ClientErrorBadRequest;
+                break;
+            }
+            const bool stopped = isPaperOut();
+            const int id = nextIppJobId++;
+            ippJobsStopped.insert(id, stopped);
+            recordJob("ipp", peer, document, countLabels(document));
+            putInteger(group, TagInteger, "job-id", id);
+            putInteger(group, TagEnum, "job-state", stopped ? 6 : 9);   // processing-stopped / completed
+            break;
+        }
+        case OpGetJobAttributes:
+            if (!ippJobsStopped.contains(jobId)) {
+                status = ClientErrorNotFound;
+                break;
+            }
+            putInteger(group, TagInteger, "job-id", jobId);
+            putInteger(group, TagEnum, "job-state", ippJobsStopped.value(jobId) && isPaperOut() ? 6 : 9);
+            break;
+        case OpGetPrinterAttributes:
+            groupTag = PrinterAttributesTag;
+            putInteger(group, TagEnum, "printer-state", isPaperOut() ? 5 : 3);   // stopped / idle
+            putString(group, TagKeyword, "printer-state-reasons", isPaperOut() ? "media-empty" : "none");
+            putString(group, TagText, "printer-make-and-model", "Zebra ZD420 (mock)");
+            group.append(char(TagBoolean));
+            put16(group, quint16(strlen("printer-is-accepting-jobs")));
+            group.append("printer-is-accepting-jobs");
+            put16(group, 1);
+            group.append(char(1));
+            putString(group, TagMimeMediaType, "document-format-supported", "application/vnd.zebra-zpl");
+            putString(group, TagMimeMediaType, "", "application/octet-stream");
+            break;
+        default:
+            status = ServerErrorOperationNotSupported;
+            break;
+        }
+    }
+
+    QByteArray response;
+    response.append(char(2));
+    response.append(char(0));
+    put16(response, status);
+    put32(response, requestId);
+    response.append(char(OperationAttributesTag));
+    putString(response, TagCharset, "attributes-charset", "utf-8");
+    putString(response, TagNaturalLanguage, "attributes-natural-language", "en");
+    if (status == SuccessfulOk && !group.isEmpty()) {
+        response.append(char(groupTag));
+        response += group;
+    }
+    response.append(char(EndOfAttributesTag));
+    return response;
+}
+
+//
+// LPD (RFC 1179 receive job)
+//
+void MockPrinter::acceptLpd()
+{
+    while (QTcpSocket *socket = lpdServer->nextPendingConnection()) {
+        if (dropConnection(socket))
+            continue;
+        lpd.insert(socket, LpdConnection());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readLpd(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            auto it = lpd.find(socket);
+            if (it != lpd.end() && !it->data.isEmpty())
+                recordJob("lpd", socket->peerAddress().toString(), it->data, countLabels(it->data));
+            lpd.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockPrinter::readLpd(QTcpSocket *socket)
+{
+    auto it = lpd.find(socket);
+    if (it == lpd.end())
+        return;
+    if (qint64 wait = stallRemaining()) {
+        QTimer::singleShot(int(wait), socket, [this, socket]() { readLpd(socket); });
+        return;
+    }
+
+    LpdConnection &c = *it;
+    c.buffer += socket->readAll();
+
+    while (true) {
+        // File contents, then a zero byte.
+        if (c.expect >= 0) {
+            if (c.buffer.size() < c.expect + 1)
+                return;
+            if (c.dataFile)
+                c.data += c.buffer.left(int(c.expect));
+            c.buffer.remove(0, int(c.expect + 1));
+            c.expect = -1;
+            reply(socket, QByteArray(1, '\0'));
+            continue;
+        }
+
+        const int lineEnd = c.buffer.indexOf('\n');
+        if (lineEnd < 0)
+            return;
+        const QByteArray line = c.buffer.left(lineEnd);
+        c.buffer.remove(0, lineEnd + 1);
+        if (line.isEmpty())
+            continue;
+
+        const char command = line.at(0);
+        if (!c.inJob) {
+            if (command == '\x02') {            // receive a printer job
+                c.inJob = true;
+                reply(socket, QByteArray(1, '\0'));
+            } else if (command == '\x03' || command == '\x04') {   // queue state
+                reply(socket, QByteArray(isPaperOut() ? "mock: paper out\n" : "mock: ready\n"));
+                socket->disconnectFromHost();
+                return;
+            } else {
+                reply(socket, QByteArray(1, '\0'));
+            }
+            continue;
+        }
+
+        if (command == '\x01') {                // abort job
+            c.data.clear();
+            reply(socket, QByteArray(1, '\0'));
+        } else if (command == '\x02' || command == '\x03') {   // control / data file
+            c.expect = line.mid(1).split(' ').first().toLongLong();
+            c.dataFile = command == '\x03';
+            reply(socket, QByteArray(1, '\0'));
+        } else {
+            reply(socket, QByteArray(1, '\x01'));
+        }
+    }
+}
+
+//
+// Command line
+//
+QList<QCommandLineOption> MockPrinter::commandLineOptions()
+{
+    return {
+        QCommandLineOption("listen", "Address to listen on (default 127.0.0.1).", "address"),
+        QCommandLineOption("raw-port", "Raw ZPL port, 0 = off (default 9100).", "port"),
+        QCommandLineOption("ipp-port", "IPP port, 0 = off (default 8631).", "port"),
+        QCommandLineOption("lpd-port", "LPD port, 0 = off (default 8515).", "port"),
+        QCommandLineOption("out", "Folder for received jobs and jobs.log (default mock-printer).", "dir"),
+        QCommandLineOption("latency", "Delay before every reply, ms.", "ms"),
+        QCommandLineOption("drop-rate", "Fraction of connections reset on accept (0-1).", "rate"),
+        QCommandLineOption("stall-every", "Stop reading every <n> jobs...", "n"),
+        QCommandLineOption("stall-ms", "...for this long (default 2000).", "ms"),
+        QCommandLineOption("paper-out-every", "Report paper out every <n> labels...", "n"),
+        QCommandLineOption("paper-out-ms", "...for this long (default 5000).", "ms"),
+    };
+}
+
+bool MockPrinter::optionsFromParser(const QCommandLineParser &parser, Options *options, QString *error)
+{
+    auto number = [&](const char *name, int fallback, int *value) {
+        if (!parser.isSet(name)) {
+            *value = fallback;
+            return true;
+        }
+        bool ok;
+        *value = parser.value(name).toInt(&ok);
+        if (!ok || *value < 0) {
+            *error = QString("--%1 needs a number, got \"%2\"").arg(QString::fromLatin1(name), parser.value(name));
+            return false;
+        }
+        return true;
+    };
+
+    int rawPort, ippPort, lpdPort;
+    if (!number("raw-port", options->rawPort, &rawPort) || !number("ipp-port", options->ippPort, &ippPort)
+        || !number("lpd-port", options->lpdPort, &lpdPort)
+        || !number("latency", options->latencyMs, &options->latencyMs)
+        || !number("stall-every", options->stallEvery, &options->stallEvery)
+        || !number("stall-ms", 2000, &options->stallMs)
+        || !number("paper-out-every", options->paperOutEvery, &options->paperOutEvery)
+        || !number("paper-out-ms", 5000, &options->paperOutMs))
+        return false;
+    if (rawPort > 65535 || ippPort > 65535 || lpdPort > 65535) {
+        *error = "Ports go up to 65535.";
+        return false;
+    }
+    options->rawPort = quint16(rawPort);
+    options->ippPort = quint16(ippPort);
+    options->lpdPort = quint16(lpdPort);
+
+    if (parser.isSet("listen") && !options->address.setAddress(parser.value("listen"))) {
+        *error = QString("--listen needs an IP address, got \"%1\"").arg(parser.value("listen"));
+        return false;
+    }
+    if (parser.isSet("out"))
+        options->outputDir = parser.value("out");
+    if (parser.isSet("drop-rate")) {
+        bool ok;
+        options->dropRate = parser.value("drop-rate").toDouble(&ok);
+        if (!ok || options->dropRate < 0 || options->dropRate > 1) {
+            *error = "--drop-rate needs a fraction between 0 and 1.";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MockPrinter::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]) == "--mock-printer")
+            return true;
+    }
+    return false;
+}
+
+int MockPrinter::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Stand-in Zebra printer: raw ZPL, IPP and LPD listeners that record every job\n"
+        "and can be told to be slow, drop connections, stall or run out of paper.");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("mock-printer", "Run the mock printer."));
+    parser.addOptions(commandLineOptions());
+
+    if (!parser.parse(arguments)) {
+        err() << parser.errorText() << "\n";
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        out() << parser.helpText();
+        return 0;
+    }
+
+    Options options;
+    QString error;
+    if (!optionsFromParser(parser, &options, &error)) {
+        err() << error << "\n";
+        return ExitUsage;
+    }
+
+    MockPrinter printer(options);
+    if (!printer.start(&error)) {
+        err() << error << "\n";
+        return 1;
+    }
+
+    const QString host = options.address.toString();
+    out() << "Mock printer listening on\n";
+    if (options.rawPort)
+        out() << QString("  raw ZPL  %1:%2\n").arg(host).arg(options.rawPort);
+    if (options.ippPort)
+        out() << QString("  IPP      ipp://%1:%2/ipp/print\n").arg(host).arg(options.ippPort);
+    if (options.lpdPort)
+        out() << QString("  LPD      %1:%2\n").arg(host).arg(options.lpdPort);
+    out() << QString("Jobs are written to %1\n").arg(QDir(options.outputDir).absolutePath());
+    out().flush();
+
+    return QCoreApplication::exec();
+}
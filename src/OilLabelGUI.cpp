@@ -1,6 +1,20 @@
 // src/OilLabelGUI.cpp
 #include "OilLabelGUI.hpp"
 #include "LabelPreview.hpp"
+#include "LabelSheetView.hpp"
+#include "PrintQueue.hpp"
+#include "CupsPrinterBackend.hpp"
+#include "LabelJob.hpp"
+#include "LabelFieldModel.hpp"
+#include "BatchPrintDialog.hpp"
+#include "PrinterDiscovery.hpp"
+#include "SettingsStore.hpp"
+#include "PrintJournal.hpp"
+#include "VehicleIndex.hpp"
+#include "RawPrinterTransport.hpp"
+#include "TemplateSync.hpp"
+#include "ZplGraphic.hpp"
+#include "StartupTimer.hpp"
 #include "version.hpp"
 
 #include <QApplication>
@@ -15,9 +29,8 @@
 #include <QAction>
 #include <QInputDialog>
 #include <QFileDialog>
-#include <QSettings>
 #include <QDate>
-#include <QProcess>
+#include <QDateTime>
 #include <QStringList>
 #include <QFont>
 #include <QFile>
@@ -25,12 +38,14 @@
 #include <QStandardPaths>
 #include <QFileInfo>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QCompleter>
+#include <QStandardItemModel>
+#include <QAbstractItemView>
 #include <QLocale>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QNetworkRequest>
-#include <QtNetwork/QNetworkReply>
-#include <QUrl>
 #include <QByteArray>
+#include <QHash>
+#include <QDebug>
 
 const QSize defaultSize(500, 600);   // window size for DEFAULT style
 const QSize keytagSize(500, 600);    // window size for KEYTAG style
@@ -43,44 +58,109 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     // -----------------------------
     // Load settings
     // -----------------------------
-    QSettings settings("WFWestHS", "OilStickerApp");
-
-    printerName = settings.value("printerName", "").toString();
-    defaultMiles = settings.value("defaultMiles", 5000).toInt();
-    labelStyle = settings.value("labelStyle", "DEFAULT").toString().toUpper();
-    templateName = settings.value("template", "DEFAULT.ZPL").toString();
-    useIppPrinting = settings.value("useIppPrinting", false).toBool();
-    keytagPrinterName  = settings.value("keytagPrinterName").toString();
+    SettingsStore &settings = SettingsStore::instance();
+
+    printerName = settings.printerName();
+    defaultMiles = settings.defaultMiles();
+    labelStyle = settings.labelStyle();
+    useIppPrinting = settings.useIppPrinting();
+    keytagPrinterName = settings.keytagPrinterName();
+    inlineFormats = settings.inlineFormats();
+    networkProtocol = settings.networkProtocol();
+    StartupTimer::mark("settings");
+
+    printQueue = new PrintQueue(this);
+    connect(printQueue, &PrintQueue::jobFinished, this, &OilLabelGUI::onPrintJobFinished);
+    connect(printQueue, &PrintQueue::depthChanged, this, &OilLabelGUI::updateQueueStatus);
+    connect(printQueue, &PrintQueue::jobStateChanged, this, &OilLabelGUI::onPrintJobStateChanged);
+    connect(printQueue, &PrintQueue::templatesSynced, this, &OilLabelGUI::onTemplatesSynced);
+    connect(printQueue, &PrintQueue::printerStatusChanged, this, &OilLabelGUI::updatePrinterStatus);
+    // A printer that drops off the network gets its labels later instead
+    // of an error box; the backlog survives a restart.
+    printQueue->enableSpool();
+
+    // Mapping and checksumming the journal grows with every label printed,
+    // and the first run builds the vehicle index from it; both happen on a
+    // worker thread and the window does not wait for them (see
+    // waitForStores()).
+    journal = new PrintJournal(this);
+    vehicles = new VehicleIndex(this);
+    storeLoader.setMaxThreadCount(1);
+    storeLoader.start([this]() {
+        QString journalError;
+        if (!journal->open(PrintJournal::defaultPath(), &journalError))
+            qWarning() << "Print journal disabled:" << journalError;
+
+        // Repeat vehicles: plate, VIN or RO prefix pops up past key tags.
+        QString vehicleError;
+        if (!vehicles->load(VehicleIndex::defaultPath(), journal, &vehicleError))
+            qWarning() << "Vehicle index:" << vehicleError;
+        QMetaObject::invokeMethod(this, &OilLabelGUI::waitForStores, Qt::QueuedConnection);
+    });
 
-    // default backgrounds for styles
-    QString defaultResource_default = ":/resources/default.png";
-    QString defaultResource_keytag  = ":/resources/keytag.png";
+    discovery = new PrinterDiscovery(this);
+    connect(discovery, &PrinterDiscovery::printersChanged, this, &OilLabelGUI::updatePreviewFormat);
+    StartupTimer::mark("print queue");
 
     // Choose background path based on saved style
     if (labelStyle == "KEYTAG") {
-        backgroundPath = settings.value("keytagBackground", defaultResource_keytag).toString();
-        templateName = settings.value("template", "KEYTAG.ZPL").toString();
+        templateName = settings.templateName("KEYTAG.ZPL");
     } else {
-        backgroundPath = settings.value("defaultBackground", defaultResource_default).toString();
-        templateName = settings.value("template", "DEFAULT.ZPL").toString();
+        templateName = settings.templateName("DEFAULT.ZPL");
         labelStyle = "DEFAULT";
     }
+    backgroundPath = settings.background(labelStyle);
 
     // -----------------------------
     // Menu Bar
     // -----------------------------
     QMenuBar *menuBar = new QMenuBar(this);
 
+    // Print menu
+    QMenu *printMenu = menuBar->addMenu("Print");
+    QAction *batchPrintAct = new QAction("Batch Print...", this);
+    connect(batchPrintAct, &QAction::triggered, this, &OilLabelGUI::openBatchPrint);
+    printMenu->addAction(batchPrintAct);
+
+    QAction *reprintAct = new QAction("Reprint...", this);
+    connect(reprintAct, &QAction::triggered, this, &OilLabelGUI::reprint);
+    printMenu->addAction(reprintAct);
+
     // Settings menu
     QMenu *settingsMenu = menuBar->addMenu("Settings");
     QAction *changePrinter = new QAction("Select Printer", this);
     connect(changePrinter, &QAction::triggered, this, &OilLabelGUI::selectPrinter);
     settingsMenu->addAction(changePrinter);
 
+    QAction *rescanAct = new QAction("Rescan for Printers", this);
+    connect(rescanAct, &QAction::triggered, this, &OilLabelGUI::refreshPrinters);
+    settingsMenu->addAction(rescanAct);
+
+    QAction *changeProtocolAct = new QAction("Network Protocol", this);
+    connect(changeProtocolAct, &QAction::triggered, this, &OilLabelGUI::selectNetworkProtocol);
+    settingsMenu->addAction(changeProtocolAct);
+
+    QAction *inlineFormatsAct = new QAction("Send Full Formats (no ^XF recall)", this);
+    inlineFormatsAct->setCheckable(true);
+    inlineFormatsAct->setChecked(inlineFormats);
+    connect(inlineFormatsAct, &QAction::toggled, this, [this](bool on) {
+        inlineFormats = on;
+        SettingsStore::instance().setInlineFormats(inlineFormats);
+    });
+    settingsMenu->addAction(inlineFormatsAct);
+
+    QAction *syncFormatsAct = new QAction("Sync Formats to Printers", this);
+    connect(syncFormatsAct, &QAction::triggered, this, &OilLabelGUI::syncFormats);
+    settingsMenu->addAction(syncFormatsAct);
+
     QAction *changeBackgroundAct = new QAction("Select Background", this);
     connect(changeBackgroundAct, &QAction::triggered, this, &OilLabelGUI::changeBackground);
     settingsMenu->addAction(changeBackgroundAct);
 
+    QAction *selectLogoAct = new QAction("Select Label Logo", this);
+    connect(selectLogoAct, &QAction::triggered, this, &OilLabelGUI::selectLogo);
+    settingsMenu->addAction(selectLogoAct);
+
     QAction *changeTemplateAct = new QAction("Select Template", this);
     connect(changeTemplateAct, &QAction::triggered, this, &OilLabelGUI::selectTemplate);
     settingsMenu->addAction(changeTemplateAct);
@@ -94,6 +174,7 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     QAction *aboutAction = new QAction("About", this);
     connect(aboutAction, &QAction::triggered, this, &OilLabelGUI::showAboutDialog);
     helpMenu->addAction(aboutAction);
+    StartupTimer::mark("menus");
 
     // -----------------------------
     // Layouts
@@ -114,6 +195,14 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     connect(styleCombo, &QComboBox::currentTextChanged, this, &OilLabelGUI::onStyleChanged);
     styleRow->addWidget(styleLabel);
     styleRow->addWidget(styleCombo);
+    // Vehicle ticket: one form, the sticker and the key tag printed at once
+    // on their two printers.
+    vehicleTicket = settings.vehicleTicket();
+    ticketCheck = new QCheckBox("Sticker + Key Tag");
+    ticketCheck->setToolTip("Print the oil sticker and the key tag from one form, on both printers at once");
+    ticketCheck->setChecked(vehicleTicket);
+    connect(ticketCheck, &QCheckBox::toggled, this, &OilLabelGUI::setVehicleTicket);
+    styleRow->addWidget(ticketCheck);
     styleRow->addStretch();
     mainLayout->addLayout(styleRow);
 
@@ -122,13 +211,98 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     // -----------------------------
     preview = new LabelPreview(this);
     preview->setBackground(backgroundPath);
+    preview->prefetchBackground(settings.background(labelStyle == "KEYTAG" ? "DEFAULT" : "KEYTAG"));
     preview->setLabelStyle(labelStyle);
+    updatePreviewFormat();
     //mainLayout->addWidget(preview, 0, Qt::AlignCenter);
     mainLayout->addWidget(preview, 0, Qt::AlignTop);
 
+    // Every physical label of a multi-label key tag job
+    sheet = new LabelSheetView(preview, this);
+    sheet->setVisible(false);
+    mainLayout->addWidget(sheet);
+    StartupTimer::mark("preview");
+
     // -----------------------------
     // Inputs below the preview
     // -----------------------------
+    // Each edit only stores its text; the field model derives the label
+    // fields once per frame and the preview repaints the ones that changed.
+    fieldModel = new LabelFieldModel(this);
+    fieldModel->setDefaultMiles(defaultMiles);
+    fieldModel->setStyle(labelStyle);
+    connect(fieldModel, &LabelFieldModel::fieldsChanged, preview, &LabelPreview::setFields);
+
+    // Sticker and key tag fields. Only the panels the current style shows
+    // are built now; the other is built the first time it is needed.
+    formLayout = new QVBoxLayout();
+    formLayout->setContentsMargins(0, 0, 0, 0);
+    mainLayout->addLayout(formLayout);
+    updateFieldVisibility();
+    StartupTimer::mark("form");
+
+    // -----------------------------
+    // Buttons
+    // -----------------------------
+    printBtn = new QPushButton("Print Label");
+    printBtn->setFixedWidth(150);
+    connect(printBtn, &QPushButton::clicked, this, &OilLabelGUI::printLabel);
+
+    clearBtn = new QPushButton("Clear");
+    clearBtn->setFixedWidth(100);
+    connect(clearBtn, &QPushButton::clicked, this, &OilLabelGUI::clearInputs);
+
+    QHBoxLayout *buttonRow = new QHBoxLayout();
+    buttonRow->addWidget(printBtn);
+    buttonRow->addWidget(clearBtn);
+    buttonRow->addStretch();
+    mainLayout->addLayout(buttonRow);
+
+    // Printer health (polled on the print thread)
+    printerStatusLabel = new QLabel();
+    printerStatusLabel->setTextFormat(Qt::RichText);
+    mainLayout->addWidget(printerStatusLabel);
+
+    // Live per-printer queue depth
+    queueStatusLabel = new QLabel();
+    mainLayout->addWidget(queueStatusLabel);
+
+    setLayout(mainLayout);
+
+    // initial preview blank
+    preview->updatePreview(QString(), QString(), QString(), QString());
+    fieldModel->flush();
+    updateQueueStatus();
+    watchPrinters();
+    refreshPrinters();
+
+    // Make sure the printers hold the current zpl/ formats before the
+    // first recall job (queued on the print thread, ahead of any label).
+    if (settings.syncFormats())
+        syncFormats();
+    StartupTimer::mark("window");
+}
+
+//
+// Field panels
+//
+void OilLabelGUI::bindInput(QLineEdit *edit, LabelFieldModel::Input input)
+{
+    fieldModel->setInput(input, edit->text());
+    connect(edit, &QLineEdit::textChanged, this, [this, input](const QString &text) {
+        fieldModel->setInput(input, text);
+    });
+}
+
+void OilLabelGUI::ensureStickerPanel()
+{
+    if (stickerPanel)
+        return;
+
+    stickerPanel = new QWidget(this);
+    QVBoxLayout *box = new QVBoxLayout(stickerPanel);
+    box->setContentsMargins(0, 0, 0, 0);
+
     // DEFAULT section fields (template, mileage, nextService, oilType)
     templateLabel = new QLabel("Template:");
     templateInput = new QLineEdit(templateName);
@@ -149,9 +323,70 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     oilTypeInput->setFixedWidth(200);
     oilTypeInput->setPlaceholderText("e.g. MOBIL1 0W40");
 
+    // Arrange default fields
+    QHBoxLayout *tmplRow = new QHBoxLayout();
+    tmplRow->addWidget(templateLabel);
+    tmplRow->addWidget(templateInput);
+    tmplRow->addStretch();
+    box->addLayout(tmplRow);
+    templateLabel->setVisible(false);
+    templateInput->setVisible(false);
+
+    QHBoxLayout *mRow = new QHBoxLayout();
+    mRow->addWidget(mileageLabel);
+    mRow->addWidget(mileageInput);
+    mRow->addSpacing(20);
+    mRow->addWidget(intervalLabel);
+    mRow->addWidget(intervalInput);
+    mRow->addStretch();
+    box->addLayout(mRow);
+
+    QHBoxLayout *oilRow = new QHBoxLayout();
+    oilRow->addWidget(oilTypeLabel);
+    oilRow->addWidget(oilTypeInput);
+    oilRow->addStretch();
+    box->addLayout(oilRow);
+
+    // Persist default miles when editing
+    connect(intervalInput, &QLineEdit::editingFinished, this, [this]() {
+        bool ok;
+        int val = intervalInput->text().toInt(&ok);
+        if (ok && val > 0) {
+            defaultMiles = val;
+            fieldModel->setDefaultMiles(defaultMiles);
+            SettingsStore::instance().setDefaultMiles(defaultMiles);
+        }
+    });
+
+    bindInput(mileageInput, LabelFieldModel::Mileage);
+    bindInput(intervalInput, LabelFieldModel::Interval);
+    connect(templateInput, &QLineEdit::editingFinished, this, [this]() {
+        templateName = templateInput->text().toUpper();
+        SettingsStore::instance().setTemplateName(templateName);
+        updatePreviewFormat();
+    });
+
+    // Typed text is upper-cased by the validator, before textChanged.
+    oilTypeInput->setValidator(new UpperCaseValidator(this));
+    bindInput(oilTypeInput, LabelFieldModel::OilType);
+
+    // Above the key tag fields; hidden until updateFieldVisibility() says.
+    formLayout->insertWidget(0, stickerPanel);
+    stickerPanel->hide();
+}
+
+void OilLabelGUI::ensureKeytagPanel()
+{
+    if (keytagPanel)
+        return;
+
+    keytagPanel = new QWidget(this);
+    QVBoxLayout *ktBox = new QVBoxLayout(keytagPanel);
+    ktBox->setContentsMargins(0, 0, 0, 0);
+
     // KEYTAG section fields
     kt_templateLabel = new QLabel("Template:");
-    kt_templateInput = new QLineEdit("KEYTAG.ZPL");
+    kt_templateInput = new QLineEdit(templateName);
     customerLabel = new QLabel("Customer:");
     customerInput = new QLineEdit();
     carLabel = new QLabel("Car:");
@@ -172,35 +407,14 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     quantityInput->setText("1");
     quantityInput->setValidator(new QIntValidator(1, 99, this));
 
-    // Arrange default fields
-    QHBoxLayout *tmplRow = new QHBoxLayout();
-    tmplRow->addWidget(templateLabel);
-    tmplRow->addWidget(templateInput);
-    tmplRow->addStretch();
-    mainLayout->addLayout(tmplRow);
-
-    QHBoxLayout *mRow = new QHBoxLayout();
-    mRow->addWidget(mileageLabel);
-    mRow->addWidget(mileageInput);
-    mRow->addSpacing(20);
-    mRow->addWidget(intervalLabel);
-    mRow->addWidget(intervalInput);
-    mRow->addStretch();
-    mainLayout->addLayout(mRow);
-
-    QHBoxLayout *oilRow = new QHBoxLayout();
-    oilRow->addWidget(oilTypeLabel);
-    oilRow->addWidget(oilTypeInput);
-    oilRow->addStretch();
-    mainLayout->addLayout(oilRow);
-
     // Arrange keytag fields (stacked)
-    QVBoxLayout *ktBox = new QVBoxLayout();
     QHBoxLayout *ktTmplRow = new QHBoxLayout();
     ktTmplRow->addWidget(kt_templateLabel);
     ktTmplRow->addWidget(kt_templateInput);
     ktTmplRow->addStretch();
     ktBox->addLayout(ktTmplRow);
+    kt_templateLabel->setVisible(false);
+    kt_templateInput->setVisible(false);
 
     auto addRowTo = [&](QVBoxLayout *parent, QLabel *lab, QLineEdit *edit){
         QHBoxLayout *r = new QHBoxLayout();
@@ -217,279 +431,316 @@ OilLabelGUI::OilLabelGUI(QWidget *parent)
     addRowTo(ktBox, repairOrderLabel, repairOrderInput);
     addRowTo(ktBox, quantityLabel, quantityInput);
 
-    mainLayout->addLayout(ktBox);
-
-    // -----------------------------
-    // Buttons
-    // -----------------------------
-    printBtn = new QPushButton("Print Label");
-    printBtn->setFixedWidth(150);
-    connect(printBtn, &QPushButton::clicked, this, &OilLabelGUI::printLabel);
-
-    clearBtn = new QPushButton("Clear");
-    clearBtn->setFixedWidth(100);
-    connect(clearBtn, &QPushButton::clicked, this, &OilLabelGUI::clearInputs);
-
-    QHBoxLayout *buttonRow = new QHBoxLayout();
-    buttonRow->addWidget(printBtn);
-    buttonRow->addWidget(clearBtn);
-    buttonRow->addStretch();
-    mainLayout->addLayout(buttonRow);
-
-    setLayout(mainLayout);
-
-    // -----------------------------
-    // Visibility initial state per style
-    // -----------------------------
-    bool isKeyTag = (labelStyle == "KEYTAG");
-    templateLabel->setVisible(0);
-    templateInput->setVisible(0);
-    mileageLabel->setVisible(!isKeyTag);
-    mileageInput->setVisible(!isKeyTag);
-    intervalLabel->setVisible(!isKeyTag);
-    intervalInput->setVisible(!isKeyTag);
-    oilTypeLabel->setVisible(!isKeyTag);
-    oilTypeInput->setVisible(!isKeyTag);
-
-    kt_templateLabel->setVisible(0);
-    kt_templateInput->setVisible(0);
-    customerLabel->setVisible(isKeyTag);
-    customerInput->setVisible(isKeyTag);
-    carLabel->setVisible(isKeyTag);
-    carInput->setVisible(isKeyTag);
-    plateLabel->setVisible(isKeyTag);
-    plateInput->setVisible(isKeyTag);
-    vinLabel->setVisible(isKeyTag);
-    vinInput->setVisible(isKeyTag);
-    colorLabel->setVisible(isKeyTag);
-    colorInput->setVisible(isKeyTag);
-    repairOrderLabel->setVisible(isKeyTag);
-    repairOrderInput->setVisible(isKeyTag);
-    quantityLabel->setVisible(isKeyTag);
-    quantityInput->setVisible(isKeyTag);
-
-    // -----------------------------
-    // Persist default miles when editing
-    // -----------------------------
-    connect(intervalInput, &QLineEdit::editingFinished, this, [this]() {
-        bool ok;
-        int val = intervalInput->text().toInt(&ok);
-        if (ok && val > 0) {
-            defaultMiles = val;
-            QSettings settings("WFWestHS", "OilStickerApp");
-            settings.setValue("defaultMiles", defaultMiles);
-        }
-    });
-
-    // -----------------------------
-    // Live Update signals
-    // -----------------------------
-    connect(mileageInput, &QLineEdit::textChanged, this, &OilLabelGUI::liveUpdate);
-    connect(intervalInput, &QLineEdit::textChanged, this, &OilLabelGUI::liveUpdate);
-    connect(templateInput, &QLineEdit::editingFinished, this, [this]() {
-        templateName = templateInput->text().toUpper();
-        QSettings settings("WFWestHS", "OilStickerApp");
-        settings.setValue("template", templateName);
-    });
-
     connect(kt_templateInput, &QLineEdit::editingFinished, this, [this]() {
         // if editing keytag template store uppercase
         templateName = kt_templateInput->text().toUpper();
-        QSettings settings("WFWestHS", "OilStickerApp");
-        settings.setValue("template", templateName);
-    });
-
-    connect(oilTypeInput, &QLineEdit::textChanged, this, [=](const QString &text) {
-        QString upper = text.toUpper();
-        if (text != upper) {
-            oilTypeInput->blockSignals(true);
-            oilTypeInput->setText(upper);
-            oilTypeInput->blockSignals(false);
-        }
-        liveUpdate();
+        SettingsStore::instance().setTemplateName(templateName);
+        updatePreviewFormat();
     });
 
     connect(quantityInput, &QLineEdit::textChanged, this, [this](const QString &text) {
         bool ok;
         int q = text.toInt(&ok);
         if (!ok || q < 1) q = 1;
-            preview->setQuantity(q);
+        preview->setQuantity(q);
+        sheet->setQuantity(q);
+        updateSheet();
     });
 
-auto ktConnect = [&](QLineEdit *le){
-    connect(le, &QLineEdit::textChanged, this, [=](const QString &text) {
-        QString upper = text.toUpper();
-        if (text != upper) {
-            le->blockSignals(true);
-            le->setText(upper);
-            le->blockSignals(false);
-        }
-        liveUpdate();
-    });
-};
+    auto ktConnect = [&](QLineEdit *le, LabelFieldModel::Input input) {
+        le->setValidator(new UpperCaseValidator(this));
+        bindInput(le, input);
+    };
 
-    ktConnect(customerInput);
-    ktConnect(carInput);
-    ktConnect(plateInput);
-    ktConnect(vinInput);
-    ktConnect(colorInput);
-    ktConnect(repairOrderInput);
+    ktConnect(customerInput, LabelFieldModel::Customer);
+    ktConnect(carInput, LabelFieldModel::Car);
+    ktConnect(plateInput, LabelFieldModel::Plate);
+    ktConnect(vinInput, LabelFieldModel::Vin);
+    ktConnect(colorInput, LabelFieldModel::Color);
+    ktConnect(repairOrderInput, LabelFieldModel::RepairOrder);
 
-    // initial preview blank
-    preview->updatePreview(QString(), QString(), QString(), QString());
+    attachRecall(plateInput, VehicleIndex::Plate);
+    attachRecall(vinInput, VehicleIndex::Vin);
+    attachRecall(repairOrderInput, VehicleIndex::RepairOrder);
+
+    formLayout->addWidget(keytagPanel);
+    keytagPanel->hide();
+}
+
+void OilLabelGUI::showTemplateName()
+{
+    if (templateInput)
+        templateInput->setText(templateName);
+    if (kt_templateInput)
+        kt_templateInput->setText(templateName);
 }
 
 //
-// Live Update
+// Print Label
 //
-void OilLabelGUI::liveUpdate()
+void OilLabelGUI::printLabel()
 {
-    bool okMileage, okInterval;
-    int mileage = mileageInput->text().toInt(&okMileage);
-    int interval = intervalInput->text().toInt(&okInterval);
+    if (vehicleTicket) {
+        printVehicleTicket();
+        return;
+    }
 
-    if (!okInterval) interval = defaultMiles;
+    LabelJob job = currentJob();
 
-    if (labelStyle == "DEFAULT") {
-        if (okMileage) {
-            int nextMileage = mileage + interval;
-            QDate nextDate = QDate::currentDate().addMonths(6);
+    QString error;
+    if (!job.validate(&error)) {
+        QMessageBox::warning(this, "Invalid Input", error);
+        return;
+    }
 
-            QString oilTypeStr = oilTypeInput->text().trimmed();
-            QString todayStr = QDate::currentDate().toString("MM/dd/yy");
+    QString printer = job.isKeyTag() ? keytagPrinterName : printerName;
 
-            preview->updatePreview(
-                QString("%L1").arg(nextMileage),
-                nextDate.toString("MM/dd/yy"),
-                oilTypeStr,
-                todayStr
-            );
-        } else {
-            preview->updatePreview(QString(), QString(), QString(), QString());
-        }
-    } else { // KEYTAG preview uses keytag fields
-        bool okQty;
-        int qty = quantityInput->text().toInt(&okQty);
-        if (!okQty || qty < 1) qty = 1;
-        preview->updatePreview(QString(), QString(),
-                               QString(), QString(),
-                               customerInput->text().trimmed(),
-                               carInput->text().trimmed(),
-                               plateInput->text().trimmed(),
-                               vinInput->text().trimmed(),
-                               colorInput->text().trimmed(),
-                               repairOrderInput->text().trimmed());
-        preview->setQuantity(quantityInput->text().toInt());
+    // Queue via sendZplToPrinter function
+    if (!sendZplToPrinter(job.toZpl(defaultMiles, formatMode()), printer, &job))
+        return;
+
+    int vehicle = -1;
+    if (job.isKeyTag())
+        vehicle = vehicles->addKeyTag(job);
+    else
+        vehicles->addSticker(currentVehicle, job);
+
+    clearInputs();
+
+    // The sticker usually follows the key tag; have its oil and interval ready.
+    if (vehicle >= 0) {
+        currentVehicle = vehicle;
+        prefillSticker();
     }
 }
 
 //
-// Print Label
+// Vehicle ticket
 //
-void OilLabelGUI::printLabel()
+void OilLabelGUI::printVehicleTicket()
 {
-    if (labelStyle == "DEFAULT") {
-        bool okMileage, okInterval;
-        int mileage = mileageInput->text().toInt(&okMileage);
-        int interval = intervalInput->text().toInt(&okInterval);
+    const LabelJob sticker = jobForStyle("DEFAULT");
+    const LabelJob keytag = jobForStyle("KEYTAG");
 
-        if (!okInterval) interval = defaultMiles;
-        if (!okMileage || !okInterval) {
-            QMessageBox::warning(this, "Invalid Input", "Inputs must be numbers.");
-            return;
-        }
+    QString error;
+    if (!sticker.validate(&error) || !keytag.validate(&error)) {
+        QMessageBox::warning(this, "Invalid Input", error);
+        return;
+    }
+    if (printerName.isEmpty() || keytagPrinterName.isEmpty()) {
+        QMessageBox::warning(this, "No Printer Selected",
+                             "A vehicle ticket needs a sticker printer and a key tag printer.\n"
+                             "Please select both in Settings.");
+        return;
+    }
 
-        int nextMileage = mileage + interval;
-        QString formattedMileage = QLocale(QLocale::English).toString(nextMileage);
-        QString nextDate = QDate::currentDate().addMonths(6).toString("MM/dd/yy");
-        QString oilType = oilTypeInput->text().trimmed();
-        QString today = QDate::currentDate().toString("MM/dd/yy");
-
-       bool okQty;
-        int qty = quantityInput->text().toInt(&okQty);
-        if (!okQty || qty < 1) qty = 1;
-
-        QString zpl = QString(
-            "^XA\n"
-            "^XF%1^FS\n"
-            "^FN2^FD%2^FS\n" // oil type
-            "^FN3^FD%3^FS\n" // today's date
-            "^FN4^FD%4^FS\n" // next mileage
-            "^FN5^FD%5^FS\n" // next date
-            "^XZ"
-        ).arg(templateName)
-         .arg(oilType)
-         .arg(today)
-         .arg(formattedMileage)
-         .arg(nextDate);
-
-        if (printerName.isEmpty()) {
-            QMessageBox::warning(this, "No Printer Selected", "Please select a printer in Settings.");
-            return;
-        }
-        // Print via sendZplToPrinter function
-        sendZplToPrinter(zpl, printerName);
+    // Each printer has its own print thread and connection, so the two
+    // labels print side by side.
+    const ZplTemplate::Mode mode = formatMode();
+    if (!sendZplToPrinter(keytag.toZpl(defaultMiles, mode), keytagPrinterName, &keytag))
+        return;
+    sendZplToPrinter(sticker.toZpl(defaultMiles, mode), printerName, &sticker);
 
-    } else { // KEYTAG print
-        int qty = 1;
-        bool okQty = false;
+    vehicles->addSticker(vehicles->addKeyTag(keytag), sticker);
+    clearInputs();
+}
 
-        qty = quantityInput->text().toInt(&okQty);
-        if (!okQty || qty < 1) qty = 1;
+void OilLabelGUI::setVehicleTicket(bool on)
+{
+    vehicleTicket = on;
+    SettingsStore::instance().setVehicleTicket(on);
+    updateFieldVisibility();
+    adjustSize();
+}
 
-        // divide by 2, round UP
-        qty = (qty + 1) / 2;
+void OilLabelGUI::updateFieldVisibility()
+{
+    // A vehicle ticket shows both field sets; the style picks the preview.
+    const bool isKeyTag = (labelStyle == "KEYTAG");
+    const bool showSticker = !isKeyTag || vehicleTicket;
+    const bool showKeytag = isKeyTag || vehicleTicket;
+
+    if (showSticker)
+        ensureStickerPanel();
+    if (showKeytag)
+        ensureKeytagPanel();
+    if (stickerPanel)
+        stickerPanel->setVisible(showSticker);
+    if (keytagPanel)
+        keytagPanel->setVisible(showKeytag);
+}
 
-        if (qty > 1) {
-            templateName = "LABEL.ZPL";
+//
+// Vehicle recall
+//
+void OilLabelGUI::attachRecall(QLineEdit *edit, VehicleIndex::Key key)
+{
+    QStandardItemModel *matches = new QStandardItemModel(this);
+    QCompleter *completer = new QCompleter(matches, this);
+    completer->setWidget(edit);   // not setCompleter(): we fill the fields ourselves
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(RecallMatches);
+
+    connect(edit, &QLineEdit::textEdited, this, [this, matches, completer, key](const QString &text) {
+        waitForStores();
+        const QString prefix = VehicleIndex::normalize(text);
+        matches->clear();
+        for (int record : vehicles->search(key, text, RecallMatches)) {
+            const VehicleRecord &r = vehicles->record(record);
+            QString keyText = key == VehicleIndex::Plate ? r.plate : r.vin;
+            if (key == VehicleIndex::RepairOrder) {
+                for (const QString &ro : r.repairOrders) {
+                    if (VehicleIndex::normalize(ro).startsWith(prefix))
+                        keyText = ro;
+                }
+            }
+            QStringList parts = { keyText, r.customer, r.car, r.color };
+            parts.removeAll(QString());
+            QStandardItem *item = new QStandardItem(parts.join("  "));
+            item->setData(record, Qt::UserRole);
+            if (key == VehicleIndex::RepairOrder)
+                item->setData(keyText, Qt::UserRole + 1);
+            matches->appendRow(item);
         }
+        if (matches->rowCount() > 0)
+            completer->complete();
+        else
+            completer->popup()->hide();
+    });
 
-        QString zpl = QString(
-        "^XA\n"
-        "^PQ%8\n"
-        "^XF%1^FS\n"
-        "^FN2^FD%2^FS\n"
-        "^FN3^FD%3^FS\n"
-        "^FN4^FD%4^FS\n"
-        "^FN5^FD%5^FS\n"
-        "^FN6^FD%6^FS\n"
-        "^FN7^FD%7^FS\n"
-        "^XZ"
-        )
-        .arg(templateName)
-        .arg(customerInput->text().trimmed())
-        .arg(carInput->text().trimmed())
-        .arg(plateInput->text().trimmed())
-        .arg(vinInput->text().trimmed())
-        .arg(colorInput->text().trimmed())
-        .arg(repairOrderInput->text().trimmed())
-        .arg(qty);
-
-
-        if (printerName.isEmpty()) {
-            QMessageBox::warning(this, "No Printer Selected", "Please select a printer in Settings.");
-            return;
-        }
-    // Print via sendZplToPrinter function
-    sendZplToPrinter(zpl, keytagPrinterName);
+    connect(completer, qOverload<const QModelIndex &>(&QCompleter::activated), this,
+        [this](const QModelIndex &index) {
+            recallVehicle(index.data(Qt::UserRole).toInt(), index.data(Qt::UserRole + 1).toString());
+        });
+}
+
+void OilLabelGUI::recallVehicle(int record, const QString &repairOrder)
+{
+    if (record < 0 || record >= vehicles->count())
+        return;
+
+    // A plate or VIN match is a new visit, so the RO is left alone.
+    const VehicleRecord &r = vehicles->record(record);
+    customerInput->setText(r.customer);
+    carInput->setText(r.car);
+    plateInput->setText(r.plate);
+    vinInput->setText(r.vin);
+    colorInput->setText(r.color);
+    if (!repairOrder.isEmpty())
+        repairOrderInput->setText(repairOrder);
+
+    currentVehicle = record;
+    prefillSticker();
+}
 
+void OilLabelGUI::prefillSticker()
+{
+    const VehicleRecord &r = vehicles->record(currentVehicle);
+    if (r.oilType.isEmpty() && r.interval.isEmpty())
+        return;
+    ensureStickerPanel();
+    if (!r.oilType.isEmpty())
+        oilTypeInput->setText(r.oilType);
+    if (!r.interval.isEmpty())
+        intervalInput->setText(r.interval);
+}
+
+//
+// Batch Print
+//
+void OilLabelGUI::openBatchPrint()
+{
+    BatchPrintDialog *dialog = new BatchPrintDialog(printQueue,
+        [this](const QByteArray &zpl, const QString &printer) {
+            return sendZplToPrinter(zpl, printer);
+        }, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setPrinters(printerName, keytagPrinterName);
+    dialog->setDefaultMiles(defaultMiles);
+    dialog->setFormatMode(formatMode());
+    dialog->show();
+}
+
+//
+// Reprint from the journal
+//
+void OilLabelGUI::reprint()
+{
+    waitForStores();
+    const QList<JournalEntry> entries = journal->recent(ReprintListSize);
+    if (entries.isEmpty()) {
+        QMessageBox::information(this, "Reprint",
+            journal->isOpen() ? QString("Nothing has been printed yet.")
+                              : QString("The print journal could not be opened."));
+        return;
     }
 
+    QStringList items;
+    for (const JournalEntry &e : entries) {
+        QString status = e.status == JournalEntry::Printed ? "printed"
+                       : e.status == JournalEntry::Failed  ? "FAILED"
+                                                            : "no result";
+        items << QString("#%1  %2  %3  %4  (%5)")
+                     .arg(e.id)
+                     .arg(QLocale().toString(e.time, QLocale::ShortFormat))
+                     .arg(e.printer, e.summary(), status);
+    }
 
-    // Auto-closing message box with printer name
-    QMessageBox *msgBox = new QMessageBox(this);
-    msgBox->setWindowTitle("Printed");
-    if (labelStyle == "DEFAULT") {
-        msgBox->setText(QString("Label sent to printer: %1").arg(printerName));
+    bool ok = false;
+    const QString choice = QInputDialog::getItem(this, "Reprint",
+        "Send a past job again, exactly as it was sent:", items, 0, false, &ok);
+    if (!ok)
+        return;
+
+    // Same bytes to the same printer; the form is not involved.
+    const JournalEntry &e = entries.at(items.indexOf(choice));
+    sendZplToPrinter(e.zpl, e.printer, e.hasFields ? &e.job : nullptr, e.id);
+}
+
+ZplTemplate::Mode OilLabelGUI::formatMode() const
+{
+    return inlineFormats ? ZplTemplate::Inline : ZplTemplate::Recall;
+}
+
+//
+// Snapshot of the form as a LabelJob
+//
+LabelJob OilLabelGUI::currentJob() const
+{
+    return jobForStyle(labelStyle);
+}
+
+LabelJob OilLabelGUI::jobForStyle(const QString &style) const
+{
+    // The template setting belongs to the style on screen; the other style
+    // of a vehicle ticket uses its stock format.
+    LabelJob job;
+    job.style = style;
+    if (style == labelStyle)
+        job.templateName = templateName;
+    job.logo = TemplateSync::logoPlacement(style);
+
+    // A panel that was never built was never typed in.
+    if (style == "DEFAULT" ? !stickerPanel : !keytagPanel)
+        return job;
+
+    if (style == "DEFAULT") {
+        job.mileage = mileageInput->text();
+        job.interval = intervalInput->text();
+        job.oilType = oilTypeInput->text();
     } else {
-        msgBox->setText(QString("Label sent to printer: %1").arg(keytagPrinterName));
-    }
-    msgBox->setIcon(QMessageBox::Information);
-    msgBox->setStandardButtons(QMessageBox::NoButton);
-    msgBox->show();
-    QTimer::singleShot(3000, msgBox, &QMessageBox::accept);
+        job.customer = customerInput->text();
+        job.car = carInput->text();
+        job.plate = plateInput->text();
+        job.vin = vinInput->text();
+        job.color = colorInput->text();
+        job.repairOrder = repairOrderInput->text();
 
-    clearInputs();
+        bool okQty;
+        job.quantity = quantityInput->text().toInt(&okQty);
+        if (!okQty || job.quantity < 1) job.quantity = 1;
+    }
+    return job;
 }
 
 //
@@ -498,21 +749,32 @@ void OilLabelGUI::printLabel()
 void OilLabelGUI::clearInputs()
 {
     // Clear fields except keep nextService (intervalInput) as requested
-    mileageInput->clear();
-    oilTypeInput->clear();
-    customerInput->clear();
-    carInput->clear();
-    plateInput->clear();
-    vinInput->clear();
-    colorInput->clear();
-    repairOrderInput->clear();
-    quantityInput->setText("1");
+    if (stickerPanel) {
+        mileageInput->clear();
+        oilTypeInput->clear();
+    }
+    if (keytagPanel) {
+        customerInput->clear();
+        carInput->clear();
+        plateInput->clear();
+        vinInput->clear();
+        colorInput->clear();
+        repairOrderInput->clear();
+        quantityInput->setText("1");
+    }
+
+    // An interval recalled for the last vehicle is not the next one's.
+    if (currentVehicle >= 0) {
+        if (stickerPanel)
+            intervalInput->setText(QString::number(defaultMiles));
+        currentVehicle = -1;
+    }
 
     // Reset template inputs to stored templateName
-    templateInput->setText(templateName);
-    kt_templateInput->setText(templateName);
+    showTemplateName();
 
-    preview->updatePreview(QString(), QString(), QString(), QString());
+    // Blank the preview now rather than on the next frame.
+    fieldModel->flush();
 }
 
 //
@@ -520,95 +782,239 @@ void OilLabelGUI::clearInputs()
 //
 void OilLabelGUI::selectPrinter()
 {
-    QProcess process;
-    process.start("lpstat", QStringList() << "-a");
-    process.waitForFinished(1500);
+    // The list comes from the background discovery cache, so the picker
+    // opens at once; a stale cache is refreshed for next time.
+    const QList<DiscoveredPrinter> found = discovery->printers();
+    if (!discovery->isScanning()
+        && (!discovery->lastScan().isValid()
+            || discovery->lastScan().secsTo(QDateTime::currentDateTime()) > DiscoveryMaxAgeSecs))
+        refreshPrinters();
+
+    // Without any CUPS queue, print straight to the network printer.
+    if (discovery->lastScan().isValid())
+        useIppPrinting = !discovery->hasSpoolerQueues();
 
-    QString output = process.readAllStandardOutput().trimmed();
-    QString error  = process.readAllStandardError().trimmed();
+    bool isKeyTag = (labelStyle == "KEYTAG");
+    QString current = isKeyTag ? keytagPrinterName : printerName;
+
+    QStringList items;
+    int currentIndex = -1;
+    for (const DiscoveredPrinter &p : found) {
+        if (p.name == current)
+            currentIndex = items.size();
+        items << p.displayText();
+    }
+    if (currentIndex < 0 && !current.isEmpty()) {
+        items.prepend(current);
+        currentIndex = 0;
+    }
 
-    QStringList printers;
+    QString prompt;
+    if (items.isEmpty()) {
+        prompt = discovery->isScanning()
+            ? "Searching for printers... Enter printer IP or hostname:"
+            : "No printers detected. Enter printer IP or hostname:";
+    } else {
+        prompt = isKeyTag
+            ? "Select Keytag Printer (or type an IP or hostname):"
+            : "Select Default Label Printer (or type an IP or hostname):";
+    }
 
-    bool lpstatFailed =
-        output.isEmpty() ||
-        output.contains("not recognized", Qt::CaseInsensitive) ||
-        error.contains("not recognized", Qt::CaseInsensitive) ||
-        error.contains("lpstat", Qt::CaseInsensitive);
+    bool ok;
+    QString choice = QInputDialog::getItem(
+        this,
+        isKeyTag ? "Select Keytag Printer" : "Select Printer",
+        prompt,
+        items,
+        qMax(0, currentIndex),
+        true,
+        &ok
+    ).trimmed();
 
-    useIppPrinting = lpstatFailed;
+    if (!ok || choice.isEmpty())
+        return;
 
-    if (!lpstatFailed) {
-        for (const QString &line : output.split('\n', Qt::SkipEmptyParts)) {
-            printers << line.split(' ').first();
+    // A picked entry maps back to its queue name / address; anything else
+    // was typed in. Discovery knows which are CUPS queues; record that with
+    // the printer so jobs never have to ask the spooler.
+    QString printer = choice;
+    QString kind;
+    for (const DiscoveredPrinter &p : found) {
+        if (p.displayText() == choice || p.name == choice) {
+            printer = p.name;
+            kind = p.source == "cups" ? "queue" : "network";
+            break;
         }
     }
+    if (kind.isEmpty() && RawPrinterTransport::isNetworkAddress(printer))
+        kind = "network";
+    if (!kind.isEmpty())
+        SettingsStore::instance().setPrinterKind(printer, kind);
 
-    // If none found prompt for IP (Windows-style)
-    if (printers.isEmpty()) {
-        QSettings settings("WFWestHS", "OilStickerApp");
-        bool isKeyTag = (labelStyle == "KEYTAG");
-        QString settingsKey = isKeyTag
-            ? "keytagPrinterName"
-            : "printerName";
-        QString storedIP = settings.value(settingsKey, "").toString();
-        bool ok = false;
-        QString ip = QInputDialog::getText(
-            this,
-            isKeyTag ? "Enter Keytag Printer IP" : "Enter Label Printer IP",
-            "No printers detected. Enter printer IP or hostname:",
-            QLineEdit::Normal,
-            storedIP,
-            &ok
-        );
-
-        if (ok && !ip.isEmpty()) {
-            if (isKeyTag) {
-                keytagPrinterName = ip;
-            } else {
-                printerName = ip;
-            }
-
-            settings.setValue(settingsKey, ip);
-        }
+    if (isKeyTag) {
+        keytagPrinterName = printer;
+        SettingsStore::instance().setKeytagPrinterName(printer);
+    } else {
+        printerName = printer;
+        SettingsStore::instance().setPrinterName(printer);
+    }
+    updateQueueStatus();
+    watchPrinters();
+    syncFormats();
+    updatePreviewFormat();
+}
 
-        return;  // important: stop further printer selection logic
+//
+// Background printer discovery
+//
+void OilLabelGUI::refreshPrinters()
+{
+    // Saved network printers are probed too, even outside the local /24.
+    QStringList hosts;
+    for (const QString &p : { printerName, keytagPrinterName }) {
+        if (!p.isEmpty() && PrintQueue::isNetworkPrinter(p))
+            hosts << p;
     }
+    discovery->refresh(hosts);
+}
 
+// The sheet is only worth its space when the job prints more than one label.
+void OilLabelGUI::updateSheet()
+{
+    const bool show = labelStyle == "KEYTAG" && sheet->labelCount() > 1;
+    if (show == sheet->isVisible())
+        return;
+    sheet->setVisible(show);
+    adjustSize();
+}
 
-    QString preselectedPrinter =
-    (labelStyle == "KEYTAG")
-        ? keytagPrinterName
-        : printerName;
+// The preview rasterizes the template this style prints with, at the
+// resolution discovery reported for its printer (203 dpi if unknown).
+void OilLabelGUI::updatePreviewFormat()
+{
+    preview->setTemplateName(templateName);
 
-    int currentIndex = printers.indexOf(preselectedPrinter);
-    if (currentIndex < 0)
-        currentIndex = 0;
+    const QString printer = (labelStyle == "KEYTAG") ? keytagPrinterName : printerName;
+    preview->setPrinterDpi(printerDpi(printer));
+}
+
+int OilLabelGUI::printerDpi(const QString &printer) const
+{
+    for (const DiscoveredPrinter &p : discovery->printers()) {
+        if (p.name == printer && p.dpi > 0)
+            return p.dpi;
+    }
+    return ZplRasterizer::DefaultDpi;
+}
 
+//
+// Select Network Protocol
+//
+void OilLabelGUI::selectNetworkProtocol()
+{
+    const QStringList options = {
+        "Raw ZPL (port 9100)",
+        "IPP (port 631)"
+    };
 
     bool ok;
-    QString printer = QInputDialog::getItem(
+    QString choice = QInputDialog::getItem(
         this,
-        "Select Printer",
-        labelStyle == "KEYTAG"
-        ? "Select Keytag Printer:"
-        : "Select Default Label Printer:",
-        printers,
-        currentIndex,
+        "Network Protocol",
+        "Protocol for printers entered by IP address:",
+        options,
+        networkProtocol == "IPP" ? 1 : 0,
         false,
         &ok
     );
 
-    QSettings settings("WFWestHS", "OilStickerApp");
-    if (ok && !printer.isEmpty()) {
-    if (labelStyle == "KEYTAG") {
-        keytagPrinterName = printer;
-        settings.setValue("keytagPrinterName", printer);
-    } else {
-        printerName = printer;
-        settings.setValue("printerName", printer);
+    if (ok && !choice.isEmpty()) {
+        networkProtocol = (choice == options.at(1)) ? "IPP" : "RAW";
+        SettingsStore::instance().setNetworkProtocol(networkProtocol);
+        watchPrinters();
+    }
+}
+
+//
+// Sync stored formats
+//
+void OilLabelGUI::syncFormats()
+{
+    // Inline mode sends the whole format with every label; only the logo
+    // graphic still has to be stored.
+    const bool logo = !SettingsStore::instance().logoGraphic().isEmpty();
+    if (inlineFormats && !logo)
+        return;
+
+    // printer -> formats it recalls
+    QStringList printers;
+    QHash<QString, QStringList> formats;
+    auto need = [&](const QString &printer, const QString &format) {
+        if (printer.isEmpty() || ZplTemplateLibrary::instance().source(format).isEmpty())
+            return;
+        if (!formats.contains(printer))
+            printers << printer;
+        if (!formats[printer].contains(format))
+            formats[printer] << format;
+    };
+    if (!inlineFormats) {
+        need(printerName, "DEFAULT.ZPL");
+        need(printerName, templateName.toUpper());
+        need(keytagPrinterName, "KEYTAG.ZPL");
+        need(keytagPrinterName, "LABEL.ZPL");
     }
+    for (const QString &printer : { printerName, keytagPrinterName }) {
+        if (logo && !printer.isEmpty() && !printers.contains(printer))
+            printers << printer;
     }
 
+    for (const QString &printer : std::as_const(printers)) {
+        PrintTransport transport = PrintQueue::transportFor(printer, useIppPrinting, networkProtocol);
+        printQueue->syncTemplates(printer, transport, formats.value(printer), printerDpi(printer));
+    }
+}
+
+void OilLabelGUI::watchPrinters()
+{
+    QHash<QString, PrintTransport> printers;
+    for (const QString &printer : { printerName, keytagPrinterName }) {
+        if (!printer.isEmpty())
+            printers.insert(printer, PrintQueue::transportFor(printer, useIppPrinting, networkProtocol));
+    }
+    printQueue->monitorPrinters(printers);
+    updatePrinterStatus();
+}
+
+void OilLabelGUI::updatePrinterStatus()
+{
+    QStringList printers;
+    if (!printerName.isEmpty()) printers << printerName;
+    if (!keytagPrinterName.isEmpty() && keytagPrinterName != printerName) printers << keytagPrinterName;
+
+    QStringList parts;
+    for (const QString &p : printers) {
+        const PrinterStatus status = printQueue->status(p);
+        QString color = "gray";
+        QString summary = status.summary();
+        if (status.isFaulted())
+            color = "red";
+        else if (status.known && status.reachable)
+            color = "green";
+        else if (!status.known && !CupsPrinterBackend::isAvailable()
+                 && PrintQueue::transportFor(p, useIppPrinting, networkProtocol) == PrintTransport::Spooler)
+            summary = "No status (printing with lpr)";
+        parts << QString("<span style=\"color:%1\">&#9679;</span> %2: %3")
+                     .arg(color, p.toHtmlEscaped(), summary.toHtmlEscaped());
+    }
+    printerStatusLabel->setText(parts.join("&nbsp;&nbsp;&nbsp;"));
+}
+
+void OilLabelGUI::onTemplatesSynced(const QString &printer, bool ok, const QString &summary)
+{
+    if (!ok)
+        qWarning() << "Format sync for" << printer << "failed:" << summary;
+    lastFormatStatus = QString("%1 %2").arg(printer, summary);
+    updateQueueStatus();
 }
 
 //
@@ -616,12 +1022,11 @@ void OilLabelGUI::selectPrinter()
 //
 void OilLabelGUI::changeBackground()
 {
-    QSettings settings("WFWestHS", "OilStickerApp");
+    SettingsStore &settings = SettingsStore::instance();
 
-    QString lastFolder = settings.value(
-        "backgroundFolder",
-        QStandardPaths::writableLocation(QStandardPaths::DownloadLocation)
-    ).toString();
+    QString lastFolder = settings.backgroundFolder();
+    if (lastFolder.isEmpty())
+        lastFolder = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
 
     QFileDialog dialog(this, "Select Background PNG", lastFolder);
     dialog.setNameFilter("PNG Images (*.png)");
@@ -639,18 +1044,13 @@ void OilLabelGUI::changeBackground()
     if (!fileName.isEmpty()) {
         backgroundPath = fileName;
 
-        bool isKeyTag = (labelStyle == "KEYTAG");
-        settings.setValue(
-            isKeyTag ? "keytagBackground" : "defaultBackground",
-            backgroundPath
-        );
+        settings.setBackground(labelStyle, backgroundPath);
 
         QFileInfo fi(fileName);
-        settings.setValue("backgroundFolder", fi.absolutePath());
+        settings.setBackgroundFolder(fi.absolutePath());
     } else {
         //QString savedBg = settings.value("background", "").toString();
-        QString savedBg = settings.value(
-        labelStyle == "KEYTAG" ? "keytagBackground": "defaultBackground","").toString();
+        QString savedBg = settings.background(labelStyle);
 
         if (!savedBg.isEmpty() && !QFile::exists(savedBg)) {
             if (labelStyle == "KEYTAG")
@@ -658,8 +1058,7 @@ void OilLabelGUI::changeBackground()
             else
                 backgroundPath = ":/resources/default.png";
             //settings.setValue("background", backgroundPath);
-            bool isKeyTag = (labelStyle == "KEYTAG");
-            settings.setValue(isKeyTag ? "keytagBackground" : "defaultBackground",backgroundPath);
+            settings.setBackground(labelStyle, backgroundPath);
 
         }
     }
@@ -667,6 +1066,78 @@ void OilLabelGUI::changeBackground()
     preview->setBackground(backgroundPath);
 }
 
+//
+// Label logo
+//
+void OilLabelGUI::selectLogo()
+{
+    SettingsStore &settings = SettingsStore::instance();
+
+    QString lastFolder = settings.backgroundFolder();
+    if (lastFolder.isEmpty())
+        lastFolder = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
+
+    QFileDialog dialog(this, "Select Label Logo PNG", lastFolder);
+    dialog.setNameFilter("PNG Images (*.png)");
+    dialog.setFileMode(QFileDialog::ExistingFile);
+    dialog.setOption(QFileDialog::DontUseNativeDialog, true);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    const QString fileName = dialog.selectedFiles().first();
+
+    // Same conversion the print thread does before ~DG for this style's
+    // printer; a few ms for a full 2" logo.
+    const QString printer = (labelStyle == "KEYTAG") ? keytagPrinterName : printerName;
+    const ZplGraphic graphic = TemplateSync::logoGraphic(fileName, printerDpi(printer));
+    if (graphic.isNull()) {
+        QMessageBox::warning(this, "Label Logo", QString("Cannot read %1.").arg(fileName));
+        return;
+    }
+
+    // Where it goes on labels of the style on screen, in dots from the
+    // top left corner of the label. Left empty, this style gets no logo.
+    const QPoint current = settings.logoPosition(labelStyle);
+    bool ok;
+    const QString input = QInputDialog::getText(
+        this,
+        "Label Logo",
+        QString("Logo position on %1 labels, in dots from the top left (x,y),
+"
+                "or empty to leave it off %1 labels:").arg(labelStyle),
+        QLineEdit::Normal,
+        current.x() < 0 ? QString() : QString("%1,%2").arg(current.x()).arg(current.y()),
+        &ok
+    );
+    if (!ok)
+        return;
+    QPoint position(-1, -1);
+    if (!input.trimmed().isEmpty()) {
+        const QStringList xy = input.split(',');
+        bool okX = false, okY = false;
+        position = QPoint(xy.value(0).trimmed().toInt(&okX), xy.value(1).trimmed().toInt(&okY));
+        if (xy.size() != 2 || !okX || !okY || position.x() < 0 || position.y() < 0) {
+            QMessageBox::warning(this, "Label Logo", "Enter the position as two numbers, e.g. 20,20.");
+            return;
+        }
+    }
+
+    settings.setLogoGraphic(fileName);
+    settings.setLogoPosition(labelStyle, position);
+    settings.setBackgroundFolder(QFileInfo(fileName).absolutePath());
+    syncFormats();
+
+    const QString placement = position.x() < 0
+        ? QString("It is not placed on %1 labels.").arg(labelStyle)
+        : QString("It is placed at %1,%2 on every %3 label.").arg(position.x()).arg(position.y()).arg(labelStyle);
+    QMessageBox::information(this, "Label Logo",
+        QString("%1 is stored on the printers as %2:%3 (%4 x %5 dots, %6 bytes to send instead of %7).\n\n%8")
+            .arg(QFileInfo(fileName).fileName())
+            .arg(TemplateSync::Drive).arg(TemplateSync::LogoName)
+            .arg(graphic.width()).arg(graphic.height())
+            .arg(graphic.encoded().size()).arg(graphic.uncompressedHexSize())
+            .arg(placement));
+}
+
 //
 // Select Template
 //
@@ -684,11 +1155,10 @@ void OilLabelGUI::selectTemplate()
 
     if (ok && !input.isEmpty()) {
         templateName = input.toUpper();
-        QSettings settings("WFWestHS", "OilStickerApp");
-        settings.setValue("template", templateName);
+        SettingsStore::instance().setTemplateName(templateName);
         // update displayed template fields
-        templateInput->setText(templateName);
-        kt_templateInput->setText(templateName);
+        showTemplateName();
+        updatePreviewFormat();
     }
 }
 
@@ -705,9 +1175,8 @@ void OilLabelGUI::resetSettings()
     );
 
     if (reply == QMessageBox::Yes) {
-        QSettings settings("WFWestHS", "OilStickerApp");
-        settings.clear();
-        settings.sync();
+        // Written out by the store as the application exits.
+        SettingsStore::instance().clear();
         QMessageBox::information(this, "Settings Reset",
                                  "All settings have been cleared.\nPlease restart the application.");
         qApp->quit();
@@ -759,65 +1228,34 @@ void OilLabelGUI::onStyleChanged(const QString &style)
     QString s = style.toUpper();
     if (s == "KEY TAG") s = "KEYTAG";
 
-    QSettings settings("WFWestHS", "OilStickerApp");
+    SettingsStore &settings = SettingsStore::instance();
 
     if (s == "KEYTAG") {
         labelStyle = "KEYTAG";
         templateName = "KEYTAG.ZPL";
-        backgroundPath = settings.value(
-            "keytagBackground",
-            ":/resources/keytag.png"
-        ).toString();
     } else {
         labelStyle = "DEFAULT";
         templateName = "DEFAULT.ZPL";
-        backgroundPath = settings.value(
-            "defaultBackground",
-            ":/resources/default.png"
-        ).toString();
-}
-
+    }
+    backgroundPath = settings.background(labelStyle);
 
     // persist
-    //QSettings settings("WFWestHS", "OilStickerApp");
-    settings.setValue("labelStyle", labelStyle);
-    settings.setValue("template", templateName);
+    settings.setLabelStyle(labelStyle);
+    settings.setTemplateName(templateName);
 
     // update UI visibility
-    bool isKeyTag = (labelStyle == "KEYTAG");
-    templateLabel->setVisible(0);
-    templateInput->setVisible(0);
-    mileageLabel->setVisible(!isKeyTag);
-    mileageInput->setVisible(!isKeyTag);
-    intervalLabel->setVisible(!isKeyTag);
-    intervalInput->setVisible(!isKeyTag);
-    oilTypeLabel->setVisible(!isKeyTag);
-    oilTypeInput->setVisible(!isKeyTag);
-
-    kt_templateLabel->setVisible(0);
-    kt_templateInput->setVisible(0);
-    customerLabel->setVisible(isKeyTag);
-    customerInput->setVisible(isKeyTag);
-    carLabel->setVisible(isKeyTag);
-    carInput->setVisible(isKeyTag);
-    plateLabel->setVisible(isKeyTag);
-    plateInput->setVisible(isKeyTag);
-    vinLabel->setVisible(isKeyTag);
-    vinInput->setVisible(isKeyTag);
-    colorLabel->setVisible(isKeyTag);
-    colorInput->setVisible(isKeyTag);
-    repairOrderLabel->setVisible(isKeyTag);
-    repairOrderInput->setVisible(isKeyTag);
-    quantityLabel->setVisible(isKeyTag);
-    quantityInput->setVisible(isKeyTag);
+    updateFieldVisibility();
+    updateSheet();
 
     // update preview style / background
     preview->setLabelStyle(labelStyle);
     preview->setBackground(backgroundPath);
+    updatePreviewFormat();
+    fieldModel->setStyle(labelStyle);
+    fieldModel->flush();
 
     // update template inputs
-    templateInput->setText(templateName);
-    kt_templateInput->setText(templateName);
+    showTemplateName();
 
     // Adjust window size
     if (labelStyle == "KEYTAG")
@@ -829,69 +1267,93 @@ void OilLabelGUI::onStyleChanged(const QString &style)
 //
 // Print ZPL
 //
-void OilLabelGUI::sendZplToPrinter(const QString &zpl, const QString &printer)
+quint64 OilLabelGUI::sendZplToPrinter(const QByteArray &zpl, const QString &printer,
+                                      const LabelJob *job, quint64 reprintOf)
 {
     if (printer.isEmpty()) {
         QMessageBox::warning(this, "No Printer Selected",
                              "Please select a printer in Settings.");
-        return;
+        return 0;
     }
 
-    if (!useIppPrinting) {
-        // -----------------------------
-        // CUPS / lpr path (macOS, Linux)
-        // -----------------------------
-        QProcess lp;
-        QStringList args;
-        args << "-P" << printer << "-o" << "raw";
-
-        lp.start("lpr", args);
-        lp.write(zpl.toUtf8());
-        lp.closeWriteChannel();
+    // CUPS queues go through the spooler; network printers (IP/hostname)
+    // get raw ZPL on port 9100 or an IPP Print-Job, per the Network
+    // Protocol setting. Either way the work happens on the print thread
+    // and this returns immediately; if the printer cannot be reached the
+    // job waits in the on-disk spool until it can.
+    PrintTransport transport = PrintQueue::transportFor(printer, useIppPrinting, networkProtocol);
+    waitForStores();
+    quint64 entryId = journal->append(printer, zpl, job, reprintOf);
+    quint64 id = printQueue->enqueue(printer, zpl, transport);
+    if (id && entryId)
+        journalIds.insert(id, entryId);
+    return id;
+}
 
-        if (!lp.waitForFinished(3000)) {
-            QMessageBox::warning(this, "Print Error",
-                                 "lpr did not finish sending the job.");
-        }
+//
+// Journal and vehicle index
+//
+void OilLabelGUI::waitForStores()
+{
+    if (storesReady)
+        return;
+    storeLoader.waitForDone();
+    storesReady = true;
+}
 
-    } else {
-        // -----------------------------
-        // IPP / HTTP path (Windows)
-        // -----------------------------
-        QNetworkAccessManager *networkManager =
-            new QNetworkAccessManager(this);
-
-        // NOTE:
-        // Port 9100 is *RAW socket*, not IPP.
-        // Zebra IPP is usually :631/ipp/print
-        QUrl printerUrl(
-            QString("http://%1:9100/ipp/print").arg(printer)
-        );
-
-        QNetworkRequest request(printerUrl);
-        request.setHeader(
-            QNetworkRequest::ContentTypeHeader,
-            "application/ipp"
-        );
-
-        QNetworkReply *reply =
-            networkManager->post(request, zpl.toUtf8());
-
-        connect(reply, &QNetworkReply::finished, this,
-            [this, reply]() {
-                if (reply->error() == QNetworkReply::NoError) {
-                    QMessageBox::information(
-                        this, "Printed",
-                        "Label sent to printer successfully."
-                    );
-                } else {
-                    QMessageBox::warning(
-                        this, "Print Error",
-                        QString("Failed to send label:\n%1")
-                            .arg(reply->errorString())
-                    );
-                }
-                reply->deleteLater();
-            });
+//
+// Print job results (from the print thread)
+//
+void OilLabelGUI::onPrintJobFinished(quint64 id, const QString &printer, bool ok, const QString &message)
+{
+    if (quint64 entryId = journalIds.take(id))
+        journal->setResult(entryId, ok, message);
+
+    if (!ok) {
+        QMessageBox *errBox = new QMessageBox(QMessageBox::Warning, "Print Error",
+            QString("Failed to send label to %1:\n%2").arg(printer, message),
+            QMessageBox::Ok, this);
+        errBox->setAttribute(Qt::WA_DeleteOnClose);
+        errBox->show();
+        return;
     }
+
+    // Auto-closing message box with printer name
+    QMessageBox *msgBox = new QMessageBox(this);
+    msgBox->setAttribute(Qt::WA_DeleteOnClose);
+    msgBox->setWindowTitle("Printed");
+    msgBox->setText(message);
+    msgBox->setIcon(QMessageBox::Information);
+    msgBox->setStandardButtons(QMessageBox::NoButton);
+    msgBox->show();
+    QTimer::singleShot(3000, msgBox, &QMessageBox::accept);
+}
+
+void OilLabelGUI::updateQueueStatus()
+{
+    QStringList parts;
+    QStringList printers;
+    if (!printerName.isEmpty()) printers << printerName;
+    if (!keytagPrinterName.isEmpty() && keytagPrinterName != printerName) printers << keytagPrinterName;
+
+    for (const QString &p : printers)
+        parts << QString("%1: %2").arg(p).arg(printQueue->depth(p));
+
+    QString text = parts.isEmpty()
+        ? QString("Print queue: no printer selected")
+        : QString("Print queue - %1").arg(parts.join("  |  "));
+    if (!lastSpoolerStatus.isEmpty())
+        text += QString("\nLast job: %1").arg(lastSpoolerStatus);
+    if (!lastFormatStatus.isEmpty())
+        text += QString("\nFormats: %1").arg(lastFormatStatus);
+    queueStatusLabel->setText(text);
+}
+
+void OilLabelGUI::onPrintJobStateChanged(quint64 id, const QString &printer, int spoolerJobId, const QString &state)
+{
+    Q_UNUSED(id);
+    lastSpoolerStatus = spoolerJobId > 0
+        ? QString("%1 job %2 %3").arg(printer).arg(spoolerJobId).arg(state)
+        : QString("%1 %2").arg(printer, state);
+    updateQueueStatus();
 }
@@ -0,0 +1,563 @@
+// src/PreviewBenchmark.cpp
+#include "PreviewBenchmark.hpp"
+#include "HeadlessRunner.hpp"
+#include "LabelPreview.hpp"
+#include "LabelFieldModel.hpp"
+#include "LabelJob.hpp"
+#include "ZplRasterizer.hpp"
+#include "version.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QEvent>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QTextStream>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <algorithm>
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+constexpr int FrameTimeoutMs = 1000;
+
+// Renders compared against PNGs under the samples directory. Reference
+// images come from the printer / Labelary and are never overwritten;
+// the others are our own renders, refreshed with --update-golden.
+//
+// Our own renders are the rasterizer's 1-bit dots for the sample job (what
+// the preview draws its fields from), not widget grabs, so they do not
+// depend on the platform's fonts or style. The embedded Zebra font can
+// still land a few edge dots differently between font engines.
+struct GoldenCase
+{
+    const char *name;
+    const char *zpl;          // samples/<zpl>, or null for the sample job
+    const char *style;        // sample job only
+    const char *golden;       // samples/<golden>
+    double tolerance;         // fraction of dots allowed to differ
+    bool reference;
+};
+
+const GoldenCase goldenCases[] = {
+    { "blanklabel",  "blanklabel.zpl", nullptr,   "blanklabel.png",         0.02,  true  },
+    { "default",     "default.zpl",    nullptr,   "default.png",            0.03,  true  },
+    { "job-DEFAULT", nullptr,          "DEFAULT", "golden/job-DEFAULT.png", 0.003, false },
+    { "job-KEYTAG",  nullptr,          "KEYTAG",  "golden/job-KEYTAG.png",  0.003, false },
+};
+
+void line(const QString &label, const QString &value)
+{
+    out() << "  " << label.leftJustified(24) << " " << value << "\n";
+    out().flush();
+}
+
+// The recall job for the fillSample() data, dated so the dates match.
+QByteArray sampleJob(const QString &style)
+{
+    LabelJob job;
+    job.style = style;
+    job.mileage = "128456";
+    job.interval = "5000";
+    job.oilType = "MOBIL1 0W40";
+    job.customer = "SMITH";
+    job.car = "2019 HONDA CIVIC";
+    job.plate = "ABC1234";
+    job.vin = "2HGFC2F59KH000000";
+    job.color = "BLUE";
+    job.repairOrder = "104233";
+    return job.toZpl(5000, ZplTemplate::Recall, QDate(2026, 10, 17));
+}
+
+// Fixed field data so renders do not change with the date.
+void fillSample(LabelPreview *preview, const QString &style)
+{
+    preview->setLabelStyle(style);
+    preview->updatePreview("133,456", "04/17/27", "MOBIL1 0W40", "10/17/26",
+                           "SMITH", "2019 HONDA CIVIC", "ABC1234",
+                           "2HGFC2F59KH000000", "BLUE", "104233");
+}
+
+} // namespace
+
+PreviewBenchmark::PreviewBenchmark(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool PreviewBenchmark::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg == "--bench" || arg == "--golden" || arg == "--update-golden"
+            || arg.startsWith("--bench-latency"))
+            return true;
+    }
+    return false;
+}
+
+int PreviewBenchmark::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Preview / ZPL benchmarks and golden-image checks.\n"
+        "Runs on the offscreen platform unless -platform is given.");
+    parser.addHelpOption();
+
+    QCommandLineOption benchOpt("bench", "Run every benchmark (paint, latency, ZPL).");
+    QCommandLineOption latencyOpt("bench-latency", "Only time <count> keystrokes to the painted preview.", "count");
+    QCommandLineOption quickOpt("quick", "Run a tenth of the iterations.");
+    QCommandLineOption goldenOpt("golden", "Diff renders against the PNGs in the samples directory.");
+    QCommandLineOption updateOpt("update-golden", "Rewrite samples/golden/ from the current renders.");
+    QCommandLineOption samplesOpt("samples", "Samples directory (default: ./samples).", "dir", "samples");
+    QCommandLineOption outOpt("out", "Where actual and diff images go (default: ./bench-out).", "dir", "bench-out");
+    QCommandLineOption jsonOpt("json", "Write all results as JSON to <file>.", "file");
+    QCommandLineOption baselineOpt("baseline", "Fail on regressions against a previous --json <file>.", "file");
+    QCommandLineOption regressionOpt("max-regression", "Allowed slowdown against the baseline, percent (default 20).",
+                                     "percent", "20");
+    parser.addOptions({ benchOpt, latencyOpt, quickOpt, goldenOpt, updateOpt, samplesOpt, outOpt,
+                        jsonOpt, baselineOpt, regressionOpt });
+
+    if (!parser.parse(arguments)) {
+        err() << parser.errorText() << "\n";
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        out() << parser.helpText();
+        return 0;
+    }
+
+    const int scale = parser.isSet(quickOpt) ? 10 : 1;
+    out() << QString("Platform: %1\n").arg(QGuiApplication::platformName());
+
+    bool ok = true;
+    QList<BenchmarkResult> results;
+    if (parser.isSet(latencyOpt)) {
+        int count = parser.value(latencyOpt).toInt();
+        ok = benchLatency(count > 0 ? count : 500, &results);
+    }
+    if (parser.isSet(benchOpt)) {
+        ok = benchPaint(500 / scale, &results) && ok;
+        if (!parser.isSet(latencyOpt))
+            ok = benchLatency(200 / scale, &results) && ok;
+        results << HeadlessRunner::benchZplCases(100000 / scale);
+    }
+
+    QList<GoldenResult> goldens;
+    if (parser.isSet(goldenOpt) || parser.isSet(updateOpt)) {
+        const bool update = parser.isSet(updateOpt);
+        goldens = checkGoldens(parser.value(samplesOpt), parser.value(outOpt), update);
+        // A golden that is not there checks nothing; only --update-golden
+        // may run without one.
+        for (const GoldenResult &g : goldens) {
+            if (g.status == "fail" || g.status == "error" || (g.status == "missing" && !update))
+                ok = false;
+        }
+    }
+
+    QStringList regressed;
+    if (parser.isSet(baselineOpt)) {
+        QFile file(parser.value(baselineOpt));
+        QJsonDocument doc;
+        if (file.open(QIODevice::ReadOnly))
+            doc = QJsonDocument::fromJson(file.readAll());
+        if (!doc.isObject()) {
+            err() << "Cannot read baseline " << file.fileName() << "\n";
+            return ExitUsage;
+        }
+        regressed = regressions(doc.object(), results, parser.value(regressionOpt).toDouble() / 100.0);
+        out() << QString("Baseline %1: %2 regression(s)\n").arg(file.fileName()).arg(regressed.size());
+        for (const QString &r : regressed)
+            out() << "  " << r << "\n";
+        if (!regressed.isEmpty())
+            ok = false;
+    }
+
+    if (parser.isSet(jsonOpt)) {
+        QJsonArray benchmarks;
+        for (const BenchmarkResult &r : results) {
+            benchmarks.append(QJsonObject{
+                { "name", r.name }, { "value", r.value }, { "unit", r.unit },
+                { "higherIsBetter", r.higherIsBetter },
+            });
+        }
+        QJsonArray images;
+        for (const GoldenResult &g : goldens) {
+            images.append(QJsonObject{
+                { "name", g.name }, { "status", g.status }, { "mismatch", g.mismatch },
+                { "tolerance", g.tolerance }, { "detail", g.detail },
+            });
+        }
+        const QString version = QString("%1.%2.%3.%4")
+            .arg(PROJECT_VERSION_MAJOR).arg(PROJECT_VERSION_MINOR)
+            .arg(PROJECT_VERSION_PATCH).arg(PROJECT_VERSION_BUILD);
+        const QJsonObject root{
+            { "version", version },
+            { "platform", QGuiApplication::platformName() },
+            { "time", QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+            { "ok", ok },
+            { "benchmarks", benchmarks },
+            { "golden", images },
+            { "regressions", QJsonArray::fromStringList(regressed) },
+        };
+        QFile file(parser.value(jsonOpt));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err() << "Cannot write " << file.fileName() << "\n";
+            return ExitFailed;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    return ok ? 0 : ExitFailed;
+}
+
+bool PreviewBenchmark::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint) {
+        ++paints;
+        lastPaintNs = clock.nsecsElapsed();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+//
+// Paint
+//
+bool PreviewBenchmark::benchPaint(int count, QList<BenchmarkResult> *results)
+{
+    out() << QString("Preview paint, %1 frames per case\n").arg(count);
+
+    LabelPreview preview;
+    clock.start();
+    preview.installEventFilter(this);
+    preview.show();
+    if (!waitForPaint(5000)) {
+        err() << "Preview never painted; is a platform plugin available?\n";
+        return false;
+    }
+    waitForPreview(&preview, 5000);
+
+    QElapsedTimer timer;
+    for (const QString &style : { QString("DEFAULT"), QString("KEYTAG") }) {
+        fillSample(&preview, style);
+        waitForPaint(FrameTimeoutMs);
+
+        // Whole widget, static layer already cached.
+        timer.start();
+        for (int i = 0; i < count; ++i)
+            preview.repaint();
+        const double full = timer.nsecsElapsed() / 1e3 / qMax(1, count);
+        line("full repaint " + style, QString("%1 us/frame").arg(full, 8, 'f', 1));
+        *results << BenchmarkResult{ "paint." + style + ".full", "full repaint " + style, full, "us", false };
+
+        // One field edited: re-rasterize it and repaint its rectangle.
+        const int field = (style == "KEYTAG") ? 5 : 4;
+        const QString values[2] = {
+            style == "KEYTAG" ? QString("2HGFC2F59KH000001") : QString("133,457"),
+            style == "KEYTAG" ? QString("2HGFC2F59KH000002") : QString("133,458"),
+        };
+        timer.start();
+        for (int i = 0; i < count; ++i) {
+            preview.setFields({ { field, values[i % 2] } });
+            if (!waitForPaint(FrameTimeoutMs)) {
+                err() << "No frame after field update " << i << "\n";
+                return false;
+            }
+        }
+        const double partial = timer.nsecsElapsed() / 1e3 / qMax(1, count);
+        line("field update " + style, QString("%1 us/frame").arg(partial, 8, 'f', 1));
+        *results << BenchmarkResult{ "paint." + style + ".field", "field update " + style, partial, "us", false };
+    }
+    return true;
+}
+
+//
+// Key event -> painted frame
+//
+bool PreviewBenchmark::benchLatency(int count, QList<BenchmarkResult> *results)
+{
+    // Same wiring as OilLabelGUI.
+    QWidget window;
+    QVBoxLayout *layout = new QVBoxLayout(&window);
+    LabelPreview *preview = new LabelPreview(&window);
+    QLineEdit *mileage = new QLineEdit(&window);
+    QLineEdit *vin = new QLineEdit(&window);
+    vin->setValidator(new UpperCaseValidator(vin));
+    layout->addWidget(preview);
+    layout->addWidget(mileage);
+    layout->addWidget(vin);
+
+    LabelFieldModel model;
+    connect(&model, &LabelFieldModel::fieldsChanged, preview, &LabelPreview::setFields);
+    connect(mileage, &QLineEdit::textChanged, &model, [&model](const QString &text) {
+        model.setInput(LabelFieldModel::Mileage, text);
+    });
+    connect(vin, &QLineEdit::textChanged, &model, [&model](const QString &text) {
+        model.setInput(LabelFieldModel::Vin, text);
+    });
+
+    clock.start();
+    preview->installEventFilter(this);
+    window.show();
+    if (!waitForPaint(5000)) {
+        err() << "Preview never painted; is a platform plugin available?\n";
+        return false;
+    }
+    waitForPreview(preview, 5000);
+
+    out() << QString("Key event to painted preview, %1 keystrokes\n").arg(count);
+
+    // Typing: one digit, then Backspace, each waited out to its frame.
+    model.setInput(LabelFieldModel::OilType, "MOBIL1 0W40");
+    mileage->setText("12345");
+    waitForPaint(FrameTimeoutMs);
+
+    QList<double> typing;
+    QElapsedTimer timer;
+    for (int i = 0; i < count; ++i) {
+        timer.start();
+        if (i % 2 == 0)
+            sendKey(mileage, Qt::Key_7, "7");
+        else
+            sendKey(mileage, Qt::Key_Backspace, QString());
+        if (!waitForPaint(FrameTimeoutMs)) {
+            err() << "No frame after keystroke " << i << "\n";
+            return false;
+        }
+        typing << timer.nsecsElapsed() / 1e6;
+    }
+
+    // Scanner: a whole VIN queued at once, then cleared.
+    preview->setLabelStyle("KEYTAG");
+    model.setStyle("KEYTAG");
+    model.flush();
+    waitForPaint(FrameTimeoutMs);
+
+    const QString code = "2hgfc2f59kh000000";
+    const int bursts = qMax(1, count / int(code.size()));
+    QList<double> burst;
+    int burstFrames = 0;
+    for (int i = 0; i < bursts; ++i) {
+        const int before = paints;
+        const qint64 start = clock.nsecsElapsed();
+        for (const QChar c : code)
+            sendKey(vin, c.isDigit() ? Qt::Key_0 + c.digitValue() : Qt::Key_A + (c.unicode() - 'a'), c, true);
+
+        timer.start();
+        while (vin->text().size() < code.size() && timer.elapsed() < FrameTimeoutMs)
+            QCoreApplication::processEvents();
+        // The last update trails the last key by at most one frame.
+        waitForPaint(4 * LabelFieldModel::FrameMs);
+        if (paints == before) {
+            err() << "No frame after burst " << i << "\n";
+            return false;
+        }
+        burst << (lastPaintNs - start) / 1e6;
+        burstFrames += paints - before;
+
+        vin->clear();
+        waitForPaint(FrameTimeoutMs);
+    }
+
+    const QList<double> t = percentiles(typing);
+    const QList<double> b = percentiles(burst);
+    const double framesPerBurst = double(burstFrames) / bursts;
+    line("typing DEFAULT", QString("median %1 ms  p95 %2 ms  max %3 ms")
+                               .arg(t[0], 6, 'f', 2).arg(t[1], 6, 'f', 2).arg(t[2], 6, 'f', 2));
+    line("scanner burst KEYTAG", QString("median %1 ms  p95 %2 ms  %3 frames/%4 keys")
+                                     .arg(b[0], 6, 'f', 2).arg(b[1], 6, 'f', 2)
+                                     .arg(framesPerBurst, 0, 'f', 1).arg(code.size()));
+
+    *results << BenchmarkResult{ "latency.typing.median", "typing median", t[0], "ms", false }
+             << BenchmarkResult{ "latency.typing.p95", "typing p95", t[1], "ms", false }
+             << BenchmarkResult{ "latency.burst.median", "scanner burst median", b[0], "ms", false }
+             << BenchmarkResult{ "latency.burst.frames", "frames per burst", framesPerBurst, "frames", false };
+    return true;
+}
+
+//
+// Golden images
+//
+QList<PreviewBenchmark::GoldenResult> PreviewBenchmark::checkGoldens(const QString &samplesDir,
+                                                                      const QString &outDir, bool update)
+{
+    const QDir samples(samplesDir);
+    const QDir output(outDir);
+    out() << QString("Golden images (%1)\n").arg(samples.absolutePath());
+    QDir().mkpath(outDir);
+    if (update)
+        samples.mkpath("golden");
+
+    QList<GoldenResult> list;
+    for (const GoldenCase &c : goldenCases) {
+        GoldenResult r;
+        r.name = c.name;
+        r.tolerance = c.tolerance;
+        const QString goldenPath = samples.filePath(c.golden);
+
+        QImage actual;
+        if (c.zpl) {
+            QFile file(samples.filePath(c.zpl));
+            if (file.open(QIODevice::ReadOnly))
+                actual = ZplRasterizer::renderJob(file.readAll());
+        } else {
+            actual = ZplRasterizer::renderJob(sampleJob(c.style));
+        }
+
+        if (actual.isNull()) {
+            r.status = "error";
+            r.detail = "nothing rendered";
+        } else {
+            actual.save(output.filePath(r.name + ".png"));
+            const QImage golden(goldenPath);
+            if (update && !c.reference) {
+                r.status = actual.save(goldenPath) ? "updated" : "error";
+                r.detail = goldenPath;
+            } else if (golden.isNull()) {
+                r.status = "missing";
+                r.detail = c.reference ? goldenPath : goldenPath + " (run --update-golden)";
+            } else {
+                QImage diff;
+                r.mismatch = compareInk(actual, golden, &diff);
+                if (r.mismatch < 0) {
+                    r.status = "fail";
+                    r.detail = QString("size %1x%2, golden %3x%4")
+                                   .arg(actual.width()).arg(actual.height())
+                                   .arg(golden.width()).arg(golden.height());
+                } else {
+                    r.status = r.mismatch <= c.tolerance ? "pass" : "fail";
+                    diff.save(output.filePath(r.name + "-diff.png"));
+                }
+            }
+        }
+
+        QString value = r.status;
+        if (r.status == "pass" || (r.status == "fail" && r.mismatch >= 0))
+            value += QString("  %1% differ (max %2%)").arg(r.mismatch * 100, 0, 'f', 3).arg(r.tolerance * 100);
+        if (!r.detail.isEmpty())
+            value += "  " + r.detail;
+        line(r.name, value);
+        list << r;
+    }
+    return list;
+}
+
+double PreviewBenchmark::compareInk(const QImage &actual, const QImage &golden, QImage *diff)
+{
+    // Compare what is printed, not how: both sides thresholded to ink/paper.
+    const QImage a = actual.convertToFormat(QImage::Format_Grayscale8);
+    const QImage g = golden.convertToFormat(QImage::Format_Grayscale8);
+    if (g.width() < a.width() || g.height() < a.height())
+        return -1;
+
+    // Reference renders include the label backing around the label.
+    const int ox = (g.width() - a.width()) / 2;
+    const int oy = (g.height() - a.height()) / 2;
+
+    *diff = QImage(a.size(), QImage::Format_RGB32);
+    qint64 differ = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        const uchar *pa = a.constScanLine(y);
+        const uchar *pg = g.constScanLine(y + oy) + ox;
+        QRgb *pd = reinterpret_cast<QRgb *>(diff->scanLine(y));
+        for (int x = 0; x < a.width(); ++x) {
+            const bool inkA = pa[x] < 128;
+            const bool inkG = pg[x] < 128;
+            if (inkA != inkG) {
+                ++differ;
+                pd[x] = inkA ? qRgb(255, 0, 0) : qRgb(0, 0, 255);   // extra / missing
+            } else {
+                pd[x] = inkA ? qRgb(160, 160, 160) : qRgb(255, 255, 255);
+            }
+        }
+    }
+    return double(differ) / (qint64(a.width()) * a.height());
+}
+
+QStringList PreviewBenchmark::regressions(const QJsonObject &baseline, const QList<BenchmarkResult> &results,
+                                          double maxRegression)
+{
+    QHash<QString, double> before;
+    for (const QJsonValue &v : baseline.value("benchmarks").toArray())
+        before.insert(v.toObject().value("name").toString(), v.toObject().value("value").toDouble());
+
+    QStringList list;
+    for (const BenchmarkResult &r : results) {
+        const double old = before.value(r.name, 0);
+        if (old <= 0)
+            continue;
+        const bool worse = r.higherIsBetter ? r.value < old * (1.0 - maxRegression)
+                                            : r.value > old * (1.0 + maxRegression);
+        if (worse)
+            list << QString("%1: %2 -> %3 %4").arg(r.name).arg(old).arg(r.value).arg(r.unit);
+    }
+    return list;
+}
+
+//
+// Helpers
+//
+bool PreviewBenchmark::waitForPaint(int timeoutMs)
+{
+    // Paint events are delivered synchronously, so the frame is on screen
+    // once processEvents() returns after one was seen.
+    const int before = paints;
+    QElapsedTimer timer;
+    timer.start();
+    while (paints == before && timer.elapsed() < timeoutMs)
+        QCoreApplication::processEvents();
+    return paints != before;
+}
+
+bool PreviewBenchmark::waitForPreview(LabelPreview *preview, int timeoutMs)
+{
+    // Backgrounds are decoded and font 0 registered on worker threads.
+    QElapsedTimer timer;
+    timer.start();
+    auto pending = [preview]() { return preview->isBackgroundPending() || preview->isFontPending(); };
+    while (pending() && timer.elapsed() < timeoutMs)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    return !pending();
+}
+
+void PreviewBenchmark::sendKey(QLineEdit *edit, int key, const QString &text, bool post)
+{
+    if (post) {
+        QCoreApplication::postEvent(edit, new QKeyEvent(QEvent::KeyPress, key, Qt::NoModifier, text));
+        QCoreApplication::postEvent(edit, new QKeyEvent(QEvent::KeyRelease, key, Qt::NoModifier, text));
+        return;
+    }
+    QKeyEvent press(QEvent::KeyPress, key, Qt::NoModifier, text);
+    QKeyEvent release(QEvent::KeyRelease, key, Qt::NoModifier, text);
+    QCoreApplication::sendEvent(edit, &press);
+    QCoreApplication::sendEvent(edit, &release);
+}
+
+QList<double> PreviewBenchmark::percentiles(QList<double> ms)
+{
+    // median, p95, max
+    if (ms.isEmpty())
+        return { 0, 0, 0 };
+    std::sort(ms.begin(), ms.end());
+    auto pct = [&](double p) { return ms.at(qMin<qsizetype>(ms.size() - 1, qsizetype(p * ms.size()))); };
+    return { pct(0.5), pct(0.95), ms.last() };
+}
@@ -0,0 +1,362 @@
+// src/PrintJournal.cpp
+#include "PrintJournal.hpp"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QDebug>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char FileMagic[8] = { 'O', 'S', 'J', 'O', 'U', 'R', 'N', '1' };
+constexpr qint64 HeaderSize = 16;
+constexpr quint32 RecordMagic = 0x4C52534Fu;   // "OSRL" little-endian
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+struct RecordHeader
+{
+    quint32 magic;
+    quint32 size;        // payload bytes, without padding
+    quint16 checksum;    // qChecksum() of the payload
+    quint16 type;
+};
+static_assert(sizeof(RecordHeader) == 12, "journal record header layout");
+
+// Records start on 4-byte boundaries.
+qint64 padded(qint64 size)
+{
+    return (size + 3) & ~qint64(3);
+}
+
+} // namespace
+
+//
+// JournalEntry
+//
+QString JournalEntry::summary() const
+{
+    if (!hasFields) {
+        const qsizetype labels = zpl.count("^XA");
+        return labels == 1 ? QString("1 label") : QString("%1 labels").arg(labels);
+    }
+
+    QStringList parts;
+    if (job.isKeyTag()) {
+        for (const QString &field : { job.customer, job.car, job.plate, job.repairOrder }) {
+            if (!field.trimmed().isEmpty())
+                parts << field.trimmed();
+        }
+        if (job.quantity > 1)
+            parts << QString("x%1").arg(job.quantity);
+    } else {
+        parts << job.mileage.trimmed();
+        if (!job.oilType.trimmed().isEmpty())
+            parts << job.oilType.trimmed();
+    }
+    return job.style + " " + parts.join(" ");
+}
+
+//
+// PrintJournal
+//
+PrintJournal::PrintJournal(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PrintJournal::~PrintJournal()
+{
+    if (map)
+        file.unmap(map);
+    delete lock;
+}
+
+QString PrintJournal::defaultPath()
+{
+    // Same organization/application pair as SettingsStore.
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + "/WFWestHS/OilStickerApp/print-journal.bin";
+}
+
+bool PrintJournal::open(const QString &path, QString *error)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    lock = new QLockFile(path + ".lock");
+    lock->setStaleLockTime(0);   // held for the life of the process
+    if (!lock->tryLock(0)) {
+        *error = QString("%1 is in use by another OilStickerApp process.").arg(path);
+        delete lock;
+        lock = nullptr;
+        return false;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        *error = QString("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    const bool created = file.size() == 0;
+    if (created && !file.resize(ChunkSize)) {
+        *error = QString("Cannot size %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    if (file.size() < HeaderSize) {
+        *error = QString("%1 is not a print journal.").arg(path);
+        return false;
+    }
+
+    mapSize = file.size();
+    map = file.map(0, mapSize);
+    if (!map) {
+        *error = QString("Cannot map %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    if (created) {
+        std::memcpy(map, FileMagic, sizeof FileMagic);
+    } else if (std::memcmp(map, FileMagic, sizeof FileMagic) != 0) {
+        *error = QString("%1 is not a print journal.").arg(path);
+        file.unmap(map);
+        map = nullptr;
+        return false;
+    }
+
+    scan();
+    return true;
+}
+
+void PrintJournal::scan()
+{
+    // A record that does not check out is skipped 4 bytes at a time until
+    // the next one that does, so one bad record never hides later ones.
+    qint64 offset = HeaderSize;
+    bool damaged = false;
+    end = HeaderSize;
+    while (offset + qint64(sizeof(RecordHeader)) <= mapSize) {
+        RecordHeader header;
+        std::memcpy(&header, map + offset, sizeof header);
+        const qint64 next = offset + qint64(sizeof header) + padded(header.size);
+        const char *data = reinterpret_cast<const char *>(map + offset + sizeof header);
+        if (header.magic != RecordMagic || next > mapSize
+            || qChecksum(QByteArrayView(data, header.size)) != header.checksum) {
+            damaged = damaged || header.magic != 0 || header.size != 0;
+            offset += 4;
+            continue;
+        }
+
+        const QByteArray payload = QByteArray::fromRawData(data, header.size);
+        QDataStream in(payload);
+        in.setVersion(StreamVersion);
+        quint64 id = 0;
+        in >> id;
+
+        if (header.type == JobRecord) {
+            jobOffsets.insert(id, offset);
+            nextId = qMax(nextId, id + 1);
+        } else if (header.type == ResultRecord) {
+            qint64 msecs = 0;
+            qint32 status = 0;
+            Result result;
+            in >> msecs >> status >> result.message;
+            result.time = QDateTime::fromMSecsSinceEpoch(msecs);
+            result.status = JournalEntry::Status(status);
+            results.insert(id, result);
+        }
+        offset = next;
+        end = next;
+    }
+
+    // Whatever follows the last good record is a torn write; clear it so
+    // new records are appended over zeros. A clean journal is left alone
+    // rather than dirtying every page of the map.
+    if (damaged) {
+        qWarning() << "Print journal" << file.fileName() << "has damaged records; skipped them";
+        std::memset(map + end, 0, size_t(mapSize - end));
+    }
+}
+
+bool PrintJournal::reserve(qint64 bytes)
+{
+    if (end + bytes <= mapSize)
+        return true;
+
+    const qint64 newSize = (end + bytes + ChunkSize - 1) / ChunkSize * ChunkSize;
+    file.unmap(map);
+    map = nullptr;
+    if (!file.resize(newSize) || !(map = file.map(0, newSize))) {
+        qWarning() << "Print journal disabled, cannot grow" << file.fileName() << file.errorString();
+        return false;
+    }
+    mapSize = newSize;
+    return true;
+}
+
+bool PrintJournal::writeRecord(RecordType type, const QByteArray &payload)
+{
+    if (!map || !reserve(qint64(sizeof(RecordHeader)) + padded(payload.size())))
+        return false;
+
+    uchar *at = map + end;
+    std::memcpy(at + sizeof(RecordHeader), payload.constData(), size_t(payload.size()));
+
+    RecordHeader header = { 0, quint32(payload.size()), qChecksum(payload), type };
+    std::memcpy(at, &header, sizeof header);
+
+    // The magic makes the record visible to scan(); store it last.
+    std::memcpy(at, &RecordMagic, sizeof RecordMagic);
+
+    const qint64 size = qint64(sizeof header) + padded(payload.size());
+    if (!flush(end, size))
+        qWarning() << "Print journal: cannot flush" << file.fileName();
+    end += size;
+    return true;
+}
+
+bool PrintJournal::flush(qint64 offset, qint64 size)
+{
+    // Until the pages reach the disk a crash can lose any of them, in any
+    // order; wait for this record so only a record still being written
+    // can be lost. One record is a page or two.
+#if defined(Q_OS_WIN)
+    return FlushViewOfFile(map + offset, SIZE_T(size)) && _commit(file.handle()) == 0;
+#else
+    const qint64 page = ::sysconf(_SC_PAGESIZE);
+    const qint64 start = offset / page * page;
+    return ::msync(map + start, size_t(offset + size - start), MS_SYNC) == 0;
+#endif
+}
+
+quint64 PrintJournal::append(const QString &printer, const QByteArray &zpl, const LabelJob *job,
+                             quint64 reprintOf)
+{
+    if (!map)
+        return 0;
+
+    const quint64 id = nextId;
+    const qint64 offset = end;
+
+    QByteArray payload;
+    payload.reserve(zpl.size() + 512);
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << id << QDateTime::currentMSecsSinceEpoch() << printer << reprintOf << bool(job);
+    if (job) {
+        out << job->style << job->templateName
+            << job->mileage << job->interval << job->oilType
+            << job->customer << job->car << job->plate << job->vin << job->color << job->repairOrder
+            << qint32(job->quantity);
+    }
+    out << zpl;
+
+    if (!writeRecord(JobRecord, payload))
+        return 0;
+
+    ++nextId;
+    jobOffsets.insert(id, offset);
+    return id;
+}
+
+void PrintJournal::setResult(quint64 id, bool ok, const QString &message)
+{
+    if (!map || !jobOffsets.contains(id))
+        return;
+
+    Result result;
+    result.status = ok ? JournalEntry::Printed : JournalEntry::Failed;
+    result.message = message;
+    result.time = QDateTime::currentDateTime();
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << id << result.time.toMSecsSinceEpoch() << qint32(result.status) << message;
+
+    if (writeRecord(ResultRecord, payload))
+        results.insert(id, result);
+}
+
+bool PrintJournal::readJob(qint64 offset, JournalEntry *entry, bool withZpl) const
+{
+    RecordHeader header;
+    std::memcpy(&header, map + offset, sizeof header);
+    const QByteArray payload = QByteArray::fromRawData(
+        reinterpret_cast<const char *>(map + offset + sizeof header), header.size);
+
+    QDataStream in(payload);
+    in.setVersion(StreamVersion);
+    qint64 msecs = 0;
+    in >> entry->id >> msecs >> entry->printer >> entry->reprintOf >> entry->hasFields;
+    entry->time = QDateTime::fromMSecsSinceEpoch(msecs);
+    if (entry->hasFields) {
+        LabelJob &job = entry->job;
+        qint32 quantity = 1;
+        in >> job.style >> job.templateName
+           >> job.mileage >> job.interval >> job.oilType
+           >> job.customer >> job.car >> job.plate >> job.vin >> job.color >> job.repairOrder
+           >> quantity;
+        job.quantity = quantity;
+    }
+    if (withZpl)
+        in >> entry->zpl;   // deep copy; the map may move on the next append
+
+    const auto result = results.constFind(entry->id);
+    if (result != results.constEnd()) {
+        entry->status = result->status;
+        entry->message = result->message;
+        entry->finished = result->time;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+QList<JournalEntry> PrintJournal::recent(int max) const
+{
+    QList<JournalEntry> entries;
+    if (!map)
+        return entries;
+
+    auto it = jobOffsets.constEnd();
+    while (it != jobOffsets.constBegin() && entries.size() < max) {
+        --it;
+        JournalEntry entry;
+        if (readJob(it.value(), &entry))
+            entries.append(entry);
+    }
+    return entries;
+}
+
+QList<JournalEntry> PrintJournal::history() const
+{
+    QList<JournalEntry> entries;
+    if (!map)
+        return entries;
+
+    entries.reserve(jobOffsets.size());
+    for (qint64 offset : jobOffsets) {
+        JournalEntry entry;
+        if (readJob(offset, &entry, false))
+            entries.append(entry);
+    }
+    return entries;
+}
+
+bool PrintJournal::entry(quint64 id, JournalEntry *out) const
+{
+    const auto it = jobOffsets.constFind(id);
+    if (!map || it == jobOffsets.constEnd())
+        return false;
+    return readJob(it.value(), out);
+}
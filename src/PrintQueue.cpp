@@ -0,0 +1,832 @@
+// src/PrintQueue.cpp
+#include "PrintQueue.hpp"
+#include "RawPrinterTransport.hpp"
+#include "CupsPrinterBackend.hpp"
+#include "IppClient.hpp"
+#include "TemplateSync.hpp"
+#include "PrintSpool.hpp"
+#include "SettingsStore.hpp"
+
+#include <QThread>
+#include <QProcess>
+#include <QTimer>
+#include <QStringList>
+#include <QDateTime>
+#include <QDebug>
+#include <utility>
+
+//
+// PrintWorker (print thread)
+//
+PrintWorker::PrintWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PrintWorker::~PrintWorker()
+{
+    delete cups;
+    delete spool;
+}
+
+void PrintWorker::enqueue(const PrintJob &job)
+{
+    PrintJob spooled = job;
+    QString error;
+    if (spool && !spool->append(&spooled, &error))
+        qWarning() << "PrintWorker: job" << job.id << "not spooled:" << error;
+
+    pending.enqueue(spooled);
+    if (!drainScheduled) {
+        drainScheduled = true;
+        QMetaObject::invokeMethod(this, &PrintWorker::drain, Qt::QueuedConnection);
+    }
+}
+
+void PrintWorker::enableSpool(const QString &printer)
+{
+    if (spooling)
+        return;
+    spooling = true;
+
+    // Without the file (locked by another process, disk trouble) jobs are
+    // still retried, they just do not survive a restart.
+    spool = new PrintSpool(printer);
+    QString error;
+    if (!spool->open(&error)) {
+        qWarning() << "PrintWorker: spool disabled for" << printer << error;
+        delete spool;
+        spool = nullptr;
+        return;
+    }
+
+    const QList<PrintJob> leftover = spool->pending();
+    if (leftover.isEmpty())
+        return;
+    backlog << leftover;
+    emit jobsRecovered(printer, leftover.size());
+    emit jobStateChanged(0, printer, 0, QString("%1 spooled from last session").arg(leftover.size()));
+    scheduleRetry(0);
+}
+
+void PrintWorker::syncTemplates(const QString &printer, PrintTransport transport, const QStringList &formats, int dpi)
+{
+    QStringList done;
+    QStringList failed;
+
+    if (transport == PrintTransport::Spooler) {
+        // -----------------------------
+        // CUPS queue: no read-back, go by the recorded hash
+        // -----------------------------
+        const QHash<QString, QByteArray> downloads = TemplateSync::pendingDownloads(printer, formats);
+        for (auto it = downloads.constBegin(); it != downloads.constEnd(); ++it) {
+            QString error;
+            bool ok;
+            if (CupsPrinterBackend::isAvailable()) {
+                if (!cups)
+                    cups = new CupsPrinterBackend();
+                int cupsJobId = 0;
+                ok = cups->print(printer, it.value(), QString("Format %1").arg(it.key()), &cupsJobId, &error);
+            } else {
+                PrintJob job;
+                job.printer = printer;
+                job.data = it.value();
+                ok = sendLpr(job, &error);
+            }
+
+            if (ok) {
+                TemplateSync::markDownloaded(printer, it.key());
+                done << QString("%1 sent").arg(it.key());
+            } else {
+                failed << QString("%1: %2").arg(it.key(), error);
+            }
+        }
+
+        QByteArray hash;
+        QString error;
+        const QByteArray logo = TemplateSync::pendingLogo(printer, dpi, &hash, &error);
+        if (!logo.isEmpty()) {
+            bool ok;
+            if (CupsPrinterBackend::isAvailable()) {
+                if (!cups)
+                    cups = new CupsPrinterBackend();
+                int cupsJobId = 0;
+                ok = cups->print(printer, logo, QString("Graphic %1").arg(TemplateSync::LogoName), &cupsJobId, &error);
+            } else {
+                PrintJob job;
+                job.printer = printer;
+                job.data = logo;
+                ok = sendLpr(job, &error);
+            }
+            if (ok)
+                TemplateSync::markLogoDownloaded(printer, hash);
+        }
+        if (!error.isEmpty())
+            failed << QString("%1: %2").arg(TemplateSync::LogoName, error);
+        else if (!logo.isEmpty())
+            done << QString("%1 sent").arg(TemplateSync::LogoName);
+    } else {
+        // -----------------------------
+        // Network printer: ask it (raw 9100 also for IPP printers)
+        // -----------------------------
+        if (!rawTransport)
+            rawTransport = new RawPrinterTransport(this);
+        QString host = printer;
+        if (transport == PrintTransport::Ipp)
+            host = printer.section(':', 0, 0);
+
+        TemplateSync sync(rawTransport);
+        for (const TemplateSync::Result &r : sync.syncNetworkPrinter(host, formats) + sync.syncNetworkLogo(host, dpi)) {
+            if (r.outcome == TemplateSync::Failed)
+                failed << QString("%1: %2").arg(r.format, r.message);
+            else if (r.outcome == TemplateSync::Downloaded)
+                done << QString("%1 %2").arg(r.format, r.message.toLower());
+        }
+    }
+
+    QString summary = failed.isEmpty()
+        ? (done.isEmpty() ? QString("formats up to date") : done.join(", "))
+        : failed.join("; ");
+    emit templatesSynced(printer, failed.isEmpty(), summary);
+}
+
+void PrintWorker::drain()
+{
+    drainScheduled = false;
+
+    while (!pending.isEmpty()) {
+        PrintJob job = pending.dequeue();
+
+        // Behind undelivered jobs: wait with them so the order holds.
+        if (!backlog.isEmpty()) {
+            backlog << job;
+            emit jobStateChanged(job.id, job.printer, 0,
+                                 QString("spooled (%1 waiting)").arg(backlog.size()));
+            continue;
+        }
+
+        if (holdIfFaulted(job))
+            continue;
+
+        if (job.transport != PrintTransport::Ipp) {
+            process(job);
+            continue;
+        }
+
+        // Pipeline back-to-back IPP jobs for the same printer.
+        QList<PrintJob> batch { job };
+        while (!pending.isEmpty() && batch.size() < MaxIppPipeline
+               && pending.head().transport == PrintTransport::Ipp
+               && pending.head().printer == job.printer) {
+            batch << pending.dequeue();
+        }
+        sendIpp(batch);
+    }
+}
+
+bool PrintWorker::holdIfFaulted(const PrintJob &job)
+{
+    // Keep jobs back while the printer reports paper out / paused / head
+    // open; they go out in order once a poll shows it ready again.
+    const PrinterStatus status = statuses.value(job.printer);
+    if (!held.contains(job.printer) && !status.isFaulted())
+        return false;
+
+    held[job.printer].enqueue(job);
+    emit jobStateChanged(job.id, job.printer, 0, QString("held (%1)").arg(status.summary()));
+    return true;
+}
+
+//
+// Printer status
+//
+void PrintWorker::monitor(const QHash<QString, PrintTransport> &printers)
+{
+    // Release jobs for printers no longer watched.
+    for (auto it = held.begin(); it != held.end();) {
+        if (printers.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        statuses.remove(it.key());
+        while (!it->isEmpty())
+            pending.prepend(it->takeLast());
+        it = held.erase(it);
+        if (!drainScheduled) {
+            drainScheduled = true;
+            QMetaObject::invokeMethod(this, &PrintWorker::drain, Qt::QueuedConnection);
+        }
+    }
+
+    monitored = printers;
+    if (!statusTimer) {
+        statusTimer = new QTimer(this);
+        statusTimer->setInterval(PrintQueue::StatusPollMs);
+        connect(statusTimer, &QTimer::timeout, this, &PrintWorker::pollStatus);
+    }
+    if (monitored.isEmpty())
+        statusTimer->stop();
+    else
+        statusTimer->start();
+    pollStatus();
+}
+
+void PrintWorker::pollStatus()
+{
+    bool released = false;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    for (auto it = monitored.constBegin(); it != monitored.constEnd(); ++it) {
+        const QString &printer = it.key();
+
+        // Without the CUPS API there is no queue state to read (lpr only
+        // submits); leave the status unknown rather than report a failure.
+        if (it.value() == PrintTransport::Spooler && !CupsPrinterBackend::isAvailable())
+            continue;
+
+        // An unreachable printer costs a connect timeout on this thread;
+        // retry it less often so labels for other printers are not delayed.
+        const PrinterStatus last = statuses.value(printer);
+        if (last.known && !last.reachable && last.updated.secsTo(now) < PrintQueue::UnreachableRetrySecs)
+            continue;
+
+        PrinterStatus status = queryStatus(printer, it.value());
+
+        if (status != statuses.value(printer))
+            emit printerStatusChanged(printer, status);
+        statuses.insert(printer, status);
+
+        // Back on the network: don't wait out the backoff.
+        if (status.reachable && !backlog.isEmpty())
+            scheduleRetry(0);
+
+        if (!status.isFaulted() && held.contains(printer)) {
+            QQueue<PrintJob> jobs = held.take(printer);
+            while (!jobs.isEmpty())
+                pending.prepend(jobs.takeLast());
+            released = true;
+        }
+    }
+
+    if (released && !drainScheduled) {
+        drainScheduled = true;
+        QMetaObject::invokeMethod(this, &PrintWorker::drain, Qt::QueuedConnection);
+    }
+}
+
+PrinterStatus PrintWorker::queryStatus(const QString &printer, PrintTransport transport)
+{
+    PrinterStatus status;
+    status.known = true;
+    status.updated = QDateTime::currentDateTime();
+
+    if (transport == PrintTransport::Spooler) {
+        if (!cups)
+            cups = new CupsPrinterBackend();
+        QString state = cups->printerState(printer, &status.spoolerReasons, &status.error);
+        status.reachable = !state.isEmpty();
+        status.paused = status.spoolerReasons.contains("paused");
+        status.spoolerReasons.removeAll("paused");
+        return status;
+    }
+
+    // Network printer: ~HS (and ~HQES for the detail) over the same
+    // connection the labels use; IPP printers answer on raw 9100.
+    if (!rawTransport)
+        rawTransport = new RawPrinterTransport(this);
+    const QString host = transport == PrintTransport::Ipp ? printer.section(':', 0, 0) : printer;
+
+    QByteArray reply;
+    if (!rawTransport->query(host, "~HS", "\x03", &reply, &status.error, 1500, 3)
+        || !PrinterStatus::parseHostStatus(reply, &status)) {
+        if (status.error.isEmpty())
+            status.error = "No ~HS reply";
+        return status;
+    }
+    status.reachable = true;
+    status.error.clear();
+
+    if (rawTransport->query(host, "~HQES", "\x03", &reply, nullptr, 1000))
+        PrinterStatus::parseExtendedStatus(reply, &status);
+    return status;
+}
+
+void PrintWorker::process(const PrintJob &job)
+{
+    QString error;
+    bool ok;
+    bool retryable = true;
+
+    if (job.transport == PrintTransport::Raw) {
+        if (!rawTransport)
+            rawTransport = new RawPrinterTransport(this);
+        qint64 written = 0;
+        ok = rawTransport->send(job.printer, job.data, &error, &written);
+        if (!ok && written > 0) {
+            // Part of the label is in the printer; sending it again could
+            // print it twice.
+            error = QString("%1 (partly sent, not resent)").arg(error);
+            retryable = false;
+        }
+    } else if (CupsPrinterBackend::isAvailable()) {
+        // jobFinished is emitted by sendCups (it knows the CUPS job id)
+        sendCups(job);
+        return;
+    } else {
+        ok = sendLpr(job, &error, &retryable);
+    }
+
+    if (ok)
+        succeed(job, QString("Label sent to printer: %1").arg(job.printer));
+    else
+        fail(job, error, retryable);
+}
+
+void PrintWorker::succeed(const PrintJob &job, const QString &message)
+{
+    if (spool && job.spoolSeq)
+        spool->markDone({ job.spoolSeq });
+    emit jobFinished(job.id, job.printer, true, message);
+}
+
+void PrintWorker::fail(const PrintJob &job, const QString &error, bool retryable)
+{
+    // Only jobs that never reached the printer are worth another try.
+    if (!spooling || !retryable) {
+        if (spool && job.spoolSeq)
+            spool->markDone({ job.spoolSeq });
+        emit jobFinished(job.id, job.printer, false, error);
+        return;
+    }
+
+    // Keep it (it is already on disk) and try again later; anything queued
+    // after it waits in the backlog too.
+    backlog << job;
+    emit jobStateChanged(job.id, job.printer, 0, QString("spooled, printer offline (%1)").arg(error));
+    scheduleRetry();
+}
+
+//
+// Offline spool
+//
+void PrintWorker::scheduleRetry(int delayMs)
+{
+    if (!retryTimer) {
+        retryTimer = new QTimer(this);
+        retryTimer->setSingleShot(true);
+        connect(retryTimer, &QTimer::timeout, this, &PrintWorker::retrySpooled);
+    }
+
+    if (delayMs >= 0) {
+        retryTimer->start(delayMs);
+        return;
+    }
+    if (retryTimer->isActive())
+        return;
+    retryDelayMs = retryDelayMs > 0 ? qMin(retryDelayMs * 2, RetryMaxMs) : RetryMinMs;
+    retryTimer->start(retryDelayMs);
+}
+
+void PrintWorker::retrySpooled()
+{
+    if (backlog.isEmpty())
+        return;
+
+    const QString printer = backlog.first().printer;
+    QString error;
+    const QList<PrintJob> sent = sendBacklog(&error);
+
+    if (!sent.isEmpty()) {
+        QList<quint64> seqs;
+        for (const PrintJob &job : sent) {
+            if (job.spoolSeq)
+                seqs << job.spoolSeq;
+        }
+        if (spool)
+            spool->markDone(seqs);
+
+        const QString message = sent.size() == 1
+            ? QString("Spooled label sent to printer: %1").arg(printer)
+            : QString("Spooled labels sent to printer: %1 (%2 together)").arg(printer).arg(sent.size());
+        for (const PrintJob &job : sent)
+            emit jobFinished(job.id, job.printer, true, message);
+        retryDelayMs = 0;
+    }
+
+    if (backlog.isEmpty()) {
+        retryDelayMs = 0;
+        return;
+    }
+    scheduleRetry();
+    emit jobStateChanged(backlog.first().id, printer, 0,
+                         QString("%1 spooled, retry in %2 s (%3)")
+                             .arg(backlog.size()).arg(retryDelayMs / 1000).arg(error));
+}
+
+QList<PrintJob> PrintWorker::sendBacklog(QString *error)
+{
+    // Sends what it can from the backlog and returns the jobs delivered.
+    // Jobs the printer refused or may have printed in part are failed; the
+    // ones that never got there stay in the backlog, in order.
+    //
+    // Each job keeps the transport it was queued with (a Network Protocol
+    // change does not rewrite the spool), so the backlog goes out in runs
+    // of one transport. A printer since recorded as a CUPS queue gets its
+    // jobs through the spooler whatever they were queued with.
+    QList<PrintJob> jobs = std::exchange(backlog, {});
+    for (PrintJob &job : jobs) {
+        if (job.transport != PrintTransport::Spooler
+            && SettingsStore::instance().printerKind(job.printer) == "queue") {
+            job.transport = PrintTransport::Spooler;
+        }
+    }
+
+    QList<PrintJob> sent;
+    for (int from = 0; from < jobs.size();) {
+        int to = from + 1;
+        while (to < jobs.size() && jobs[to].transport == jobs[from].transport)
+            ++to;
+        sent << sendRun(jobs.mid(from, to - from), error);
+
+        // Something in this run has to wait: so does everything after it.
+        if (!backlog.isEmpty()) {
+            backlog << jobs.mid(to);
+            break;
+        }
+        from = to;
+    }
+    return sent;
+}
+
+QList<PrintJob> PrintWorker::sendRun(const QList<PrintJob> &jobs, QString *error)
+{
+    const QString printer = jobs.first().printer;
+    const PrintTransport transport = jobs.first().transport;
+    QList<PrintJob> sent;
+
+    if (transport == PrintTransport::Raw) {
+        // One stream: ZPL formats simply follow each other. Only the jobs
+        // not yet started when the connection failed are tried again.
+        QByteArray stream;
+        for (const PrintJob &job : jobs)
+            stream += job.data;
+
+        if (!rawTransport)
+            rawTransport = new RawPrinterTransport(this);
+        qint64 written = 0;
+        rawTransport->send(printer, stream, error, &written);
+
+        qint64 offset = 0;
+        for (const PrintJob &job : jobs) {
+            if (offset + job.data.size() <= written)
+                sent << job;
+            else if (offset < written)
+                fail(job, QString("%1 (partly sent, not resent)").arg(*error), false);
+            else
+                backlog << job;
+            offset += job.data.size();
+        }
+        return sent;
+    }
+
+    // IPP and the spooler: one job at a time, up to the first that has to
+    // be tried again. (A pipelined IPP batch could print jobs queued after
+    // one that failed, out of order.)
+    for (int i = 0; i < jobs.size(); ++i) {
+        const PrintJob &job = jobs[i];
+        QString jobError;
+        bool retryable = true;
+        bool ok;
+        if (transport == PrintTransport::Ipp) {
+            if (!ipp)
+                ipp = new IppClient(this);
+            const QList<IppClient::Response> responses =
+                ipp->printJobs(printer, { job.data }, "Oil Sticker (spooled)");
+            const IppClient::Response r = responses.value(0);
+            ok = r.ok;
+            jobError = responses.isEmpty() ? QString("No IPP response") : r.error;
+            retryable = responses.isEmpty() || r.isRetryable();
+        } else if (CupsPrinterBackend::isAvailable()) {
+            if (!cups)
+                cups = new CupsPrinterBackend();
+            int cupsJobId = 0;
+            ok = cups->print(printer, job.data, "Oil Sticker (spooled)", &cupsJobId, &jobError, &retryable);
+        } else {
+            ok = sendLpr(job, &jobError, &retryable);
+        }
+
+        if (ok) {
+            sent << job;
+        } else if (!retryable) {
+            fail(job, jobError, false);
+        } else {
+            *error = jobError;
+            backlog = jobs.mid(i);
+            break;
+        }
+    }
+    return sent;
+}
+
+void PrintWorker::sendCups(const PrintJob &job)
+{
+    // -----------------------------
+    // libcups path (macOS, Linux)
+    // -----------------------------
+    if (!cups)
+        cups = new CupsPrinterBackend();
+
+    QString error;
+    int cupsJobId = 0;
+    bool retryable = true;
+    if (!cups->print(job.printer, job.data, QString("Oil Sticker %1").arg(job.id), &cupsJobId, &error, &retryable)) {
+        fail(job, error, retryable);
+        return;
+    }
+
+    succeed(job, QString("Label sent to printer: %1 (CUPS job %2)").arg(job.printer).arg(cupsJobId));
+    pollCupsJob(job.id, job.printer, cupsJobId, 0);
+}
+
+void PrintWorker::sendIpp(const QList<PrintJob> &batch)
+{
+    // -----------------------------
+    // IPP path (network printers, :631/ipp/print)
+    // -----------------------------
+    if (!ipp)
+        ipp = new IppClient(this);
+
+    const QString printer = batch.first().printer;
+
+    QList<QByteArray> documents;
+    for (const PrintJob &job : batch)
+        documents << job.data;
+
+    const QList<IppClient::Response> responses = ipp->printJobs(printer, documents, "Oil Sticker");
+
+    for (int i = 0; i < batch.size(); ++i) {
+        const PrintJob &job = batch[i];
+        const IppClient::Response &r = responses[i];
+        if (!r.ok) {
+            fail(job, r.error, r.isRetryable());
+            continue;
+        }
+
+        int ippJobId = r.intValue("job-id");
+        succeed(job, QString("Label sent to printer: %1 (IPP job %2)").arg(printer).arg(ippJobId));
+
+        bool finished = false;
+        QString state = IppClient::jobStateName(r.intValue("job-state"), &finished);
+        emit jobStateChanged(job.id, printer, ippJobId, state);
+        if (!finished && ippJobId > 0) {
+            QTimer::singleShot(500, this, [this, id = job.id, printer, ippJobId]() {
+                pollIppJob(id, printer, ippJobId, 1);
+            });
+        }
+    }
+}
+
+void PrintWorker::pollCupsJob(quint64 id, const QString &printer, int cupsJobId, int attempt)
+{
+    // Follow the job until CUPS reports a final state. Polls are queued on
+    // this thread's event loop, so they interleave with new jobs instead of
+    // holding them up.
+    const int maxAttempts = 20;
+
+    bool finished = false;
+    QString error;
+    QString state = cups->jobState(cupsJobId, &finished, &error);
+    if (state.isEmpty()) {
+        qWarning() << "PrintWorker: CUPS job" << cupsJobId << "state unavailable:" << error;
+        return;
+    }
+
+    emit jobStateChanged(id, printer, cupsJobId, state);
+
+    if (!finished && attempt + 1 < maxAttempts) {
+        QTimer::singleShot(500, this, [this, id, printer, cupsJobId, attempt]() {
+            pollCupsJob(id, printer, cupsJobId, attempt + 1);
+        });
+    }
+}
+
+void PrintWorker::pollIppJob(quint64 id, const QString &printer, int ippJobId, int attempt)
+{
+    const int maxAttempts = 20;
+
+    IppClient::Response r = ipp->jobAttributes(printer, ippJobId);
+    if (!r.ok) {
+        qWarning() << "PrintWorker: IPP job" << ippJobId << "state unavailable:" << r.error;
+        return;
+    }
+
+    bool finished = false;
+    emit jobStateChanged(id, printer, ippJobId, IppClient::jobStateName(r.intValue("job-state"), &finished));
+
+    if (!finished && attempt + 1 < maxAttempts) {
+        QTimer::singleShot(500, this, [this, id, printer, ippJobId, attempt]() {
+            pollIppJob(id, printer, ippJobId, attempt + 1);
+        });
+    }
+}
+
+bool PrintWorker::sendLpr(const PrintJob &job, QString *error, bool *retryable)
+{
+    // -----------------------------
+    // CUPS / lpr path (macOS, Linux)
+    // -----------------------------
+    QProcess lp;
+    QStringList args;
+    args << "-P" << job.printer << "-o" << "raw";
+
+    if (retryable)
+        *retryable = true;
+
+    lp.start("lpr", args);
+    if (!lp.waitForStarted(3000)) {
+        *error = QString("lpr could not be started: %1").arg(lp.errorString());
+        if (retryable)
+            *retryable = false;
+        return false;
+    }
+    lp.write(job.data);
+    lp.closeWriteChannel();
+
+    // Treated like a dropped connection: the scheduler did not take it.
+    if (!lp.waitForFinished(3000)) {
+        *error = "lpr did not finish sending the job.";
+        lp.kill();
+        return false;
+    }
+    if (lp.exitStatus() != QProcess::NormalExit || lp.exitCode() != 0) {
+        const QString message = QString::fromLocal8Bit(lp.readAllStandardError()).trimmed();
+        *error = QString("lpr failed: %1").arg(message);
+        // A queue that does not exist will not appear by retrying; the
+        // scheduler being down ("unable to connect") is worth another try.
+        if (retryable && (message.contains("does not exist", Qt::CaseInsensitive)
+                          || message.contains("unknown", Qt::CaseInsensitive))) {
+            *retryable = false;
+        }
+        return false;
+    }
+    return true;
+}
+
+//
+// PrintQueue (GUI thread)
+//
+PrintQueue::PrintQueue(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PrintQueue::~PrintQueue()
+{
+    // quit() would drop jobs still posted to a worker, before they reach
+    // its spool file. Queue the quit behind them instead: each worker
+    // takes (and spools) everything enqueued so far and finishes the send
+    // in progress; jobs not sent by then go out from the spool next start.
+    for (const Lane &lane : std::as_const(lanes)) {
+        QThread *thread = lane.thread;
+        QMetaObject::invokeMethod(lane.worker, [thread]() { thread->quit(); }, Qt::QueuedConnection);
+    }
+    for (const Lane &lane : std::as_const(lanes))
+        lane.thread->wait();
+}
+
+PrintWorker *PrintQueue::workerFor(const QString &printer)
+{
+    auto it = lanes.constFind(printer);
+    if (it != lanes.constEnd())
+        return it->worker;
+
+    Lane lane;
+    lane.thread = new QThread(this);
+    lane.worker = new PrintWorker();
+    lane.thread->setObjectName(QString("Print %1").arg(printer));
+    lane.worker->moveToThread(lane.thread);
+    connect(lane.thread, &QThread::finished, lane.worker, &QObject::deleteLater);
+    connect(lane.worker, &PrintWorker::jobFinished, this, &PrintQueue::onWorkerFinished);
+    connect(lane.worker, &PrintWorker::jobStateChanged, this, &PrintQueue::jobStateChanged);
+    connect(lane.worker, &PrintWorker::templatesSynced, this, &PrintQueue::templatesSynced);
+    connect(lane.worker, &PrintWorker::printerStatusChanged, this, &PrintQueue::onWorkerStatusChanged);
+    connect(lane.worker, &PrintWorker::jobsRecovered, this, &PrintQueue::onWorkerRecovered);
+    lane.thread->start();
+    lanes.insert(printer, lane);
+
+    // Queued ahead of the lane's first job.
+    if (spooling) {
+        PrintWorker *w = lane.worker;
+        QMetaObject::invokeMethod(w, [w, printer]() { w->enableSpool(printer); }, Qt::QueuedConnection);
+    }
+    return lane.worker;
+}
+
+quint64 PrintQueue::enqueue(const QString &printer, const QByteArray &data, PrintTransport transport)
+{
+    PrintJob job;
+    job.id = nextId++;
+    job.printer = printer;
+    job.data = data;
+    job.transport = transport;
+
+    int d = ++depths[printer];
+    emit depthChanged(printer, d);
+
+    PrintWorker *w = workerFor(printer);
+    QMetaObject::invokeMethod(w, [w, job]() { w->enqueue(job); }, Qt::QueuedConnection);
+    return job.id;
+}
+
+int PrintQueue::depth(const QString &printer) const
+{
+    return depths.value(printer, 0);
+}
+
+void PrintQueue::enableSpool()
+{
+    if (spooling)
+        return;
+    spooling = true;
+
+    for (auto it = lanes.constBegin(); it != lanes.constEnd(); ++it) {
+        PrintWorker *w = it->worker;
+        const QString printer = it.key();
+        QMetaObject::invokeMethod(w, [w, printer]() { w->enableSpool(printer); }, Qt::QueuedConnection);
+    }
+
+    // Printers with jobs left from an earlier session get their lane now,
+    // so the backlog drains without waiting for a new label.
+    for (const QString &printer : PrintSpool::spooledPrinters())
+        workerFor(printer);
+}
+
+PrintTransport PrintQueue::transportFor(const QString &printer, bool noSpooler,
+                                        const QString &networkProtocol)
+{
+    if (!noSpooler && !isNetworkPrinter(printer))
+        return PrintTransport::Spooler;
+    return networkProtocol.compare("IPP", Qt::CaseInsensitive) == 0
+        ? PrintTransport::Ipp : PrintTransport::Raw;
+}
+
+bool PrintQueue::isNetworkPrinter(const QString &printer)
+{
+    if (RawPrinterTransport::isNetworkAddress(printer))
+        return true;
+    const QString kind = SettingsStore::instance().printerKind(printer);
+    if (!kind.isEmpty())
+        return kind == "network";
+    return printer.contains('.');
+}
+
+void PrintQueue::syncTemplates(const QString &printer, PrintTransport transport, const QStringList &formats, int dpi)
+{
+    PrintWorker *w = workerFor(printer);
+    QMetaObject::invokeMethod(w, [w, printer, transport, formats, dpi]() {
+        w->syncTemplates(printer, transport, formats, dpi);
+    }, Qt::QueuedConnection);
+}
+
+void PrintQueue::monitorPrinters(const QHash<QString, PrintTransport> &printers)
+{
+    // Each printer is polled from its own thread; printers dropped from the
+    // set are told to stop (which also releases any jobs they held).
+    for (auto it = monitored.constBegin(); it != monitored.constEnd(); ++it) {
+        if (printers.contains(it.key()))
+            continue;
+        PrintWorker *w = workerFor(it.key());
+        QMetaObject::invokeMethod(w, [w]() { w->monitor({}); }, Qt::QueuedConnection);
+    }
+    for (auto it = printers.constBegin(); it != printers.constEnd(); ++it) {
+        PrintWorker *w = workerFor(it.key());
+        const QHash<QString, PrintTransport> one { { it.key(), it.value() } };
+        QMetaObject::invokeMethod(w, [w, one]() { w->monitor(one); }, Qt::QueuedConnection);
+    }
+    monitored = printers;
+}
+
+PrinterStatus PrintQueue::status(const QString &printer) const
+{
+    return statuses.value(printer);
+}
+
+void PrintQueue::onWorkerStatusChanged(const QString &printer, const PrinterStatus &status)
+{
+    statuses.insert(printer, status);
+    emit printerStatusChanged(printer, status);
+}
+
+void PrintQueue::onWorkerRecovered(const QString &printer, int count)
+{
+    int d = depths[printer] += count;
+    emit depthChanged(printer, d);
+}
+
+void PrintQueue::onWorkerFinished(quint64 id, const QString &printer, bool ok, const QString &message)
+{
+    int d = qMax(0, depths.value(printer, 0) - 1);
+    depths.insert(printer, d);
+    emit depthChanged(printer, d);
+    emit jobFinished(id, printer, ok, message);
+}
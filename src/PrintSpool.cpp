@@ -0,0 +1,248 @@
+// src/PrintSpool.cpp
+#include "PrintSpool.hpp"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QDebug>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char FileMagic[8] = { 'O', 'S', 'S', 'P', 'O', 'O', 'L', '1' };
+constexpr qint64 HeaderSize = 8;
+constexpr quint32 RecordMagic = 0x4C52534Fu;   // "OSRL", as in the journal
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+struct RecordHeader
+{
+    quint32 magic;
+    quint32 size;        // payload bytes
+    quint16 checksum;    // qChecksum() of the payload
+    quint16 type;
+};
+static_assert(sizeof(RecordHeader) == 12, "spool record header layout");
+
+// QFile::flush() only empties Qt's buffer; this waits for the disk.
+bool syncToDisk(QFile &file)
+{
+    if (!file.flush())
+        return false;
+#if defined(Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+QString spoolPath(const QString &printer)
+{
+    // Queue names and "host:port" both become safe file names.
+    return PrintSpool::directory() + "/"
+           + QString::fromLatin1(QUrl::toPercentEncoding(printer)) + ".spool";
+}
+
+} // namespace
+
+QString PrintSpool::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + "/WFWestHS/OilStickerApp/spool";
+}
+
+QStringList PrintSpool::spooledPrinters()
+{
+    QStringList printers;
+    const QDir dir(directory());
+    const QFileInfoList files = dir.entryInfoList({ "*.spool" }, QDir::Files);
+    for (const QFileInfo &info : files) {
+        QFile f(info.filePath());
+        if (!f.open(QIODevice::ReadOnly))
+            continue;
+        QString printer;
+        QMap<quint64, PrintJob> jobs;
+        quint64 lastSeq = 0;
+        if (scan(f.readAll(), &printer, &jobs, &lastSeq) && !jobs.isEmpty())
+            printers << printer;
+    }
+    return printers;
+}
+
+PrintSpool::PrintSpool(const QString &printerName)
+    : printer(printerName),
+      file(spoolPath(printerName)),
+      lock(spoolPath(printerName) + ".lock")
+{
+    lock.setStaleLockTime(0);   // held for the life of the process
+}
+
+bool PrintSpool::open(QString *error)
+{
+    QDir().mkpath(directory());
+
+    if (!lock.tryLock(0)) {
+        *error = QString("%1 is in use by another OilStickerApp process.").arg(file.fileName());
+        return false;
+    }
+    if (!file.open(QIODevice::ReadWrite)) {
+        *error = QString("Cannot open %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+
+    QString stored;
+    quint64 lastSeq = 0;
+    const QByteArray bytes = file.readAll();
+    const qint64 end = scan(bytes, &stored, &unsent, &lastSeq);
+    nextSeq = lastSeq + 1;
+
+    if (end == 0 || unsent.isEmpty()) {
+        unsent.clear();
+        if (!reset()) {
+            *error = QString("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+            file.close();
+            return false;
+        }
+        return true;
+    }
+
+    // Drop a torn tail so new records follow the last good one.
+    if (end < bytes.size() && (!file.resize(end) || !syncToDisk(file)))
+        qWarning() << "PrintSpool: cannot trim" << file.fileName() << file.errorString();
+    file.seek(end);
+    return true;
+}
+
+qint64 PrintSpool::scan(const QByteArray &bytes, QString *printer, QMap<quint64, PrintJob> *jobs,
+                        quint64 *lastSeq)
+{
+    if (bytes.size() < HeaderSize || std::memcmp(bytes.constData(), FileMagic, sizeof FileMagic) != 0)
+        return 0;
+
+    qint64 offset = HeaderSize;
+    bool named = false;
+    while (offset + qint64(sizeof(RecordHeader)) <= bytes.size()) {
+        RecordHeader header;
+        std::memcpy(&header, bytes.constData() + offset, sizeof header);
+        if (header.magic != RecordMagic)
+            break;
+
+        const qint64 next = offset + qint64(sizeof header) + header.size;
+        if (next > bytes.size())
+            break;
+
+        const QByteArray payload = QByteArray::fromRawData(bytes.constData() + offset + sizeof header,
+                                                           header.size);
+        if (qChecksum(payload) != header.checksum)
+            break;
+
+        QDataStream in(payload);
+        in.setVersion(StreamVersion);
+        if (header.type == PrinterRecord) {
+            in >> *printer;
+            named = true;
+        } else if (header.type == JobRecord) {
+            PrintJob job;
+            qint32 transport = 0;
+            in >> job.spoolSeq >> transport >> job.data;
+            job.printer = *printer;
+            job.transport = PrintTransport(transport);
+            jobs->insert(job.spoolSeq, job);
+            *lastSeq = qMax(*lastSeq, job.spoolSeq);
+        } else if (header.type == DoneRecord) {
+            QList<quint64> seqs;
+            in >> seqs;
+            for (quint64 seq : std::as_const(seqs))
+                jobs->remove(seq);
+        }
+        offset = next;
+    }
+    return named ? offset : 0;
+}
+
+bool PrintSpool::reset()
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << printer;
+
+    if (!file.resize(0) || !file.seek(0) || file.write(FileMagic, sizeof FileMagic) != HeaderSize)
+        return false;
+    return writeRecord(PrinterRecord, payload);
+}
+
+bool PrintSpool::writeRecord(RecordType type, const QByteArray &payload)
+{
+    const RecordHeader header = { RecordMagic, quint32(payload.size()), qChecksum(payload), type };
+
+    QByteArray record;
+    record.reserve(qsizetype(sizeof header) + payload.size());
+    record.append(reinterpret_cast<const char *>(&header), sizeof header);
+    record.append(payload);
+
+    return file.write(record) == record.size() && syncToDisk(file);
+}
+
+QList<PrintJob> PrintSpool::pending() const
+{
+    return unsent.values();
+}
+
+bool PrintSpool::append(PrintJob *job, QString *error)
+{
+    if (!isOpen()) {
+        *error = "Print spool is not open.";
+        return false;
+    }
+
+    const quint64 seq = nextSeq;
+
+    QByteArray payload;
+    payload.reserve(job->data.size() + 32);
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << seq << qint32(job->transport) << job->data;
+
+    if (!writeRecord(JobRecord, payload)) {
+        *error = QString("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+
+    ++nextSeq;
+    job->spoolSeq = seq;
+    PrintJob stored = *job;
+    stored.id = 0;
+    unsent.insert(seq, stored);
+    return true;
+}
+
+void PrintSpool::markDone(const QList<quint64> &seqs)
+{
+    if (!isOpen())
+        return;
+
+    for (quint64 seq : seqs)
+        unsent.remove(seq);
+
+    // Nothing left to send: start over instead of growing the file.
+    if (unsent.isEmpty()) {
+        if (!reset())
+            qWarning() << "PrintSpool: cannot reset" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(StreamVersion);
+    out << seqs;
+    if (!writeRecord(DoneRecord, payload))
+        qWarning() << "PrintSpool: cannot write" << file.fileName() << file.errorString();
+}
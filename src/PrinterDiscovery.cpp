@@ -0,0 +1,480 @@
+// src/PrinterDiscovery.cpp
+#include "PrinterDiscovery.hpp"
+#include "CupsPrinterBackend.hpp"
+#include "SettingsStore.hpp"
+
+#include <QThread>
+#include <QTimer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QNetworkDatagram>
+#include <QNetworkInterface>
+#include <QRegularExpression>
+#include <QSet>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+namespace {
+
+int dpiFromModel(const QString &model)
+{
+    static const QRegularExpression re(R"((\d{3})\s*dpi)", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch m = re.match(model);
+    return m.hasMatch() ? m.captured(1).toInt() : 0;
+}
+
+} // namespace
+
+QString DiscoveredPrinter::displayText() const
+{
+    QString text = name;
+    if (!model.isEmpty())
+        text += QString(" - %1").arg(model);
+    if (dpi > 0 && !model.contains(QString::number(dpi)))
+        text += QString(", %1 dpi").arg(dpi);
+    return text;
+}
+
+//
+// DiscoveryWorker (discovery thread)
+//
+DiscoveryWorker::DiscoveryWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DiscoveryWorker::scan(const QStringList &hosts)
+{
+    if (scanning)
+        return;
+    scanning = true;
+
+    results.clear();
+    indexByName.clear();
+    srvTarget.clear();
+    srvPort.clear();
+    txtModel.clear();
+    addresses.clear();
+    extraHosts = hosts;
+
+    listCupsQueues();
+    startBrowse();
+}
+
+void DiscoveryWorker::addResult(const DiscoveredPrinter &printer)
+{
+    auto it = indexByName.constFind(printer.name);
+    if (it == indexByName.constEnd()) {
+        indexByName.insert(printer.name, results.size());
+        results << printer;
+        return;
+    }
+
+    // Same printer seen by DNS-SD and the sweep: keep whatever is known.
+    DiscoveredPrinter &existing = results[*it];
+    if (existing.model.isEmpty())
+        existing.model = printer.model;
+    if (existing.dpi == 0)
+        existing.dpi = printer.dpi;
+}
+
+//
+// CUPS
+//
+void DiscoveryWorker::listCupsQueues()
+{
+    QHash<QString, QString> models;
+    const QStringList queues = CupsPrinterBackend::queues(&models);
+
+    for (const QString &queue : std::as_const(queues)) {
+        DiscoveredPrinter p;
+        p.name = queue;
+        p.source = "cups";
+        p.model = models.value(queue);
+        p.dpi = dpiFromModel(p.model);
+        addResult(p);
+    }
+}
+
+//
+// DNS-SD
+//
+void DiscoveryWorker::startBrowse()
+{
+    mdns = new QUdpSocket(this);
+    if (!mdns->bind(QHostAddress::AnyIPv4, 0)) {
+        qWarning() << "PrinterDiscovery: DNS-SD socket:" << mdns->errorString();
+        finishBrowse();
+        return;
+    }
+
+    // A one-shot query from an ephemeral port; responders answer by
+    // unicast to that port (RFC 6762 section 5.1).
+    connect(mdns, &QUdpSocket::readyRead, this, &DiscoveryWorker::readBrowseReplies);
+    mdns->writeDatagram(browseQuery("_pdl-datastream._tcp.local"), QHostAddress("224.0.0.251"), 5353);
+    QTimer::singleShot(BrowseMs, this, &DiscoveryWorker::finishBrowse);
+}
+
+void DiscoveryWorker::readBrowseReplies()
+{
+    while (mdns && mdns->hasPendingDatagrams())
+        parseBrowseReply(mdns->receiveDatagram().data());
+}
+
+void DiscoveryWorker::finishBrowse()
+{
+    if (mdns) {
+        mdns->close();
+        mdns->deleteLater();
+        mdns = nullptr;
+    }
+
+    QStringList dnssdHosts;
+    for (auto it = srvTarget.constBegin(); it != srvTarget.constEnd(); ++it) {
+        QString host = addresses.contains(it.value())
+            ? addresses.value(it.value()).toString()
+            : QString::fromUtf8(it.value());
+        quint16 port = srvPort.value(it.key(), 9100);
+
+        DiscoveredPrinter p;
+        p.name = port == 9100 ? host : QString("%1:%2").arg(host).arg(port);
+        p.source = "dns-sd";
+        p.model = txtModel.value(it.key());
+        p.dpi = dpiFromModel(p.model);
+        addResult(p);
+        dnssdHosts << p.name;
+    }
+
+    // -----------------------------
+    // TCP 9100 sweep of the local /24s
+    // -----------------------------
+    QStringList hosts;
+    QSet<quint32> subnets;
+    for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+        const auto flags = iface.flags();
+        if (!(flags & QNetworkInterface::IsUp) || !(flags & QNetworkInterface::IsRunning)
+            || (flags & QNetworkInterface::IsLoopBack) || (flags & QNetworkInterface::IsPointToPoint))
+            continue;
+        if (iface.type() != QNetworkInterface::Ethernet && iface.type() != QNetworkInterface::Wifi)
+            continue;
+
+        for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+            const QHostAddress ip = entry.ip();
+            if (ip.protocol() != QAbstractSocket::IPv4Protocol)
+                continue;
+            const quint32 own = ip.toIPv4Address();
+            const quint32 base = own & 0xFFFFFF00u;
+            if (subnets.contains(base))
+                continue;
+            subnets.insert(base);
+            for (quint32 h = 1; h < 255; ++h) {
+                if ((base | h) != own)
+                    hosts << QHostAddress(base | h).toString();
+            }
+        }
+    }
+
+    // DNS-SD results and saved printers get a ~HI too (model, resolution).
+    for (const QString &host : dnssdHosts + extraHosts) {
+        if (!hosts.contains(host))
+            hosts << host;
+    }
+
+    probeQueue = hosts;
+    probeNext();
+}
+
+QByteArray DiscoveryWorker::browseQuery(const QByteArray &service)
+{
+    QByteArray q;
+    // Header: id 0, flags 0, one question.
+    q.append("\0\0\0\0\0\1\0\0\0\0\0\0", 12);
+    for (const QByteArray &label : service.split('.')) {
+        q.append(char(label.size()));
+        q.append(label);
+    }
+    q.append('\0');
+    q.append("\0\x0C", 2);   // PTR
+    q.append("\x80\x01", 2); // IN, unicast response requested
+    return q;
+}
+
+bool DiscoveryWorker::readName(const QByteArray &msg, int *pos, QByteArray *name)
+{
+    name->clear();
+    int p = *pos;
+    bool jumped = false;
+
+    for (int hops = 0; hops < 64; ++hops) {
+        if (p >= msg.size())
+            return false;
+        const uchar len = uchar(msg.at(p));
+
+        if ((len & 0xC0) == 0xC0) { // compression pointer
+            if (p + 1 >= msg.size())
+                return false;
+            if (!jumped)
+                *pos = p + 2;
+            p = ((len & 0x3F) << 8) | uchar(msg.at(p + 1));
+            jumped = true;
+            continue;
+        }
+        if (len == 0) {
+            if (!jumped)
+                *pos = p + 1;
+            *name = name->toLower();
+            return true;
+        }
+        if (p + 1 + len > msg.size())
+            return false;
+        if (!name->isEmpty())
+            name->append('.');
+        name->append(msg.mid(p + 1, len));
+        p += 1 + len;
+    }
+    return false;
+}
+
+void DiscoveryWorker::parseBrowseReply(const QByteArray &msg)
+{
+    if (msg.size() < 12)
+        return;
+
+    auto u16 = [&](int p) { return int((uchar(msg.at(p)) << 8) | uchar(msg.at(p + 1))); };
+    const int questions = u16(4);
+    const int records = u16(6) + u16(8) + u16(10);
+
+    int pos = 12;
+    QByteArray name;
+    for (int i = 0; i < questions; ++i) {
+        if (!readName(msg, &pos, &name))
+            return;
+        pos += 4;
+    }
+
+    for (int i = 0; i < records; ++i) {
+        QByteArray owner;
+        if (!readName(msg, &pos, &owner) || pos + 10 > msg.size())
+            return;
+        const int type = u16(pos);
+        const int length = u16(pos + 8);
+        const int rdata = pos + 10;
+        if (rdata + length > msg.size())
+            return;
+
+        switch (type) {
+        case 33: // SRV: priority, weight, port, target
+            if (length >= 7) {
+                int p = rdata + 6;
+                QByteArray target;
+                if (readName(msg, &p, &target)) {
+                    srvTarget.insert(owner, target);
+                    srvPort.insert(owner, quint16(u16(rdata + 4)));
+                }
+            }
+            break;
+        case 16: { // TXT: length-prefixed key=value strings
+            int p = rdata;
+            while (p < rdata + length) {
+                const int n = uchar(msg.at(p));
+                const QByteArray entry = msg.mid(p + 1, n);
+                if (entry.startsWith("ty="))
+                    txtModel.insert(owner, QString::fromUtf8(entry.mid(3)));
+                p += 1 + n;
+            }
+            break;
+        }
+        case 1: // A
+            if (length == 4) {
+                quint32 ip = (quint32(uchar(msg.at(rdata))) << 24) | (quint32(uchar(msg.at(rdata + 1))) << 16)
+                           | (quint32(uchar(msg.at(rdata + 2))) << 8) | quint32(uchar(msg.at(rdata + 3)));
+                addresses.insert(owner, QHostAddress(ip));
+            }
+            break;
+        default: // PTR only names the instance; SRV/TXT/A come with it
+            break;
+        }
+        pos = rdata + length;
+    }
+}
+
+//
+// ~HI probes
+//
+void DiscoveryWorker::probeNext()
+{
+    while (probing.size() < MaxParallelProbes && !probeQueue.isEmpty())
+        startProbe(probeQueue.takeFirst());
+
+    if (probing.isEmpty() && probeQueue.isEmpty())
+        finishScan();
+}
+
+void DiscoveryWorker::startProbe(const QString &printer)
+{
+    QString host = printer;
+    quint16 port = 9100;
+    if (printer.count(':') == 1) {
+        host = printer.section(':', 0, 0);
+        port = printer.section(':', 1).toUShort();
+    }
+
+    QTcpSocket *socket = new QTcpSocket(this);
+    socket->setProperty("printer", printer);
+    probing.insert(socket, QByteArray());
+
+    connect(socket, &QTcpSocket::connected, socket, [socket]() { socket->write("~HI"); });
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+        QByteArray &reply = probing[socket];
+        reply += socket->readAll();
+        if (reply.contains('\x03'))
+            probeDone(socket, reply);
+    });
+    connect(socket, &QTcpSocket::errorOccurred, this, [this, socket]() {
+        probeDone(socket, probing.value(socket));
+    });
+    QTimer::singleShot(ConnectTimeoutMs, socket, [this, socket]() {
+        probeDone(socket, probing.value(socket));
+    });
+
+    socket->connectToHost(host, port);
+}
+
+void DiscoveryWorker::probeDone(QTcpSocket *socket, const QByteArray &reply)
+{
+    if (!probing.contains(socket))
+        return;
+    probing.remove(socket);
+
+    // Something listening on 9100 is a printer even if ~HI went unanswered
+    // (non-Zebra, or busy with another connection).
+    if (socket->state() == QAbstractSocket::ConnectedState || !reply.isEmpty()) {
+        DiscoveredPrinter p;
+        p.name = socket->property("printer").toString();
+        p.source = "scan";
+        parseHostIdentification(reply, &p);
+        addResult(p);
+    }
+
+    socket->disconnect();
+    socket->abort();
+    socket->deleteLater();
+    probeNext();
+}
+
+void DiscoveryWorker::parseHostIdentification(const QByteArray &reply, DiscoveredPrinter *printer)
+{
+    // <STX>ZD420-300dpi,V84.20.18Z,12,8176KB<ETX>
+    int stx = reply.indexOf('\x02');
+    int etx = reply.indexOf('\x03', stx + 1);
+    if (stx < 0 || etx < 0)
+        return;
+
+    const QList<QByteArray> fields = reply.mid(stx + 1, etx - stx - 1).split(',');
+    printer->model = QString::fromLatin1(fields.value(0).trimmed());
+    printer->dpi = dpiFromModel(printer->model);
+
+    if (printer->dpi == 0 && fields.size() > 2) {
+        switch (fields.at(2).trimmed().toInt()) { // dots per mm
+        case 6:  printer->dpi = 152; break;
+        case 8:  printer->dpi = 203; break;
+        case 12: printer->dpi = 300; break;
+        case 24: printer->dpi = 600; break;
+        default: break;
+        }
+    }
+}
+
+void DiscoveryWorker::finishScan()
+{
+    scanning = false;
+    emit finished(results);
+}
+
+//
+// PrinterDiscovery (GUI thread)
+//
+PrinterDiscovery::PrinterDiscovery(QObject *parent)
+    : QObject(parent),
+      thread(new QThread(this)),
+      worker(new DiscoveryWorker())
+{
+    thread->setObjectName("PrinterDiscovery");
+    worker->moveToThread(thread);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &DiscoveryWorker::finished, this, &PrinterDiscovery::onScanFinished);
+    thread->start();
+
+    loadCache();
+}
+
+PrinterDiscovery::~PrinterDiscovery()
+{
+    thread->quit();
+    thread->wait();
+}
+
+void PrinterDiscovery::refresh(const QStringList &extraHosts)
+{
+    if (scanning)
+        return;
+    scanning = true;
+
+    DiscoveryWorker *w = worker;
+    QMetaObject::invokeMethod(w, [w, extraHosts]() { w->scan(extraHosts); }, Qt::QueuedConnection);
+}
+
+bool PrinterDiscovery::hasSpoolerQueues() const
+{
+    for (const DiscoveredPrinter &p : cache) {
+        if (p.source == "cups")
+            return true;
+    }
+    return false;
+}
+
+void PrinterDiscovery::onScanFinished(const QList<DiscoveredPrinter> &printers)
+{
+    scanning = false;
+    cache = printers;
+    cacheTime = QDateTime::currentDateTime();
+    saveCache();
+    emit printersChanged();
+}
+
+void PrinterDiscovery::loadCache()
+{
+    const SettingsStore &settings = SettingsStore::instance();
+    cacheTime = settings.value("discovery/time").toDateTime();
+
+    const QJsonArray list = QJsonDocument::fromJson(settings.value("discovery/printers").toByteArray()).array();
+    for (const QJsonValue &v : list) {
+        const QJsonObject o = v.toObject();
+        DiscoveredPrinter p;
+        p.name = o.value("name").toString();
+        p.source = o.value("source").toString();
+        p.model = o.value("model").toString();
+        p.dpi = o.value("dpi").toInt();
+        if (!p.name.isEmpty())
+            cache << p;
+    }
+}
+
+void PrinterDiscovery::saveCache() const
+{
+    QJsonArray list;
+    for (const DiscoveredPrinter &p : cache) {
+        list.append(QJsonObject {
+            { "name", p.name },
+            { "source", p.source },
+            { "model", p.model },
+            { "dpi", p.dpi },
+        });
+    }
+
+    SettingsStore &settings = SettingsStore::instance();
+    settings.setValue("discovery/printers", QJsonDocument(list).toJson(QJsonDocument::Compact));
+    settings.setValue("discovery/time", cacheTime);
+}
@@ -0,0 +1,113 @@
+// src/PrinterStatus.cpp
+#include "PrinterStatus.hpp"
+
+#include <QList>
+#include <QRegularExpression>
+
+bool PrinterStatus::isFaulted() const
+{
+    if (!known || !reachable)
+        return false;
+    static const QStringList blocking = { "paused", "media-empty", "media-needed", "cover-open", "door-open" };
+    for (const QString &reason : spoolerReasons) {
+        if (blocking.contains(reason))
+            return true;
+    }
+    return paperOut || paused || headOpen || ribbonOut || overTemp || cutterFault;
+}
+
+QString PrinterStatus::summary() const
+{
+    if (!known)
+        return "Checking...";
+    if (!reachable)
+        return error.isEmpty() ? QString("Not responding") : error;
+
+    QStringList parts;
+    if (paused) parts << "Paused";
+    if (paperOut) parts << "Paper out";
+    if (headOpen) parts << "Head open";
+    if (ribbonOut) parts << "Ribbon out";
+    if (overTemp) parts << "Head too hot";
+    if (underTemp) parts << "Head too cold";
+    if (cutterFault) parts << "Cutter fault";
+    if (bufferFull) parts << "Buffer full";
+    for (const QString &reason : spoolerReasons)
+        parts << (reason == "paused" ? QString("Paused") : reason);
+
+    if (parts.isEmpty()) {
+        if (formatsInBuffer > 0)
+            return QString("Ready (%1 waiting)").arg(formatsInBuffer);
+        return "Ready";
+    }
+    return parts.join(", ");
+}
+
+bool PrinterStatus::parseHostStatus(const QByteArray &reply, PrinterStatus *status)
+{
+    // <STX>aaa,b,c,dddd,eee,f,g,h,iii,j,k,l<ETX><CR><LF>
+    // <STX>mmm,n,o,p,q,r,s,t,uuuuuuuu,v,www<ETX><CR><LF>
+    // <STX>xxxx,y<ETX><CR><LF>
+    QList<QByteArrayList> strings;
+    int pos = 0;
+    while (true) {
+        int stx = reply.indexOf('\x02', pos);
+        if (stx < 0)
+            break;
+        int etx = reply.indexOf('\x03', stx);
+        if (etx < 0)
+            break;
+        strings << reply.mid(stx + 1, etx - stx - 1).split(',');
+        pos = etx + 1;
+    }
+    if (strings.size() < 2 || strings[0].size() < 12 || strings[1].size() < 9)
+        return false;
+
+    auto flag = [](const QByteArray &field) { return field.trimmed() == "1"; };
+    const QByteArrayList &s1 = strings[0];
+    const QByteArrayList &s2 = strings[1];
+
+    status->paperOut = flag(s1[1]);
+    status->paused = flag(s1[2]);
+    status->formatsInBuffer = s1[4].trimmed().toInt();
+    status->bufferFull = flag(s1[5]);
+    status->underTemp = flag(s1[10]);
+    status->overTemp = flag(s1[11]);
+
+    status->headOpen = flag(s2[2]);
+    status->ribbonOut = flag(s2[3]);
+    status->labelsRemaining = s2[8].trimmed().toInt();
+    return true;
+}
+
+void PrinterStatus::parseExtendedStatus(const QByteArray &reply, PrinterStatus *status)
+{
+    //   ERRORS:         1 00000000 00000005
+    static const QRegularExpression errors(R"(ERRORS:\s*(\d)\s+([0-9A-Fa-f]{8})\s+([0-9A-Fa-f]{8}))");
+
+    QRegularExpressionMatch m = errors.match(QString::fromLatin1(reply));
+    if (!m.hasMatch() || m.captured(1) != "1")
+        return;
+
+    bool ok;
+    uint bits = m.captured(3).toUInt(&ok, 16);
+    if (!ok)
+        return;
+
+    if (bits & 0x01) status->paperOut = true;
+    if (bits & 0x02) status->ribbonOut = true;
+    if (bits & 0x04) status->headOpen = true;
+    if (bits & 0x08) status->cutterFault = true;
+    if (bits & 0x10) status->overTemp = true;
+}
+
+bool PrinterStatus::operator==(const PrinterStatus &o) const
+{
+    // 'updated' is deliberately left out: only changes are worth a signal.
+    return known == o.known && reachable == o.reachable && error == o.error
+        && paperOut == o.paperOut && paused == o.paused && headOpen == o.headOpen
+        && ribbonOut == o.ribbonOut && overTemp == o.overTemp && underTemp == o.underTemp
+        && bufferFull == o.bufferFull && cutterFault == o.cutterFault
+        && formatsInBuffer == o.formatsInBuffer && labelsRemaining == o.labelsRemaining
+        && spoolerReasons == o.spoolerReasons;
+}
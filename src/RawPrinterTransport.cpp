@@ -0,0 +1,162 @@
+// src/RawPrinterTransport.cpp
+#include "RawPrinterTransport.hpp"
+
+#include <QTcpSocket>
+#include <QHostAddress>
+
+RawPrinterTransport::RawPrinterTransport(QObject *parent)
+    : QObject(parent)
+{
+}
+
+RawPrinterTransport::~RawPrinterTransport()
+{
+    disconnectAll();
+}
+
+bool RawPrinterTransport::send(const QString &printer, const QByteArray &data, QString *error, qint64 *written)
+{
+    if (written)
+        *written = 0;
+
+    // A reused socket may have been closed by the printer since the last job
+    // without us noticing yet. Reconnect and resend only if none of 'data'
+    // went out: the printer prints every whole ^XA...^XZ it already has, so
+    // sending a partly written job again would duplicate labels.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        QTcpSocket *socket = socketFor(printer, &reused, error);
+        if (!socket)
+            return false;
+
+        qint64 sent = 0;
+        const QMetaObject::Connection counter = connect(socket, &QIODevice::bytesWritten, this,
+                                                        [&sent](qint64 bytes) { sent += bytes; });
+        bool ok = socket->write(data) == data.size();
+        while (ok && socket->bytesToWrite() > 0)
+            ok = socket->waitForBytesWritten(writeTimeoutMs);
+        disconnect(counter);
+
+        if (written)
+            *written = ok ? data.size() : sent;
+        if (ok)
+            return true;
+
+        if (error)
+            *error = QString("Write to %1 failed: %2").arg(printer, socket->errorString());
+        dropSocket(printer);
+
+        if (!reused || sent > 0)
+            return false;
+    }
+    return false;
+}
+
+bool RawPrinterTransport::query(const QString &printer, const QByteArray &request,
+                                const QByteArray &terminator, QByteArray *reply,
+                                QString *error, int idleTimeoutMs, int terminatorCount)
+{
+    reply->clear();
+
+    // send() drains anything unsolicited when it reuses the socket, so what
+    // arrives after this write is the answer to 'request'.
+    if (!send(printer, request, error))
+        return false;
+
+    QTcpSocket *socket = sockets.value(printer, nullptr);
+    while (socket && socket->waitForReadyRead(idleTimeoutMs)) {
+        reply->append(socket->readAll());
+        if (!terminator.isEmpty() && reply->count(terminator) >= terminatorCount)
+            return true;
+    }
+
+    if (reply->isEmpty()) {
+        if (error)
+            *error = QString("No reply from %1.").arg(printer);
+        return false;
+    }
+    return true;
+}
+
+void RawPrinterTransport::disconnectAll()
+{
+    for (QTcpSocket *socket : std::as_const(sockets)) {
+        socket->abort();
+        delete socket;
+    }
+    sockets.clear();
+}
+
+bool RawPrinterTransport::isNetworkAddress(const QString &printer)
+{
+    QString host;
+    quint16 port = DefaultPort;
+    splitHostPort(printer, &host, &port);
+
+    const bool hasPort = host != printer.trimmed();
+    return hasPort || !QHostAddress(host).isNull();
+}
+
+/* --- Helpers --- */
+
+QTcpSocket *RawPrinterTransport::socketFor(const QString &printer, bool *reused, QString *error)
+{
+    QTcpSocket *socket = sockets.value(printer, nullptr);
+    if (socket) {
+        // Give the socket a chance to process a pending close from the printer.
+        socket->waitForReadyRead(0);
+        if (socket->state() == QAbstractSocket::ConnectedState) {
+            socket->readAll(); // discard anything unsolicited
+            *reused = true;
+            return socket;
+        }
+        dropSocket(printer);
+    }
+
+    QString host;
+    quint16 port = DefaultPort;
+    splitHostPort(printer, &host, &port);
+
+    socket = new QTcpSocket(this);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+    socket->connectToHost(host, port);
+
+    if (!socket->waitForConnected(connectTimeoutMs)) {
+        if (error)
+            *error = QString("Could not connect to %1:%2: %3")
+                         .arg(host).arg(port).arg(socket->errorString());
+        delete socket;
+        return nullptr;
+    }
+
+    sockets.insert(printer, socket);
+    *reused = false;
+    return socket;
+}
+
+void RawPrinterTransport::dropSocket(const QString &printer)
+{
+    QTcpSocket *socket = sockets.take(printer);
+    if (!socket)
+        return;
+    socket->abort();
+    socket->deleteLater();
+}
+
+void RawPrinterTransport::splitHostPort(const QString &printer, QString *host, quint16 *port)
+{
+    QString p = printer.trimmed();
+
+    // "host:port" (a single colon; bare IPv6 addresses are left alone)
+    if (p.count(':') == 1) {
+        bool ok = false;
+        quint16 parsed = p.section(':', 1).toUShort(&ok);
+        if (ok && parsed != 0) {
+            *host = p.section(':', 0, 0);
+            *port = parsed;
+            return;
+        }
+    }
+    *host = p;
+}
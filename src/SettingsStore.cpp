@@ -0,0 +1,279 @@
+// src/SettingsStore.cpp
+#include "SettingsStore.hpp"
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <utility>
+
+namespace {
+
+// Runs on the writer thread.
+void persist(const QHash<QString, QVariant> &changes, bool clearFirst)
+{
+    QSettings settings("WFWestHS", "OilStickerApp");
+    if (clearFirst)
+        settings.clear();
+    for (auto it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        if (it.value().isValid())
+            settings.setValue(it.key(), it.value());
+        else
+            settings.remove(it.key());
+    }
+    settings.sync();
+}
+
+} // namespace
+
+SettingsStore &SettingsStore::instance()
+{
+    static SettingsStore *store = new SettingsStore(QCoreApplication::instance());
+    return *store;
+}
+
+SettingsStore::SettingsStore(QObject *parent)
+    : QObject(parent),
+      writeTimer(new QTimer(this)),
+      thread(new QThread(this)),
+      writer(new QObject())
+{
+    Q_ASSERT(!parent || QThread::currentThread() == parent->thread());
+
+    QSettings settings("WFWestHS", "OilStickerApp");
+    const QStringList keys = settings.allKeys();
+    for (const QString &key : keys)
+        values.insert(key, settings.value(key));
+
+    writeTimer->setSingleShot(true);
+    writeTimer->setInterval(WriteDelayMs);
+    connect(writeTimer, &QTimer::timeout, this, &SettingsStore::writePending);
+
+    thread->setObjectName("SettingsStore");
+    writer->moveToThread(thread);
+    connect(thread, &QThread::finished, writer, &QObject::deleteLater);
+    thread->start();
+}
+
+SettingsStore::~SettingsStore()
+{
+    // Queued behind any write still in flight, so the last one wins.
+    writeTimer->stop();
+    QHash<QString, QVariant> changes = std::exchange(pending, {});
+    const bool clearFirst = std::exchange(clearPending, false);
+    QMetaObject::invokeMethod(writer, [changes, clearFirst]() {
+        if (clearFirst || !changes.isEmpty())
+            persist(changes, clearFirst);
+        QThread::currentThread()->quit();
+    }, Qt::QueuedConnection);
+    thread->wait();
+}
+
+void SettingsStore::scheduleWrite()
+{
+    // The timer belongs to the main thread; changes from the print thread
+    // start it from there.
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!writeTimer->isActive())
+            writeTimer->start();
+    }, Qt::AutoConnection);
+}
+
+void SettingsStore::writePending()
+{
+    QHash<QString, QVariant> changes;
+    bool clearFirst;
+    {
+        QWriteLocker locker(&lock);
+        changes = std::exchange(pending, {});
+        clearFirst = std::exchange(clearPending, false);
+    }
+    QMetaObject::invokeMethod(writer, [changes, clearFirst]() {
+        persist(changes, clearFirst);
+    }, Qt::QueuedConnection);
+}
+
+//
+// Generic access
+//
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    QReadLocker locker(&lock);
+    return values.value(key, defaultValue);
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    {
+        QWriteLocker locker(&lock);
+        auto it = values.find(key);
+        if (it != values.end() && *it == value)
+            return;
+        values.insert(key, value);
+        pending.insert(key, value);
+    }
+    scheduleWrite();
+    emit changed(key);
+}
+
+void SettingsStore::clear()
+{
+    {
+        QWriteLocker locker(&lock);
+        values.clear();
+        pending.clear();
+        clearPending = true;
+    }
+    scheduleWrite();
+    emit changed(QString());
+}
+
+//
+// Typed settings
+//
+QString SettingsStore::printerName() const
+{
+    return value("printerName").toString();
+}
+
+void SettingsStore::setPrinterName(const QString &printer)
+{
+    setValue("printerName", printer);
+}
+
+QString SettingsStore::keytagPrinterName() const
+{
+    return value("keytagPrinterName").toString();
+}
+
+void SettingsStore::setKeytagPrinterName(const QString &printer)
+{
+    setValue("keytagPrinterName", printer);
+}
+
+QString SettingsStore::printerKind(const QString &printer) const
+{
+    // '/' separates settings groups; keep queue names with slashes flat.
+    return value("printerKind/" + QString(printer).replace('/', '_')).toString();
+}
+
+void SettingsStore::setPrinterKind(const QString &printer, const QString &kind)
+{
+    setValue("printerKind/" + QString(printer).replace('/', '_'), kind);
+}
+
+bool SettingsStore::useIppPrinting() const
+{
+    return value("useIppPrinting", false).toBool();
+}
+
+QString SettingsStore::networkProtocol() const
+{
+    return value("networkProtocol", useIppPrinting() ? "IPP" : "RAW").toString().toUpper();
+}
+
+void SettingsStore::setNetworkProtocol(const QString &protocol)
+{
+    setValue("networkProtocol", protocol);
+}
+
+bool SettingsStore::inlineFormats() const
+{
+    return value("inlineFormats", false).toBool();
+}
+
+void SettingsStore::setInlineFormats(bool on)
+{
+    setValue("inlineFormats", on);
+}
+
+bool SettingsStore::syncFormats() const
+{
+    return value("syncFormats", true).toBool();
+}
+
+bool SettingsStore::vehicleTicket() const
+{
+    return value("vehicleTicket", false).toBool();
+}
+
+void SettingsStore::setVehicleTicket(bool on)
+{
+    setValue("vehicleTicket", on);
+}
+
+int SettingsStore::defaultMiles() const
+{
+    return value("defaultMiles", 5000).toInt();
+}
+
+void SettingsStore::setDefaultMiles(int miles)
+{
+    setValue("defaultMiles", miles);
+}
+
+QString SettingsStore::labelStyle() const
+{
+    return value("labelStyle", "DEFAULT").toString().toUpper();
+}
+
+void SettingsStore::setLabelStyle(const QString &style)
+{
+    setValue("labelStyle", style);
+}
+
+QString SettingsStore::templateName(const QString &fallback) const
+{
+    return value("template", fallback).toString();
+}
+
+void SettingsStore::setTemplateName(const QString &name)
+{
+    setValue("template", name);
+}
+
+QString SettingsStore::background(const QString &style) const
+{
+    if (style == "KEYTAG")
+        return value("keytagBackground", ":/resources/keytag.png").toString();
+    return value("defaultBackground", ":/resources/default.png").toString();
+}
+
+void SettingsStore::setBackground(const QString &style, const QString &path)
+{
+    setValue(style == "KEYTAG" ? "keytagBackground" : "defaultBackground", path);
+}
+
+QString SettingsStore::backgroundFolder() const
+{
+    return value("backgroundFolder").toString();
+}
+
+void SettingsStore::setBackgroundFolder(const QString &folder)
+{
+    setValue("backgroundFolder", folder);
+}
+
+QString SettingsStore::logoGraphic() const
+{
+    return value("logoGraphic").toString();
+}
+
+void SettingsStore::setLogoGraphic(const QString &path)
+{
+    setValue("logoGraphic", path);
+}
+
+QPoint SettingsStore::logoPosition(const QString &style) const
+{
+    return value(style == "KEYTAG" ? "keytagLogoPosition" : "defaultLogoPosition", QPoint(-1, -1)).toPoint();
+}
+
+void SettingsStore::setLogoPosition(const QString &style, const QPoint &dots)
+{
+    const bool placed = dots.x() >= 0 && dots.y() >= 0;
+    setValue(style == "KEYTAG" ? "keytagLogoPosition" : "defaultLogoPosition",
+             placed ? QVariant(dots) : QVariant());
+}
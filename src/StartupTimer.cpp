@@ -0,0 +1,108 @@
+// src/StartupTimer.cpp
+#include "StartupTimer.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTimer>
+#include <QWidget>
+#include <functional>
+
+namespace {
+
+QElapsedTimer startupClock;
+qint64 lastMark = 0;
+QList<QPair<QString, qint64>> marks;
+bool finished = false;
+
+// Waits for the window's first paint, then for the event loop to drain.
+class FirstFrameFilter : public QObject
+{
+public:
+    using QObject::QObject;
+
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            watched->removeEventFilter(this);
+            StartupTimer::mark("first frame");
+            QTimer::singleShot(0, this, [this]() {
+                StartupTimer::mark("interactive");
+                finish();
+                deleteLater();
+            });
+        }
+        return false;
+    }
+
+    std::function<void()> finish;
+};
+
+} // namespace
+
+void StartupTimer::start()
+{
+    startupClock.start();
+    lastMark = 0;
+    marks.clear();
+    finished = false;
+}
+
+void StartupTimer::mark(const QString &phase)
+{
+    if (!startupClock.isValid() || finished)
+        return;
+    const qint64 now = startupClock.elapsed();
+    marks.append({ phase, now - lastMark });
+    lastMark = now;
+}
+
+QList<QPair<QString, qint64>> StartupTimer::phases()
+{
+    return marks;
+}
+
+void StartupTimer::finishWhenInteractive(QWidget *window)
+{
+    if (!startupClock.isValid() || finished)
+        return;
+    FirstFrameFilter *filter = new FirstFrameFilter(window);
+    filter->finish = []() { StartupTimer::finish(); };
+    window->installEventFilter(filter);
+}
+
+QString StartupTimer::logPath()
+{
+    // Same folder as the print journal.
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + "/WFWestHS/OilStickerApp/startup.log";
+}
+
+void StartupTimer::finish()
+{
+    if (finished)
+        return;
+    finished = true;
+
+    QStringList fields;
+    fields << QDateTime::currentDateTime().toString(Qt::ISODate) << QString::number(lastMark);
+    for (const auto &m : std::as_const(marks))
+        fields << QString("%1=%2").arg(m.first).arg(m.second);
+    qInfo().noquote() << "Startup:" << lastMark << "ms to interactive;" << fields.mid(2).join(", ");
+
+    const QString path = logPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    if (QFileInfo(path).size() > MaxLogBytes) {
+        QFile::remove(path + ".old");
+        QFile::rename(path, path + ".old");
+    }
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        file.write(fields.join('\t').toUtf8() + '\n');
+}
@@ -0,0 +1,277 @@
+// src/TemplateSync.cpp
+#include "TemplateSync.hpp"
+#include "RawPrinterTransport.hpp"
+#include "ZplTemplate.hpp"
+#include "SettingsStore.hpp"
+#include "ZplGraphic.hpp"
+#include "ZplRasterizer.hpp"
+
+#include <QCryptographicHash>
+#include <QImage>
+#include <QRegularExpression>
+#include <QDebug>
+
+TemplateSync::TemplateSync(RawPrinterTransport *transport)
+    : transport(transport)
+{
+}
+
+QList<TemplateSync::Result> TemplateSync::syncNetworkPrinter(const QString &printer, const QStringList &formats)
+{
+    QList<Result> results;
+    if (formats.isEmpty())
+        return results;
+    const QString drive = QString(QChar(Drive)) + ":";
+
+    // -----------------------------
+    // What does the printer hold?
+    // -----------------------------
+    QByteArray listing;
+    QString error;
+    if (!transport->query(printer, "^XA^HW" + drive.toLatin1() + "*.ZPL^XZ", "\x03", &listing, &error)) {
+        for (const QString &format : formats)
+            results << Result { format, Failed, QString("Format list unavailable: %1").arg(error) };
+        return results;
+    }
+    const QStringList stored = parseDirectory(listing);
+
+    for (const QString &name : formats) {
+        const QString format = name.toUpper();
+        Result r;
+        r.format = format;
+
+        const QByteArray source = ZplTemplateLibrary::instance().source(format);
+        if (source.isEmpty()) {
+            r.message = "No local copy in zpl/.";
+            results << r;
+            continue;
+        }
+
+        // -----------------------------
+        // Compare the stored copy
+        // -----------------------------
+        bool changed = true;
+        if (stored.contains(format)) {
+            QByteArray upload;
+            if (transport->query(printer, "^XA^HF" + drive.toLatin1() + format.toLatin1() + "^XZ",
+                                 "^XZ", &upload, &error)) {
+                changed = contentHash(upload) != contentHash(source);
+            } else {
+                qWarning() << "TemplateSync:" << format << "upload from" << printer << "failed:" << error;
+            }
+            if (!changed) {
+                r.outcome = UpToDate;
+                r.message = "Up to date";
+                results << r;
+                continue;
+            }
+        }
+
+        // -----------------------------
+        // Download missing / changed
+        // -----------------------------
+        if (transport->send(printer, downloadCommand(format, source), &error)) {
+            r.outcome = Downloaded;
+            r.message = stored.contains(format) ? "Updated" : "Installed";
+        } else {
+            r.message = error;
+        }
+        results << r;
+    }
+    return results;
+}
+
+QHash<QString, QByteArray> TemplateSync::pendingDownloads(const QString &printer, const QStringList &formats)
+{
+    QHash<QString, QByteArray> jobs;
+    const SettingsStore &settings = SettingsStore::instance();
+
+    for (const QString &name : formats) {
+        const QString format = name.toUpper();
+        const QByteArray source = ZplTemplateLibrary::instance().source(format);
+        if (source.isEmpty())
+            continue;
+        if (settings.value(settingsKey(printer, format)).toByteArray() != contentHash(source).toHex())
+            jobs.insert(format, downloadCommand(format, source));
+    }
+    return jobs;
+}
+
+void TemplateSync::markDownloaded(const QString &printer, const QString &format)
+{
+    const QByteArray source = ZplTemplateLibrary::instance().source(format);
+    SettingsStore::instance().setValue(settingsKey(printer, format.toUpper()), contentHash(source).toHex());
+}
+
+//
+// Logo graphic
+//
+QList<TemplateSync::Result> TemplateSync::syncNetworkLogo(const QString &printer, int dpi)
+{
+    const QString path = SettingsStore::instance().logoGraphic();
+    if (path.isEmpty())
+        return {};
+
+    Result r;
+    r.format = LogoName;
+    const QByteArray command = logoCommand(path, dpi, &r.message);
+    if (command.isEmpty())
+        return { r };
+
+    // Printed labels depend on it being there; a reset printer loses it
+    // even though the hash still matches.
+    const QString drive = QString(QChar(Drive)) + ":";
+    const QByteArray hash = logoHash(command, dpi);
+    QByteArray listing;
+    QString error;
+    if (transport->query(printer, "^XA^HW" + drive.toLatin1() + "*.GRF^XZ", "\x03", &listing, &error)
+        && parseDirectory(listing).contains(LogoName)
+        && SettingsStore::instance().value(settingsKey(printer, LogoName)).toByteArray() == hash) {
+        r.outcome = UpToDate;
+        r.message = "Up to date";
+        return { r };
+    }
+
+    if (transport->send(printer, command, &error)) {
+        markLogoDownloaded(printer, hash);
+        r.outcome = Downloaded;
+        r.message = "Installed";
+    } else {
+        r.message = error;
+    }
+    return { r };
+}
+
+QByteArray TemplateSync::pendingLogo(const QString &printer, int dpi, QByteArray *hash, QString *error)
+{
+    const QString path = SettingsStore::instance().logoGraphic();
+    if (path.isEmpty())
+        return QByteArray();
+
+    const QByteArray command = logoCommand(path, dpi, error);
+    if (command.isEmpty())
+        return QByteArray();
+    *hash = logoHash(command, dpi);
+    if (SettingsStore::instance().value(settingsKey(printer, LogoName)).toByteArray() == *hash)
+        return QByteArray();
+    return command;
+}
+
+void TemplateSync::markLogoDownloaded(const QString &printer, const QByteArray &hash)
+{
+    SettingsStore::instance().setValue(settingsKey(printer, LogoName), hash);
+}
+
+ZplGraphic TemplateSync::logoGraphic(const QString &path, int dpi)
+{
+    if (dpi <= 0)
+        dpi = ZplRasterizer::DefaultDpi;
+    const int labelDots = qRound(ZplRasterizer::DefaultLabelInches * dpi);
+    return ZplGraphic::fromImage(QImage(path), dpi, labelDots, labelDots);
+}
+
+QByteArray TemplateSync::logoPlacement(const QString &style)
+{
+    const SettingsStore &settings = SettingsStore::instance();
+    if (settings.logoGraphic().isEmpty())
+        return QByteArray();
+    const QPoint at = settings.logoPosition(style);
+    if (at.x() < 0 || at.y() < 0)
+        return QByteArray();
+    return ZplGraphic::recallCommand(Drive, LogoName, at.x(), at.y());
+}
+
+QByteArray TemplateSync::logoCommand(const QString &path, int dpi, QString *error)
+{
+    const ZplGraphic graphic = logoGraphic(path, dpi);
+    if (graphic.isNull()) {
+        *error = QString("Cannot read logo %1").arg(path);
+        return QByteArray();
+    }
+    return graphic.downloadCommand(Drive, LogoName);
+}
+
+QByteArray TemplateSync::logoHash(const QByteArray &command, int dpi)
+{
+    // A PNG without a resolution converts the same at any dpi; the printer
+    // it was sized for still counts.
+    if (dpi <= 0)
+        dpi = ZplRasterizer::DefaultDpi;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(command);
+    hash.addData(QByteArray::number(dpi));
+    return hash.result().toHex();
+}
+
+//
+// Format helpers
+//
+QByteArray TemplateSync::downloadCommand(const QString &name, const QByteArray &source)
+{
+    QByteArray body = source.trimmed();
+    if (body.startsWith("^XA"))
+        body.remove(0, 3);
+    if (body.endsWith("^XZ"))
+        body.chop(3);
+
+    QByteArray out = "^XA\n^DF";
+    out += Drive;
+    out += ':';
+    out += name.toUpper().toLatin1();
+    out += "^FS\n";
+    out += body.trimmed();
+    out += "\n^XZ\n";
+    return out;
+}
+
+QByteArray TemplateSync::contentHash(const QByteArray &format)
+{
+    // Only the ^XA...^XZ part (uploads come wrapped in STX/ETX).
+    int start = format.indexOf("^XA");
+    int end = format.lastIndexOf("^XZ");
+    QByteArray src = (start >= 0 && end > start) ? format.mid(start + 3, end - start - 3) : format;
+
+    // Join lines without their surrounding whitespace.
+    QByteArray body;
+    for (const QByteArray &line : src.split('\n'))
+        body += line.trimmed();
+
+    // Drop ^FX comments (they run to the next command prefix) and the
+    // ^DF<drive>:<name>^FS header of an uploaded copy.
+    int fx;
+    while ((fx = body.indexOf("^FX")) >= 0) {
+        int next = fx + 3;
+        while (next < body.size() && body.at(next) != '^' && body.at(next) != '~')
+            ++next;
+        body.remove(fx, next - fx);
+    }
+    if (body.startsWith("^DF")) {
+        int fs = body.indexOf("^FS");
+        body.remove(0, fs < 0 ? body.size() : fs + 3);
+    }
+
+    return QCryptographicHash::hash(body, QCryptographicHash::Sha1);
+}
+
+QStringList TemplateSync::parseDirectory(const QByteArray &listing)
+{
+    // Lines look like "* E:DEFAULT.ZPL    412"
+    static const QRegularExpression entry(R"(([A-Z]):([A-Za-z0-9_\-\.]+)\s+\d+)");
+
+    QStringList names;
+    auto it = entry.globalMatch(QString::fromLatin1(listing));
+    while (it.hasNext()) {
+        const QString name = it.next().captured(2).toUpper();
+        if (!names.contains(name))
+            names << name;
+    }
+    return names;
+}
+
+QString TemplateSync::settingsKey(const QString &printer, const QString &format)
+{
+    // '/' separates settings groups; keep queue names with slashes flat.
+    QString p = printer;
+    p.replace('/', '_');
+    return QString("templateSync/%1/%2").arg(p, format);
+}
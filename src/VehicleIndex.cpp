@@ -0,0 +1,304 @@
+// src/VehicleIndex.cpp
+#include "VehicleIndex.hpp"
+#include "PrintJournal.hpp"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 FileMagic = 0x56494458;   // "VIDX"
+constexpr qint32 FileVersion = 1;
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+// Overwrite 'field' only with something non-empty.
+void update(QString &field, const QString &value)
+{
+    const QString trimmed = value.trimmed();
+    if (!trimmed.isEmpty())
+        field = trimmed;
+}
+
+} // namespace
+
+VehicleIndex::VehicleIndex(QObject *parent)
+    : QObject(parent)
+{
+    saveTimer = new QTimer(this);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(SaveDelayMs);
+    connect(saveTimer, &QTimer::timeout, this, [this]() {
+        QString error;
+        if (!save(&error))
+            qWarning() << "Vehicle index not saved:" << error;
+    });
+}
+
+VehicleIndex::~VehicleIndex()
+{
+    if (saveTimer->isActive()) {
+        QString error;
+        if (!save(&error))
+            qWarning() << "Vehicle index not saved:" << error;
+    }
+}
+
+QString VehicleIndex::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + "/WFWestHS/OilStickerApp/vehicles.dat";
+}
+
+QString VehicleIndex::normalize(const QString &text)
+{
+    QString key;
+    key.reserve(text.size());
+    for (QChar c : text) {
+        if (!c.isSpace() && c != '-')
+            key.append(c.toUpper());
+    }
+    return key;
+}
+
+//
+// Persistence
+//
+bool VehicleIndex::load(const QString &path, const PrintJournal *journal, QString *error)
+{
+    filePath = path;
+    records.clear();
+
+    QFile file(path);
+    if (!file.exists()) {
+        // First run with the index: learn from what has been printed so far,
+        // then sort the keys once.
+        if (!journal || journal->count() == 0)
+            return true;
+
+        int current = -1;
+        for (const JournalEntry &e : journal->history()) {
+            if (!e.hasFields || e.reprintOf)
+                continue;
+            if (e.job.isKeyTag())
+                current = mergeKeyTag(e.job, e.time);
+            else if (current >= 0)
+                mergeSticker(current, e.job, e.time);
+        }
+        rebuildKeys();
+        return save(error);
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(StreamVersion);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 size = 0;
+    in >> magic >> version >> size;
+    if (magic != FileMagic || version != FileVersion || size < 0) {
+        *error = QString("%1 is not a vehicle index.").arg(path);
+        return false;
+    }
+
+    records.reserve(size);
+    for (qint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        VehicleRecord r;
+        in >> r.customer >> r.car >> r.plate >> r.vin >> r.color >> r.repairOrders
+           >> r.oilType >> r.interval >> r.lastSeen;
+        records.append(r);
+    }
+    if (in.status() != QDataStream::Ok) {
+        *error = QString("%1 is truncated.").arg(path);
+        records.clear();
+        return false;
+    }
+
+    rebuildKeys();
+    return true;
+}
+
+bool VehicleIndex::save(QString *error) const
+{
+    if (filePath.isEmpty())
+        return true;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *error = QString("Cannot write %1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(StreamVersion);
+    out << FileMagic << FileVersion << qint32(records.size());
+    for (const VehicleRecord &r : records) {
+        out << r.customer << r.car << r.plate << r.vin << r.color << r.repairOrders
+            << r.oilType << r.interval << r.lastSeen;
+    }
+
+    if (!file.commit()) {
+        *error = QString("Cannot write %1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+void VehicleIndex::scheduleSave()
+{
+    if (!saveTimer->isActive())
+        saveTimer->start();
+}
+
+//
+// Keys
+//
+void VehicleIndex::rebuildKeys()
+{
+    for (QList<KeyEntry> &list : keys)
+        list.clear();
+    byVin.clear();
+    byPlate.clear();
+
+    for (int i = 0; i < records.size(); ++i) {
+        const VehicleRecord &r = records.at(i);
+        const QString plate = normalize(r.plate);
+        const QString vin = normalize(r.vin);
+        if (!plate.isEmpty()) {
+            keys[Plate].append({ plate, i });
+            byPlate.insert(plate, i);
+        }
+        if (!vin.isEmpty()) {
+            keys[Vin].append({ vin, i });
+            byVin.insert(vin, i);
+        }
+        for (const QString &ro : r.repairOrders) {
+            const QString key = normalize(ro);
+            if (!key.isEmpty())
+                keys[RepairOrder].append({ key, i });
+        }
+    }
+
+    for (QList<KeyEntry> &list : keys) {
+        std::sort(list.begin(), list.end(), [](const KeyEntry &a, const KeyEntry &b) {
+            return a.key < b.key || (a.key == b.key && a.record < b.record);
+        });
+        list.erase(std::unique(list.begin(), list.end(), [](const KeyEntry &a, const KeyEntry &b) {
+            return a.key == b.key && a.record == b.record;
+        }), list.end());
+    }
+}
+
+void VehicleIndex::insertKey(Key key, const QString &text, int record)
+{
+    const QString k = normalize(text);
+    if (k.isEmpty())
+        return;
+
+    QList<KeyEntry> &list = keys[key];
+    auto it = std::lower_bound(list.begin(), list.end(), k, [record](const KeyEntry &e, const QString &value) {
+        return e.key < value || (e.key == value && e.record < record);
+    });
+    if (it != list.end() && it->key == k && it->record == record)
+        return;
+    list.insert(it, { k, record });
+}
+
+int VehicleIndex::mergeKeyTag(const LabelJob &job, const QDateTime &when)
+{
+    const QString vin = normalize(job.vin);
+    const QString plate = normalize(job.plate);
+    if (vin.isEmpty() && plate.isEmpty() && job.repairOrder.trimmed().isEmpty())
+        return -1;
+
+    // Same vehicle: same VIN, or same plate unless the VINs disagree
+    // (plates move between cars).
+    int index = vin.isEmpty() ? -1 : byVin.value(vin, -1);
+    if (index < 0 && !plate.isEmpty()) {
+        index = byPlate.value(plate, -1);
+        if (index >= 0 && !vin.isEmpty() && !records.at(index).vin.isEmpty())
+            index = -1;
+    }
+    if (index < 0) {
+        index = int(records.size());
+        records.append(VehicleRecord());
+    }
+
+    VehicleRecord &r = records[index];
+    update(r.customer, job.customer);
+    update(r.car, job.car);
+    update(r.plate, job.plate);
+    update(r.vin, job.vin);
+    update(r.color, job.color);
+    const QString ro = job.repairOrder.trimmed();
+    if (!ro.isEmpty() && !r.repairOrders.contains(ro))
+        r.repairOrders.append(ro);
+    r.lastSeen = when;
+
+    if (!plate.isEmpty())
+        byPlate.insert(plate, index);
+    if (!vin.isEmpty())
+        byVin.insert(vin, index);
+    return index;
+}
+
+bool VehicleIndex::mergeSticker(int record, const LabelJob &job, const QDateTime &when)
+{
+    if (record < 0 || record >= records.size())
+        return false;
+
+    VehicleRecord &r = records[record];
+    update(r.oilType, job.oilType);
+    update(r.interval, job.interval);
+    r.lastSeen = when;
+    return true;
+}
+
+int VehicleIndex::addKeyTag(const LabelJob &job, const QDateTime &when)
+{
+    const int index = mergeKeyTag(job, when);
+    if (index < 0)
+        return -1;
+
+    const VehicleRecord &r = records.at(index);
+    insertKey(Plate, r.plate, index);
+    insertKey(Vin, r.vin, index);
+    insertKey(RepairOrder, job.repairOrder.trimmed(), index);
+    scheduleSave();
+    return index;
+}
+
+void VehicleIndex::addSticker(int record, const LabelJob &job, const QDateTime &when)
+{
+    if (mergeSticker(record, job, when))
+        scheduleSave();
+}
+
+QList<int> VehicleIndex::search(Key key, const QString &prefix, int max) const
+{
+    QList<int> found;
+    const QString p = normalize(prefix);
+    if (p.isEmpty())
+        return found;
+
+    const QList<KeyEntry> &list = keys[key];
+    auto it = std::lower_bound(list.cbegin(), list.cend(), p, [](const KeyEntry &e, const QString &p) {
+        return e.key < p;
+    });
+    for (; it != list.cend() && found.size() < max && it->key.startsWith(p); ++it) {
+        if (!found.contains(it->record))
+            found.append(it->record);
+    }
+    return found;
+}
@@ -0,0 +1,205 @@
+// src/ZplGraphic.cpp
+#include "ZplGraphic.hpp"
+
+#include <QList>
+#include <QtMath>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+// Qt's default resolution when a PNG has no pHYs chunk (72 dpi).
+constexpr int DefaultDotsPerMeter = 2835;
+
+// Repeat-count characters for 'count' copies of the next hex digit.
+void appendRepeat(QByteArray &out, int count)
+{
+    while (count >= 400) {
+        out += 'z';
+        count -= 400;
+    }
+    if (count >= 20) {
+        out += char('g' + count / 20 - 1);
+        count %= 20;
+    }
+    if (count > 0)
+        out += char('G' + count - 1);
+}
+
+} // namespace
+
+ZplGraphic ZplGraphic::fromImage(const QImage &image, int dpi, int maxWidth, int maxHeight)
+{
+    ZplGraphic g;
+    if (image.isNull() || dpi <= 0)
+        return g;
+
+    // -----------------------------
+    // Size in printer dots
+    // -----------------------------
+    QSize dots = image.size();
+    const int dpmX = image.dotsPerMeterX();
+    const int dpmY = image.dotsPerMeterY();
+    if (dpmX > 0 && dpmY > 0 && dpmX != DefaultDotsPerMeter) {
+        const qreal dotsPerMeter = dpi / 0.0254;
+        dots = QSize(qMax(1, qRound(image.width() * dotsPerMeter / dpmX)),
+                     qMax(1, qRound(image.height() * dotsPerMeter / dpmY)));
+    }
+    if ((maxWidth > 0 && dots.width() > maxWidth) || (maxHeight > 0 && dots.height() > maxHeight))
+        dots.scale(maxWidth > 0 ? maxWidth : dots.width(), maxHeight > 0 ? maxHeight : dots.height(),
+                   Qt::KeepAspectRatio);
+
+    QImage src = image.convertToFormat(QImage::Format_ARGB32);
+    if (src.size() != dots)
+        src = src.scaled(dots, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    // -----------------------------
+    // Floyd-Steinberg to 1 bpp
+    // -----------------------------
+    const int w = src.width();
+    const int h = src.height();
+    g.rowBytes = (w + 7) / 8;
+    g.rows = h;
+    g.bits = QByteArray(g.rowBytes * h, '\0');
+
+    // Error rows in 1/16 steps, with a guard cell either side.
+    QList<int> current(w + 2, 0);
+    QList<int> next(w + 2, 0);
+
+    for (int y = 0; y < h; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(src.constScanLine(y));
+        uchar *out = reinterpret_cast<uchar *>(g.bits.data()) + y * g.rowBytes;
+        std::fill(next.begin(), next.end(), 0);
+
+        for (int x = 0; x < w; ++x) {
+            const QRgb p = line[x];
+            // Luma, composited over white paper.
+            const int alpha = qAlpha(p);
+            const int luma = (qRed(p) * 77 + qGreen(p) * 150 + qBlue(p) * 29) >> 8;
+            const int gray = (luma * alpha + 255 * (255 - alpha)) / 255;
+
+            const int value = gray + current[x + 1] / 16;
+            const bool black = value < 128;
+            const int error = value - (black ? 0 : 255);
+            if (black)
+                out[x >> 3] |= uchar(0x80 >> (x & 7));
+
+            current[x + 2] += error * 7;
+            next[x] += error * 3;
+            next[x + 1] += error * 5;
+            next[x + 2] += error;
+        }
+        std::swap(current, next);
+    }
+    return g;
+}
+
+QByteArray ZplGraphic::encoded(Encoding encoding) const
+{
+    if (isNull())
+        return QByteArray();
+    if (encoding == Z64)
+        return encodeZ64();
+    if (encoding == CompressedHex)
+        return encodeCompressedHex();
+
+    // Z64 unless run-length does better (tiny or very plain art).
+    const QByteArray z64 = encodeZ64();
+    const QByteArray hex = encodeCompressedHex();
+    return hex.size() < z64.size() ? hex : z64;
+}
+
+QByteArray ZplGraphic::encodeZ64() const
+{
+    // qCompress() is a zlib stream behind a 4-byte length; ZPL wants the
+    // stream alone.
+    const QByteArray base64 = qCompress(bits, 9).mid(4).toBase64();
+    return ":Z64:" + base64 + ':' + QByteArray::number(crc16(base64), 16).rightJustified(4, '0');
+}
+
+QByteArray ZplGraphic::encodeCompressedHex() const
+{
+    QByteArray out;
+    out.reserve(bits.size());
+    const QByteArray hex = bits.toHex().toUpper();
+    const int rowDigits = rowBytes * 2;
+
+    for (int y = 0; y < rows; ++y) {
+        const char *row = hex.constData() + y * rowDigits;
+
+        if (y > 0 && std::memcmp(row, row - rowDigits, size_t(rowDigits)) == 0) {
+            out += ':';
+            continue;
+        }
+
+        // A run of 0 or F reaching the end of the row is one character.
+        int end = rowDigits;
+        char fill = 0;
+        if (row[end - 1] == '0' || row[end - 1] == 'F') {
+            fill = row[end - 1];
+            while (end > 0 && row[end - 1] == fill)
+                --end;
+        }
+
+        for (int i = 0; i < end;) {
+            int run = 1;
+            while (i + run < end && row[i + run] == row[i])
+                ++run;
+            if (run > 1)
+                appendRepeat(out, run);
+            out += row[i];
+            i += run;
+        }
+        if (fill)
+            out += fill == '0' ? ',' : '!';
+    }
+    return out;
+}
+
+QByteArray ZplGraphic::fieldCommand(Encoding encoding) const
+{
+    const QByteArray total = QByteArray::number(totalBytes());
+    return "^GFA," + total + ',' + total + ',' + QByteArray::number(rowBytes) + ',' + encoded(encoding);
+}
+
+QByteArray ZplGraphic::downloadCommand(char drive, const QString &name, Encoding encoding) const
+{
+    QByteArray out = "~DG";
+    out += drive;
+    out += ':';
+    out += name.toUpper().toLatin1();
+    out += ',' + QByteArray::number(totalBytes()) + ',' + QByteArray::number(rowBytes) + ',';
+    out += encoded(encoding);
+    out += '\n';
+    return out;
+}
+
+QByteArray ZplGraphic::recallCommand(char drive, const QString &name, int x, int y)
+{
+    QByteArray out = "^FO" + QByteArray::number(x) + ',' + QByteArray::number(y) + "^XG";
+    out += drive;
+    out += ':';
+    out += name.toUpper().toLatin1();
+    out += ",1,1^FS";
+    return out;
+}
+
+quint16 ZplGraphic::crc16(const QByteArray &data)
+{
+    static const auto table = []() {
+        std::array<quint16, 256> t {};
+        for (int i = 0; i < 256; ++i) {
+            quint16 crc = quint16(i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+            t[i] = crc;
+        }
+        return t;
+    }();
+
+    quint16 crc = 0;
+    for (const char c : data)
+        crc = quint16((crc << 8) ^ table[((crc >> 8) ^ uchar(c)) & 0xFF]);
+    return crc;
+}
@@ -0,0 +1,571 @@
+// src/ZplRasterizer.cpp
+#include "ZplRasterizer.hpp"
+#include "ZplTemplate.hpp"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QFont>
+#include <QFontMetrics>
+#include <QFontDatabase>
+#include <QCoreApplication>
+#include <QPointer>
+#include <QThreadPool>
+#include <QtEndian>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+// Font 0 registration, shared by font0Family() and loadFont0Async().
+std::once_flag font0Once;
+QString font0;
+std::atomic<bool> font0Loaded { false };
+
+// GUI thread only.
+struct Font0Waiter
+{
+    QPointer<QObject> context;
+    std::function<void()> ready;
+};
+QList<Font0Waiter> font0Waiters;
+bool font0Started = false;
+
+struct Command
+{
+    QByteArray code;   // "FO", "A0", "FD", ...
+    QString params;
+};
+
+// ^XX / ~XX commands with their parameters (up to the next prefix).
+// Line breaks are not significant in ZPL and are dropped.
+QList<Command> tokenize(const QByteArray &src)
+{
+    QList<Command> commands;
+    int i = 0;
+    const int n = src.size();
+
+    while (i < n) {
+        if (src.at(i) != '^' && src.at(i) != '~') {
+            ++i;
+            continue;
+        }
+        if (i + 2 >= n)
+            break;
+
+        Command c;
+        c.code = src.mid(i + 1, 2).toUpper();
+        int start = i + 3;
+        int end = start;
+        while (end < n && src.at(end) != '^' && src.at(end) != '~')
+            ++end;
+
+        QByteArray params = src.mid(start, end - start);
+        params.replace('\r', QByteArray()).replace('\n', QByteArray());
+        c.params = QString::fromUtf8(params);
+        commands << c;
+        i = end;
+    }
+    return commands;
+}
+
+int intParam(const QStringList &params, int index, int fallback)
+{
+    bool ok;
+    int v = params.value(index).trimmed().toInt(&ok);
+    return ok ? v : fallback;
+}
+
+} // namespace
+
+ZplRasterizer::ZplRasterizer(int dpi)
+    : dotsPerInch(dpi > 0 ? dpi : DefaultDpi)
+{
+    const int side = qRound(DefaultLabelInches * dotsPerInch);
+    size = QSize(side, side);
+}
+
+void ZplRasterizer::setFormat(const QString &formatName, const QByteArray &format)
+{
+    name = formatName.toUpper();
+    const int side = qRound(DefaultLabelInches * dotsPerInch);
+    size = QSize(side, side);
+    elements.clear();
+
+    parse(format);
+    buildStaticLayer();
+}
+
+bool ZplRasterizer::loadFormat(const QString &formatName)
+{
+    const QByteArray source = ZplTemplateLibrary::instance().source(formatName);
+    if (source.isEmpty()) {
+        elements.clear();
+        staticLayer = QImage();
+        name = formatName.toUpper();
+        return false;
+    }
+    setFormat(formatName, source);
+    return true;
+}
+
+QList<int> ZplRasterizer::fieldNumbers() const
+{
+    QList<int> numbers;
+    for (const Element &e : elements) {
+        if (e.fieldNumber > 0 && !numbers.contains(e.fieldNumber))
+            numbers << e.fieldNumber;
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+QRect ZplRasterizer::fieldBounds(int fieldNumber) const
+{
+    // Text can run to the label edge; one line tall (with descenders and
+    // the font's line gap).
+    QRect bounds;
+    for (const Element &e : elements) {
+        if (e.fieldNumber != fieldNumber)
+            continue;
+        const int line = qCeil(e.fontHeight * 1.5);
+        QRect r;
+        switch (e.orientation) {
+        case 'R':
+        case 'B':
+            r = QRect(e.origin.x(), 0, line, size.height());
+            break;
+        case 'I':
+            r = QRect(0, e.origin.y(), size.width(), line);
+            break;
+        default:
+            r = QRect(e.origin.x(), e.origin.y(), size.width() - e.origin.x(), line);
+            break;
+        }
+        bounds |= r;
+    }
+    return bounds & QRect(QPoint(0, 0), size);
+}
+
+//
+// Parse
+//
+void ZplRasterizer::parse(const QByteArray &format)
+{
+    QPoint home;
+    Element field;             // field being built, committed on ^FS
+    bool hasText = false;
+    bool hasBox = false;
+    QChar hexIndicator;        // set by ^FH for the current field
+    int defaultHeight = 9;     // ^CF
+
+    auto resetField = [&]() {
+        QPoint origin = field.origin;
+        field = Element();
+        field.origin = origin;
+        field.fontHeight = defaultHeight;
+        hasText = false;
+        hasBox = false;
+        hexIndicator = QChar();
+    };
+    resetField();
+
+    for (const Command &c : tokenize(format)) {
+        const QStringList p = c.params.split(',');
+
+        if (c.code == "XA") {
+            resetField();
+        } else if (c.code == "LH") {
+            home = QPoint(intParam(p, 0, 0), intParam(p, 1, 0));
+        } else if (c.code == "PW") {
+            size.setWidth(intParam(p, 0, size.width()));
+        } else if (c.code == "LL") {
+            size.setHeight(intParam(p, 0, size.height()));
+        } else if (c.code == "CF") {
+            defaultHeight = intParam(p, 1, defaultHeight);
+            field.fontHeight = defaultHeight;
+        } else if (c.code == "FO") {
+            field.origin = home + QPoint(intParam(p, 0, 0), intParam(p, 1, 0));
+        } else if (c.code.startsWith('A')) {
+            // ^A0N,h,w: the orientation follows the font name directly.
+            const QString o = p.value(0).trimmed().toUpper();
+            field.orientation = o.isEmpty() ? 'N' : o.at(0).toLatin1();
+            field.fontHeight = intParam(p, 1, defaultHeight);
+            field.fontWidth = intParam(p, 2, 0);
+        } else if (c.code == "FR") {
+            field.reverse = true;
+        } else if (c.code == "FH") {
+            hexIndicator = c.params.isEmpty() ? QChar('_') : c.params.at(0);
+        } else if (c.code == "FN") {
+            field.fieldNumber = intParam(p, 0, 0);
+        } else if (c.code == "FD") {
+            field.text = hexIndicator.isNull() ? c.params : decodeFieldHex(c.params, hexIndicator);
+            hasText = true;
+        } else if (c.code == "GB") {
+            const int t = qMax(1, intParam(p, 2, 1));
+            field.kind = Element::Box;
+            field.thickness = t;
+            field.box = QSize(qMax(t, intParam(p, 0, t)), qMax(t, intParam(p, 1, t)));
+            field.white = p.value(3).trimmed().toUpper() == "W";
+            field.rounding = qBound(0, intParam(p, 4, 0), 8);
+            hasBox = true;
+        } else if (c.code == "GF") {
+            field.kind = Element::Graphic;
+            field.graphic = decodeGraphicField(c.params);
+            hasBox = !field.graphic.isNull();
+        } else if (c.code == "FS") {
+            if (hasBox || hasText || field.fieldNumber > 0)
+                elements << field;
+            resetField();
+        }
+        // ^FX comments and anything outside the subset are skipped.
+    }
+}
+
+//
+// Paint
+//
+void ZplRasterizer::buildStaticLayer()
+{
+    staticLayer = QImage(size, QImage::Format_RGB32);
+    staticLayer.fill(Qt::white);
+
+    QPainter painter(&staticLayer);
+    for (const Element &e : std::as_const(elements)) {
+        if (e.fieldNumber == 0)
+            paintElement(painter, e, e.text);
+    }
+}
+
+QImage ZplRasterizer::render(const QHash<int, QString> &fields, QImage::Format format) const
+{
+    if (staticLayer.isNull())
+        return QImage();
+
+    QImage image = staticLayer.copy();
+    {
+        QPainter painter(&image);
+        for (const Element &e : elements) {
+            if (e.fieldNumber > 0)
+                paintElement(painter, e, fields.value(e.fieldNumber, e.text));
+        }
+    }
+    if (format == QImage::Format_RGB32)
+        return image;
+    return image.convertToFormat(QImage::Format_Mono, Qt::MonoOnly | Qt::ThresholdDither);
+}
+
+QRect ZplRasterizer::repaintFields(QImage &image, const QHash<int, QString> &fields,
+                                   const QList<int> &changed) const
+{
+    if (staticLayer.isNull() || image.size() != staticLayer.size())
+        return QRect();
+
+    QRect dirty;
+    for (int fieldNumber : changed)
+        dirty |= fieldBounds(fieldNumber);
+    if (dirty.isEmpty())
+        return QRect();
+
+    // Put the static layer back under the changed fields, then redraw every
+    // field overlapping that area (^FR fields share space with others).
+    QPainter painter(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(dirty.topLeft(), staticLayer, dirty);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setClipRect(dirty);
+    for (const Element &e : elements) {
+        if (e.fieldNumber > 0 && fieldBounds(e.fieldNumber).intersects(dirty))
+            paintElement(painter, e, fields.value(e.fieldNumber, e.text));
+    }
+    return dirty;
+}
+
+void ZplRasterizer::paintElement(QPainter &painter, const Element &e, const QString &text) const
+{
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    painter.setRenderHint(QPainter::TextAntialiasing, false);
+
+    // ^FR: the field inverts whatever is under it.
+    QColor ink = Qt::black;
+    if (e.reverse) {
+        painter.setCompositionMode(QPainter::RasterOp_SourceXorDestination);
+        ink = Qt::white;
+    } else if (e.kind == Element::Box && e.white) {
+        ink = Qt::white;
+    }
+
+    if (e.kind == Element::Graphic) {
+        painter.drawImage(e.origin, e.graphic);
+        painter.restore();
+        return;
+    }
+
+    if (e.kind == Element::Box) {
+        const QRectF outer(e.origin, e.box);
+        const qreal radius = e.rounding * qMin(e.box.width(), e.box.height()) / 16.0;
+
+        QPainterPath path;
+        path.addRoundedRect(outer, radius, radius);
+        const int t = e.thickness;
+        if (2 * t < e.box.width() && 2 * t < e.box.height()) {
+            QPainterPath inner;
+            const qreal innerRadius = qMax<qreal>(0, radius - t);
+            inner.addRoundedRect(outer.adjusted(t, t, -t, -t), innerRadius, innerRadius);
+            path = path.subtracted(inner);
+        }
+        painter.fillPath(path, ink);
+        painter.restore();
+        return;
+    }
+
+    if (text.isEmpty()) {
+        painter.restore();
+        return;
+    }
+
+    QFont font(font0Family());
+    font.setPixelSize(qMax(1, e.fontHeight));
+    font.setStyleStrategy(QFont::NoAntialias);
+    if (e.fontWidth > 0 && e.fontWidth != e.fontHeight)
+        font.setStretch(qBound(1, qRound(100.0 * e.fontWidth / e.fontHeight), 4000));
+    painter.setFont(font);
+    painter.setPen(ink);
+
+    const QFontMetrics fm(font);
+    const int tw = fm.horizontalAdvance(text);
+    const int th = fm.height();
+    const int x = e.origin.x();
+    const int y = e.origin.y();
+
+    switch (e.orientation) {
+    case 'R': // 90 degrees clockwise
+        painter.translate(x + th, y);
+        painter.rotate(90);
+        break;
+    case 'I': // 180 degrees
+        painter.translate(x + tw, y + th);
+        painter.rotate(180);
+        break;
+    case 'B': // 270 degrees
+        painter.translate(x, y + tw);
+        painter.rotate(270);
+        break;
+    default:
+        painter.translate(x, y);
+        break;
+    }
+    painter.drawText(0, fm.ascent(), text);
+    painter.restore();
+}
+
+//
+// Jobs
+//
+QImage ZplRasterizer::renderJob(const QByteArray &zpl, int dpi, int *quantity)
+{
+    QString recall;
+    QHash<int, QString> fields;
+    int qty = 1;
+    int fieldNumber = 0;
+    QChar hexIndicator;
+
+    for (const Command &c : tokenize(zpl)) {
+        if (c.code == "XF") {
+            recall = c.params.trimmed();
+        } else if (c.code == "FN") {
+            fieldNumber = c.params.section(',', 0, 0).toInt();
+        } else if (c.code == "FH") {
+            hexIndicator = c.params.isEmpty() ? QChar('_') : c.params.at(0);
+        } else if (c.code == "FD") {
+            if (fieldNumber > 0)
+                fields.insert(fieldNumber, hexIndicator.isNull() ? c.params
+                                                                 : decodeFieldHex(c.params, hexIndicator));
+        } else if (c.code == "FS") {
+            fieldNumber = 0;
+            hexIndicator = QChar();
+        } else if (c.code == "PQ") {
+            qty = qMax(1, c.params.section(',', 0, 0).toInt());
+        }
+    }
+    if (quantity)
+        *quantity = qty;
+
+    ZplRasterizer r(dpi);
+    if (recall.isEmpty()) {
+        r.setFormat("INLINE", zpl);
+        return r.render({});
+    }
+
+    // "E:DEFAULT.ZPL" -> "DEFAULT.ZPL"
+    if (recall.size() > 2 && recall.at(1) == ':')
+        recall = recall.mid(2);
+    if (!r.loadFormat(recall)) {
+        qWarning() << "ZplRasterizer: no local source for" << recall;
+        return QImage();
+    }
+    return r.render(fields);
+}
+
+QString ZplRasterizer::decodeFieldHex(const QString &data, QChar indicator)
+{
+    // ^FH: <indicator>XX is the UTF-8 byte 0xXX.
+    QByteArray bytes;
+    const QByteArray in = data.toUtf8();
+    const char ind = indicator.toLatin1();
+    for (int i = 0; i < in.size(); ++i) {
+        if (in.at(i) == ind && i + 2 < in.size()) {
+            bool ok;
+            const int v = in.mid(i + 1, 2).toInt(&ok, 16);
+            if (ok) {
+                bytes.append(char(v));
+                i += 2;
+                continue;
+            }
+        }
+        bytes.append(in.at(i));
+    }
+    return QString::fromUtf8(bytes);
+}
+
+QImage ZplRasterizer::decodeGraphicField(const QString &params)
+{
+    // ^GFA,<binary bytes>,<graphic bytes>,<bytes per row>,<data>
+    const QStringList head = params.section(',', 0, 3).split(',');
+    const QString data = params.section(',', 4).trimmed();
+    const int total = intParam(head, 2, 0);
+    const int rowBytes = intParam(head, 3, 0);
+    if (head.value(0).trimmed().toUpper() != "A" || total <= 0 || rowBytes <= 0)
+        return QImage();
+
+    QByteArray bits;
+    if (data.startsWith(":B64:") || data.startsWith(":Z64:")) {
+        // :Z64:<base64 of zlib data>:<crc>
+        bits = QByteArray::fromBase64(data.mid(5).section(':', 0, 0).toLatin1());
+        if (data.startsWith(":Z64:")) {
+            // qUncompress() wants the expected size up front.
+            QByteArray sized(4, '\0');
+            qToBigEndian<quint32>(quint32(total), sized.data());
+            bits = qUncompress(sized + bits);
+        }
+    } else {
+        bits = decodeCompressedHex(data, rowBytes);
+    }
+    if (bits.isEmpty())
+        return QImage();
+    if (bits.size() < total)
+        bits.append(total - bits.size(), '\0');
+
+    const int rows = total / rowBytes;
+    QImage image(rowBytes * 8, rows, QImage::Format_Mono);
+    image.setColorCount(2);
+    image.setColor(0, qRgba(255, 255, 255, 0));
+    image.setColor(1, qRgb(0, 0, 0));
+    for (int y = 0; y < rows; ++y)
+        memcpy(image.scanLine(y), bits.constData() + y * rowBytes, rowBytes);
+    return image;
+}
+
+QByteArray ZplRasterizer::decodeCompressedHex(const QString &data, int rowBytes)
+{
+    // G-Y repeat the next hex digit 1-19 times, g-z 20-400 times; ','
+    // pads the row with 0, '!' with F, ':' repeats the previous row.
+    const int rowDigits = rowBytes * 2;
+    QByteArray out;
+    QByteArray row;
+    QByteArray previous(rowDigits, '0');
+    int repeat = 0;
+
+    auto finishRow = [&](char fill) {
+        row.append(rowDigits - row.size(), fill);
+        out += QByteArray::fromHex(row);
+        previous = row;
+        row.clear();
+    };
+
+    for (const QChar qc : data) {
+        const char c = qc.toLatin1();
+        if (c >= 'G' && c <= 'Y') {
+            repeat += c - 'G' + 1;
+        } else if (c >= 'g' && c <= 'z') {
+            repeat += (c - 'g' + 1) * 20;
+        } else if (c == ',') {
+            finishRow('0');
+            repeat = 0;
+        } else if (c == '!') {
+            finishRow('F');
+            repeat = 0;
+        } else if (c == ':') {
+            if (!row.isEmpty())
+                finishRow('0');
+            out += QByteArray::fromHex(previous);
+            repeat = 0;
+        } else if (isxdigit(static_cast<unsigned char>(c))) {
+            row.append(qMax(1, repeat), c);
+            repeat = 0;
+            while (row.size() >= rowDigits) {
+                const QByteArray rest = row.mid(rowDigits);
+                row.truncate(rowDigits);
+                finishRow('0');
+                row = rest;
+            }
+        }
+    }
+    if (!row.isEmpty())
+        finishRow('0');
+    return out;
+}
+
+QString ZplRasterizer::font0Family()
+{
+    // Needs a QGuiApplication (font database); QFontDatabase is thread-safe.
+    std::call_once(font0Once, []() {
+        int id = QFontDatabase::addApplicationFont(":/resources/tt0003m_.ttf");
+        const QStringList families = id < 0 ? QStringList() : QFontDatabase::applicationFontFamilies(id);
+        if (families.isEmpty()) {
+            qWarning() << "ZplRasterizer: Zebra font 0 not available, using Arial";
+            font0 = "Arial";
+        } else {
+            font0 = families.first();
+        }
+        font0Loaded = true;
+    });
+    return font0;
+}
+
+void ZplRasterizer::loadFont0Async(QObject *context, std::function<void()> ready)
+{
+    if (font0Loaded) {
+        QMetaObject::invokeMethod(context, std::move(ready), Qt::QueuedConnection);
+        return;
+    }
+    font0Waiters.append(Font0Waiter{ context, std::move(ready) });
+    if (font0Started)
+        return;
+    font0Started = true;
+
+    // Parsing the TTF into the font database is the slow part of the first
+    // frame; the waiters are called back on the application's thread.
+    QObject *app = QCoreApplication::instance();
+    QThreadPool::globalInstance()->start([app]() {
+        font0Family();
+        QMetaObject::invokeMethod(app, []() {
+            const QList<Font0Waiter> waiters = std::exchange(font0Waiters, {});
+            for (const Font0Waiter &w : waiters) {
+                if (w.context)
+                    w.ready();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool ZplRasterizer::isFont0Loaded()
+{
+    return font0Loaded;
+}
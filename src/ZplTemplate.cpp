@@ -0,0 +1,306 @@
+// src/ZplTemplate.cpp
+#include "ZplTemplate.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace {
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+void appendNumber(QByteArray &out, int value)
+{
+    char buf[12];
+    int n = 0;
+    unsigned v = value < 0 ? 0u : unsigned(value);
+    do {
+        buf[n++] = char('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0)
+        out.append(buf[--n]);
+}
+
+} // namespace
+
+//
+// Compile
+//
+ZplTemplate ZplTemplate::compileInline(const QString &name, const QByteArray &format)
+{
+    ZplTemplate t;
+    t.templateName = name.toUpper();
+
+    const QByteArray src = format.trimmed();
+    if (src.isEmpty())
+        return t;
+
+    Segment current;
+    int pos = 0;
+
+    // ^PQ (when requested) goes right after the opening ^XA.
+    int xa = src.indexOf("^XA");
+    if (xa >= 0) {
+        current.text = src.left(xa + 3);
+        current.slot = Quantity;
+        t.segments << current;
+        current = Segment();
+        pos = xa + 3;
+    }
+
+    while (pos < src.size()) {
+        int fn = src.indexOf("^FN", pos);
+        if (fn < 0)
+            break;
+
+        int digits = fn + 3;
+        int end = digits;
+        while (end < src.size() && isDigit(src.at(end)))
+            ++end;
+
+        if (end == digits) { // "^FN" without a number: keep as-is
+            current.text += src.mid(pos, digits - pos);
+            pos = digits;
+            continue;
+        }
+
+        int number = src.mid(digits, end - digits).toInt();
+        current.text += src.mid(pos, fn - pos);
+        current.slot = number;
+        t.segments << current;
+        current = Segment();
+        if (!t.fields.contains(number))
+            t.fields << number;
+        pos = end;
+
+        // A default ^FD after ^FNn is replaced by the job's data.
+        if (src.mid(pos, 3) == "^FD") {
+            int fs = src.indexOf("^FS", pos);
+            pos = fs < 0 ? src.size() : fs;
+        }
+    }
+
+    // Overlay fields go before the closing ^XZ (and the line break ahead
+    // of it), after everything the format draws.
+    int xz = src.lastIndexOf("^XZ");
+    if (xz >= pos) {
+        while (xz > pos && (src.at(xz - 1) == '\n' || src.at(xz - 1) == '\r'))
+            --xz;
+        current.text += src.mid(pos, xz - pos);
+        current.slot = Overlay;
+        t.segments << current;
+        current = Segment();
+        pos = xz;
+    }
+
+    current.text += src.mid(pos);
+    current.slot = Static;
+    t.segments << current;
+
+    for (const Segment &s : std::as_const(t.segments))
+        t.sizeHint += s.text.size();
+    return t;
+}
+
+ZplTemplate ZplTemplate::compileRecall(const QString &name, const QList<int> &fieldNumbers)
+{
+    ZplTemplate t;
+    t.templateName = name.toUpper();
+    t.fields = fieldNumbers;
+
+    // ^XA [^PQn] ^XF<name>^FS ^FNn^FD<data>^FS ... [overlay] ^XZ
+    Segment s;
+    s.text = "^XA";
+    s.slot = Quantity;
+    t.segments << s;
+
+    QByteArray text = "\n^XF" + t.templateName.toUtf8() + "^FS";
+    for (int n : fieldNumbers) {
+        s.text = text + "\n^FN";
+        appendNumber(s.text, n);
+        s.slot = n;
+        t.segments << s;
+        text = "^FS";
+    }
+
+    s.text = text;
+    s.slot = Overlay;
+    t.segments << s;
+
+    s.text = "\n^XZ";
+    s.slot = Static;
+    t.segments << s;
+
+    for (const Segment &seg : std::as_const(t.segments))
+        t.sizeHint += seg.text.size();
+    return t;
+}
+
+QList<int> ZplTemplate::scanFieldNumbers(const QByteArray &format)
+{
+    QList<int> numbers;
+    int pos = 0;
+    while ((pos = format.indexOf("^FN", pos)) >= 0) {
+        pos += 3;
+        int end = pos;
+        while (end < format.size() && isDigit(format.at(end)))
+            ++end;
+        if (end > pos) {
+            int n = format.mid(pos, end - pos).toInt();
+            if (!numbers.contains(n))
+                numbers << n;
+        }
+        pos = end;
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+//
+// Render
+//
+void ZplTemplate::render(QByteArray &out, const QStringView *fieldData, int fieldCount, int quantity,
+                         const QByteArray &overlay) const
+{
+    // Field data rarely exceeds a few dozen bytes per slot.
+    const qsizetype needed = out.size() + sizeHint + 48 * fields.size() + overlay.size() + 1;
+    if (out.capacity() < needed)
+        out.reserve(needed);
+
+    for (const Segment &s : segments) {
+        out.append(s.text);
+        if (s.slot == Quantity) {
+            if (quantity > 0) {
+                out.append("\n^PQ");
+                appendNumber(out, quantity);
+            }
+        } else if (s.slot == Overlay) {
+            if (!overlay.isEmpty()) {
+                out.append('\n');
+                out.append(overlay);
+            }
+        } else if (s.slot > 0) {
+            appendFieldData(out, s.slot < fieldCount ? fieldData[s.slot] : QStringView());
+        }
+    }
+}
+
+void ZplTemplate::appendFieldData(QByteArray &out, QStringView value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    // ^ and ~ would start a new command; with ^FH they are sent as _5E/_7E,
+    // and the '_' indicator itself has to be escaped too.
+    bool escape = false;
+    for (QChar ch : value) {
+        char16_t c = ch.unicode();
+        if (c == '^' || c == '~' || c == '_') {
+            escape = true;
+            break;
+        }
+    }
+    out.append(escape ? "^FH^FD" : "^FD");
+
+    // UTF-8 encode in the same pass.
+    const char16_t *p = value.utf16();
+    const qsizetype n = value.size();
+    for (qsizetype i = 0; i < n; ++i) {
+        char32_t c = p[i];
+        if (c < 0x80) {
+            if (escape && (c == '^' || c == '~' || c == '_')) {
+                out.append('_');
+                out.append(hex[c >> 4]);
+                out.append(hex[c & 0xF]);
+            } else {
+                out.append(char(c));
+            }
+            continue;
+        }
+
+        if (QChar::isHighSurrogate(c) && i + 1 < n && QChar::isLowSurrogate(p[i + 1]))
+            c = QChar::surrogateToUcs4(char16_t(c), p[++i]);
+
+        if (c < 0x800) {
+            out.append(char(0xC0 | (c >> 6)));
+        } else if (c < 0x10000) {
+            out.append(char(0xE0 | (c >> 12)));
+            out.append(char(0x80 | ((c >> 6) & 0x3F)));
+        } else {
+            out.append(char(0xF0 | (c >> 18)));
+            out.append(char(0x80 | ((c >> 12) & 0x3F)));
+            out.append(char(0x80 | ((c >> 6) & 0x3F)));
+        }
+        out.append(char(0x80 | (c & 0x3F)));
+    }
+}
+
+//
+// Library
+//
+ZplTemplateLibrary &ZplTemplateLibrary::instance()
+{
+    static ZplTemplateLibrary library;
+    return library;
+}
+
+ZplTemplate ZplTemplateLibrary::get(const QString &name, ZplTemplate::Mode mode,
+                                    const QList<int> &fallbackFields)
+{
+    const QString key = name.toUpper();
+    const QString cacheKey = (mode == ZplTemplate::Inline ? "I:" : "R:") + key;
+
+    QMutexLocker lock(&mutex);
+    auto it = compiled.constFind(cacheKey);
+    if (it != compiled.constEnd())
+        return *it;
+
+    const QByteArray src = sourceLocked(key);
+
+    ZplTemplate t;
+    if (mode == ZplTemplate::Inline && !src.isEmpty())
+        t = ZplTemplate::compileInline(key, src);
+    else
+        t = ZplTemplate::compileRecall(key, src.isEmpty() ? fallbackFields
+                                                         : ZplTemplate::scanFieldNumbers(src));
+
+    compiled.insert(cacheKey, t);
+    return t;
+}
+
+QByteArray ZplTemplateLibrary::source(const QString &name)
+{
+    QMutexLocker lock(&mutex);
+    return sourceLocked(name.toUpper());
+}
+
+QByteArray ZplTemplateLibrary::sourceLocked(const QString &name)
+{
+    auto it = sources.constFind(name);
+    if (it != sources.constEnd())
+        return *it;
+
+    // 1) zpl/ next to the executable (lets a shop edit formats without a rebuild)
+    // 2) embedded copy of the repo's zpl/ folder
+    QStringList candidates;
+    if (QCoreApplication::instance())
+        candidates << QDir(QCoreApplication::applicationDirPath()).filePath("zpl/" + name);
+    candidates << ":/resources/zpl/" + name;
+
+    QByteArray data;
+    for (const QString &path : std::as_const(candidates)) {
+        QFile f(path);
+        if (f.open(QIODevice::ReadOnly)) {
+            data = f.readAll();
+            break;
+        }
+    }
+
+    sources.insert(name, data);
+    return data;
+}